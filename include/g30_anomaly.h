@@ -0,0 +1,196 @@
+/**
+ * @file g30_anomaly.h
+ * @brief Streaming anomaly detection on telemetry samples
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * AnomalyDetector is a telemetry sink that watches every device's
+ * voltage, current, power and ripple for early signs of a degrading DUT.
+ * Three online detectors are run on each metric: an EWMA z-score for
+ * spikes, a two-sided CUSUM for small persistent drifts, and a fast/slow
+ * EWMA comparison for step changes. Each detector costs O(1) time and
+ * memory per sample. Events carry the recent samples of the device as
+ * evidence, so only the interesting windows have to leave the box.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_ANOMALY_H
+#define G30_ANOMALY_H
+
+#include "g30_telemetry.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Quantity watched by the detector
+ */
+enum class AnomalyMetric {
+    VOLTAGE,            ///< Measured voltage
+    CURRENT,            ///< Measured current
+    POWER,              ///< Measured power
+    VOLTAGE_RIPPLE,     ///< |successive voltage difference| / sqrt(2) (level shifts only)
+    CURRENT_RIPPLE      ///< |successive current difference| / sqrt(2) (level shifts only)
+};
+
+/**
+ * @brief Detector that raised an event
+ */
+enum class AnomalyKind {
+    SPIKE,              ///< EWMA z-score above zThreshold
+    DRIFT_UP,           ///< Upper CUSUM above cusumH
+    DRIFT_DOWN,         ///< Lower CUSUM above cusumH
+    LEVEL_SHIFT         ///< Fast EWMA departed from the baseline (which is then re-learned)
+};
+
+/**
+ * @brief Get a printable name of a metric
+ */
+const char* anomalyMetricName(AnomalyMetric metric);
+
+/**
+ * @brief Get a printable name of a detector
+ */
+const char* anomalyKindName(AnomalyKind kind);
+
+/**
+ * @brief Detector settings
+ */
+struct AnomalyConfig {
+    std::vector<AnomalyMetric> metrics;     ///< Metrics watched for every device
+    double baselineAlpha;       ///< EWMA gain of the baseline mean and variance
+    double fastAlpha;           ///< EWMA gain of the fast mean (level shift)
+    int warmupSamples;          ///< Samples before detection starts
+    double zThreshold;          ///< |z| raising SPIKE
+    double cusumK;              ///< CUSUM slack in standard deviations
+    double cusumH;              ///< CUSUM decision threshold in standard deviations
+    double shiftThreshold;      ///< Level shift in standard errors of the fast EWMA
+    double stddevFloor;         ///< Lower bound of the baseline deviation (reading resolution)
+    double voltageStepReset_V;  ///< Voltage jump treated as a new operating point (0 = off)
+    int cooldownSamples;        ///< Samples the spike and drift detectors stay quiet after an event
+    size_t evidenceSamples;     ///< Recent samples attached to each event
+
+    AnomalyConfig()
+        : metrics({AnomalyMetric::VOLTAGE, AnomalyMetric::CURRENT, AnomalyMetric::CURRENT_RIPPLE}),
+          baselineAlpha(0.01),
+          fastAlpha(0.2),
+          warmupSamples(50),
+          zThreshold(5.0),
+          cusumK(0.5),
+          cusumH(10.0),
+          shiftThreshold(5.0),
+          stddevFloor(1e-3),
+          voltageStepReset_V(0.5),
+          cooldownSamples(100),
+          evidenceSamples(64) {}
+};
+
+/**
+ * @brief One detected anomaly
+ */
+struct AnomalyEvent {
+    uint32_t device;                        ///< Device index
+    AnomalyMetric metric;                   ///< Metric
+    AnomalyKind kind;                       ///< Detector
+    int64_t timestamp_ns;                   ///< Time of the deciding sample
+    int64_t changeStart_ns;                 ///< Estimated start of a drift or shift (timestamp_ns for spikes)
+    double value;                           ///< Metric value of the deciding sample
+    double baselineMean;                    ///< Baseline mean before the event
+    double baselineStddev;                  ///< Baseline deviation before the event
+    double score;                           ///< z, CUSUM or shift statistic in standard deviations
+    std::vector<TelemetrySample> evidence;  ///< Recent samples of the device, oldest first
+
+    AnomalyEvent()
+        : device(0),
+          metric(AnomalyMetric::VOLTAGE),
+          kind(AnomalyKind::SPIKE),
+          timestamp_ns(0),
+          changeStart_ns(0),
+          value(0),
+          baselineMean(0),
+          baselineStddev(0),
+          score(0) {}
+};
+
+/**
+ * @brief Online anomaly detector stage of the telemetry pipeline
+ *
+ * Per-device state is locked separately, so samplers calling onSample()
+ * for different devices concurrently do not contend. The event callback
+ * runs on the sampler thread of the device.
+ *
+ * Example usage:
+ * @code
+ * auto detector = std::make_shared<AnomalyDetector>(2);
+ * detector->setEventCallback([](const AnomalyEvent& e) {
+ *     std::cerr << "device " << e.device << ": " << anomalyKindName(e.kind) << " in "
+ *               << anomalyMetricName(e.metric) << " (" << e.score << " sigma)" << std::endl;
+ * });
+ * sampler.addSink(detector);
+ * @endcode
+ */
+class AnomalyDetector : public ITelemetrySink {
+public:
+    /**
+     * @brief Construct a detector
+     * @param devices Number of devices (sample.device must be below it)
+     * @param config Detector settings
+     * @throws G30Exception on invalid settings
+     */
+    explicit AnomalyDetector(size_t devices, const AnomalyConfig& config = AnomalyConfig());
+
+    ~AnomalyDetector() override;
+
+    /**
+     * @brief Set callback for events (before samples arrive)
+     * @param callback Event handler
+     */
+    void setEventCallback(std::function<void(const AnomalyEvent&)> callback);
+
+    /**
+     * @brief Feed one sample (invalid samples and unknown devices are ignored)
+     * @param sample Telemetry sample
+     */
+    void onSample(const TelemetrySample& sample) override;
+
+    /**
+     * @brief Forget the baselines of a device (e.g. after a new setpoint)
+     * @param device Device index
+     */
+    void reset(size_t device);
+
+    /**
+     * @brief Get number of events raised
+     */
+    uint64_t eventCount() const { return events_.load(); }
+
+    /**
+     * @brief Get baseline mean and deviation of a device metric
+     * @param device Device index
+     * @param metric Metric (must be in AnomalyConfig::metrics)
+     * @param mean Receives the baseline mean
+     * @param stddev Receives the baseline deviation
+     * @return false if the metric is not watched or still warming up
+     */
+    bool baseline(size_t device, AnomalyMetric metric, double& mean, double& stddev) const;
+
+private:
+    struct MetricState;
+    struct DeviceState;
+
+    AnomalyConfig config_;
+    std::function<void(const AnomalyEvent&)> callback_;
+    std::vector<std::unique_ptr<DeviceState>> devices_;
+    std::atomic<uint64_t> events_;
+};
+
+} // namespace TDKLambda
+
+#endif // G30_ANOMALY_H
@@ -0,0 +1,170 @@
+/**
+ * @file g30_c.h
+ * @brief Stable C ABI for foreign-language consumers (Python, LabVIEW, ...)
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * Wraps TDKLambdaG30 and the telemetry, sweep and synchronized-ramp
+ * features behind opaque handles and status codes. No C++ exception
+ * crosses this boundary; the message of the last failure on the calling
+ * thread is available from g30_last_error().
+ *
+ * Bulk functions copy many samples into caller-provided contiguous arrays
+ * in one call, so foreign runtimes avoid per-sample call overhead.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_C_H
+#define G30_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define G30_C_API_VERSION 1
+
+/** Status codes returned by every function that can fail */
+typedef enum {
+    G30_OK = 0,                     /**< Success */
+    G30_ERR_INVALID_ARGUMENT = -1,  /**< Null handle, setpoint outside 0..rating, ... (nothing sent) */
+    G30_ERR_NOT_CONNECTED = -2,     /**< Device not connected */
+    G30_ERR_DEVICE = -3,            /**< Communication or device error */
+    G30_ERR_BUFFER_TOO_SMALL = -4,  /**< Output buffer too small (output truncated) */
+    G30_ERR_INTERNAL = -5           /**< Unexpected failure */
+} g30_status;
+
+/** Opaque handles */
+typedef struct g30_device g30_device;
+typedef struct g30_sampler g30_sampler;
+typedef struct g30_sweep_result g30_sweep_result;
+
+/** Telemetry sample (plain C layout, 56 bytes) */
+typedef struct {
+    uint32_t device;            /**< Index of the device in the sampler */
+    uint32_t status;            /**< Raw STAT:QUES? value */
+    uint64_t sequence;          /**< Per-device sample counter */
+    int64_t timestamp_ns;       /**< CLOCK_MONOTONIC time of the reading */
+    double voltage;             /**< Measured voltage (V) */
+    double current;             /**< Measured current (A) */
+    double power;               /**< voltage * current (W) */
+    int32_t output_enabled;     /**< Output state (0/1) */
+    int32_t valid;              /**< 0 if the reading failed */
+} g30_sample;
+
+/** Device settings snapshot */
+typedef struct {
+    double voltage;
+    double current;
+    double over_voltage_protection;
+    int32_t output_enabled;
+} g30_device_config;
+
+/* ==================== General ==================== */
+
+/** API version of the loaded library (compare with G30_C_API_VERSION) */
+int g30_api_version(void);
+
+/** Message of the last failure on the calling thread (never NULL) */
+const char* g30_last_error(void);
+
+/* ==================== Devices ==================== */
+
+g30_status g30_open(const char* ip_address, int tcp_port, int timeout_ms, g30_device** out);
+void g30_close(g30_device* device);
+
+/** Connect; reset != 0 sends *RST and *CLS as part of the connection */
+g30_status g30_connect(g30_device* device, int reset);
+g30_status g30_disconnect(g30_device* device);
+int g30_is_connected(const g30_device* device);
+
+g30_status g30_enable_output(g30_device* device, int enable);
+g30_status g30_is_output_enabled(g30_device* device, int* enabled);
+
+g30_status g30_set_voltage(g30_device* device, double voltage);
+g30_status g30_get_voltage(g30_device* device, double* voltage);
+g30_status g30_measure_voltage(g30_device* device, double* voltage);
+
+g30_status g30_set_current(g30_device* device, double current);
+g30_status g30_get_current(g30_device* device, double* current);
+g30_status g30_measure_current(g30_device* device, double* current);
+
+g30_status g30_set_ovp(g30_device* device, double voltage);
+g30_status g30_get_ovp(g30_device* device, double* voltage);
+g30_status g30_clear_protection(g30_device* device);
+
+g30_status g30_read_config(g30_device* device, g30_device_config* config);
+g30_status g30_apply_config(g30_device* device, const g30_device_config* config, int* changed);
+
+/** Copy *IDN? into buffer (NUL-terminated, G30_ERR_BUFFER_TOO_SMALL if truncated) */
+g30_status g30_identification(g30_device* device, char* buffer, size_t length);
+
+/** Raw SCPI query / command */
+g30_status g30_query(g30_device* device, const char* query, char* buffer, size_t length);
+g30_status g30_command(g30_device* device, const char* command);
+
+/* ==================== Telemetry ==================== */
+
+/**
+ * Create a sampler over devices (not owned; they must outlive the sampler).
+ * Samples are kept in a ring of `capacity` entries until drained; when it
+ * is full the oldest samples are dropped. period_ms must be positive.
+ */
+g30_status g30_sampler_create(g30_device* const* devices, size_t count, int period_ms,
+                              size_t capacity, g30_sampler** out);
+void g30_sampler_destroy(g30_sampler* sampler);
+g30_status g30_sampler_start(g30_sampler* sampler);
+g30_status g30_sampler_stop(g30_sampler* sampler);
+
+/** Latest sample of one device */
+g30_status g30_sampler_latest(g30_sampler* sampler, size_t device, g30_sample* sample);
+
+/** Move up to max buffered samples into samples[]; *count receives the number copied */
+g30_status g30_sampler_drain(g30_sampler* sampler, g30_sample* samples, size_t max, size_t* count);
+
+/**
+ * Columnar variant of g30_sampler_drain. Any column pointer may be NULL
+ * to skip that column; check valid[] before using a row's readings.
+ */
+g30_status g30_sampler_drain_columns(g30_sampler* sampler, size_t max, size_t* count,
+                                     uint32_t* device, int64_t* timestamp_ns,
+                                     double* voltage, double* current, uint32_t* status,
+                                     int32_t* output_enabled, int32_t* valid);
+
+/** Number of samples dropped because the ring was full */
+uint64_t g30_sampler_dropped(const g30_sampler* sampler);
+
+/* ==================== Sweeps and Ramps ==================== */
+
+/**
+ * Run a grid sweep (voltage varying fastest) on all devices in parallel.
+ * The result handle must be released with g30_sweep_result_free().
+ */
+g30_status g30_sweep_grid(g30_device* const* devices, size_t count,
+                          double v_start, double v_stop, int v_points,
+                          double i_start, double i_stop, int i_points,
+                          int settle_ms, g30_sweep_result** out);
+
+size_t g30_sweep_result_size(const g30_sweep_result* result);
+
+/** Copy result columns (each NULL or of at least `capacity` elements) */
+g30_status g30_sweep_result_copy(const g30_sweep_result* result, size_t capacity,
+                                 uint32_t* device, double* set_voltage, double* set_current,
+                                 double* meas_voltage, double* meas_current, double* time_ms);
+
+void g30_sweep_result_free(g30_sweep_result* result);
+
+/** Lock-step ramp of all devices to targets[i]; skew/error outputs may be NULL */
+g30_status g30_ramp_voltage(g30_device* const* devices, size_t count, const double* targets,
+                            double ramp_rate, int step_interval_ms,
+                            double* max_skew_ms, double* max_tracking_error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* G30_C_H */
@@ -0,0 +1,271 @@
+/**
+ * @file g30_capture.h
+ * @brief Triggered transient capture with a pre/post-trigger buffer
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * TransientCapture samples one supply as fast as the link allows (or at a
+ * configured maximum rate) into a circular pre-trigger buffer. When the
+ * trigger fires on a level crossing, a slope or a status bit, it keeps
+ * sampling for the post-trigger length and emits a timestamped capture
+ * record containing the samples before and after the event. Brown-outs
+ * and current spikes between slow telemetry polls are caught this way.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_CAPTURE_H
+#define G30_CAPTURE_H
+
+#include "g30_telemetry.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Kind of capture trigger
+ */
+enum class TriggerType {
+    LEVEL,          ///< Signal crosses a level
+    SLOPE,          ///< Signal changes faster than a rate
+    STATUS          ///< A STAT:QUES? bit becomes set
+};
+
+/**
+ * @brief Signal watched by level and slope triggers
+ */
+enum class TriggerSignal {
+    VOLTAGE,
+    CURRENT,
+    POWER
+};
+
+/**
+ * @brief Direction of a level crossing or slope
+ */
+enum class TriggerEdge {
+    RISING,
+    FALLING,
+    EITHER
+};
+
+/**
+ * @brief Trigger condition of a capture
+ *
+ * Example: brown-out below 11.4 V
+ * @code
+ * CaptureTrigger t = CaptureTrigger::levelCrossing(TriggerSignal::VOLTAGE, 11.4, TriggerEdge::FALLING);
+ * @endcode
+ */
+struct CaptureTrigger {
+    TriggerType type;           ///< Trigger kind
+    TriggerSignal signal;       ///< Watched signal (LEVEL, SLOPE)
+    TriggerEdge edge;           ///< Direction (LEVEL, SLOPE)
+    double level;               ///< Crossing level (LEVEL)
+    double rate_per_s;          ///< Slope magnitude in signal units per second (SLOPE)
+    uint32_t statusMask;        ///< STAT:QUES? bits (STATUS)
+
+    CaptureTrigger()
+        : type(TriggerType::LEVEL),
+          signal(TriggerSignal::VOLTAGE),
+          edge(TriggerEdge::EITHER),
+          level(0.0),
+          rate_per_s(0.0),
+          statusMask(0) {}
+
+    static CaptureTrigger levelCrossing(TriggerSignal signal, double level, TriggerEdge edge);
+    static CaptureTrigger slope(TriggerSignal signal, double ratePerSecond, TriggerEdge edge);
+    static CaptureTrigger statusBits(uint32_t mask);
+};
+
+/**
+ * @brief Capture settings
+ */
+struct CaptureConfig {
+    size_t preTrigger;          ///< Samples kept before the trigger
+    size_t postTrigger;         ///< Samples recorded after the trigger
+    int maxRate_Hz;             ///< Upper bound of the sampling rate (0 = as fast as the link allows)
+    bool readStatus;            ///< Read STAT:QUES? with every sample (needed for STATUS triggers)
+    bool rearm;                 ///< Re-arm after each capture (false = single shot)
+    size_t maxRecords;          ///< Completed records kept until taken; older ones are dropped
+
+    CaptureConfig()
+        : preTrigger(256),
+          postTrigger(256),
+          maxRate_Hz(0),
+          readStatus(true),
+          rearm(true),
+          maxRecords(8) {}
+};
+
+/**
+ * @brief One captured transient
+ */
+struct CaptureRecord {
+    uint64_t id;                            ///< Capture number (from 1)
+    int64_t triggerTimestamp_ns;            ///< steady_clock time of the trigger sample
+    size_t triggerIndex;                    ///< Index of the trigger sample in samples
+    std::string reason;                     ///< Trigger description
+    double sampleRate_Hz;                   ///< Average rate over the record
+    std::vector<TelemetrySample> samples;   ///< Pre-trigger, trigger and post-trigger samples
+
+    CaptureRecord()
+        : id(0),
+          triggerTimestamp_ns(0),
+          triggerIndex(0),
+          sampleRate_Hz(0) {}
+};
+
+/**
+ * @brief Triggered high-rate capture on one supply
+ *
+ * Each sample is one pipelined transaction (MEAS:VOLT?, MEAS:CURR? and
+ * optionally STAT:QUES?) on the capture thread, so the rate is bounded by
+ * the round trip time or maxRate_Hz. The driver's I/O lock is taken per
+ * sample, so other users of the same supply (a TelemetrySampler, health
+ * probes) interleave with the capture, and other supplies are not
+ * affected at all. Memory is bounded by the pre-trigger ring plus
+ * maxRecords records.
+ *
+ * Example usage:
+ * @code
+ * CaptureConfig cfg;
+ * cfg.preTrigger = 500;
+ * cfg.postTrigger = 1500;
+ * TransientCapture capture(psu.get(),
+ *     CaptureTrigger::levelCrossing(TriggerSignal::CURRENT, 2.0, TriggerEdge::RISING), cfg);
+ * capture.start();
+ *
+ * CaptureRecord record;
+ * if (capture.waitForRecord(record, 60000)) {
+ *     std::cout << record.reason << " at sample " << record.triggerIndex << std::endl;
+ * }
+ * @endcode
+ */
+class TransientCapture {
+public:
+    /**
+     * @brief Construct a capture
+     * @param supply Connected supply (not owned)
+     * @param trigger Trigger condition
+     * @param config Capture settings
+     * @throws G30Exception on null supply or invalid settings
+     */
+    TransientCapture(TDKLambdaG30* supply, const CaptureTrigger& trigger,
+                     const CaptureConfig& config = CaptureConfig());
+
+    /**
+     * @brief Destructor - stops capturing
+     */
+    ~TransientCapture();
+
+    TransientCapture(const TransientCapture&) = delete;
+    TransientCapture& operator=(const TransientCapture&) = delete;
+
+    /**
+     * @brief Set callback for completed records (only while stopped)
+     *
+     * Called from the capture thread; must not block for long.
+     *
+     * @param callback Record handler
+     * @throws G30Exception if capturing
+     */
+    void setRecordCallback(std::function<void(const CaptureRecord&)> callback);
+
+    /**
+     * @brief Start sampling and arm the trigger
+     */
+    void start();
+
+    /**
+     * @brief Stop sampling and join the capture thread
+     */
+    void stop();
+
+    /**
+     * @brief Check if sampling is active
+     * @return true if running
+     */
+    bool isRunning() const { return running_.load(); }
+
+    /**
+     * @brief Arm the trigger again (single-shot mode)
+     */
+    void arm();
+
+    /**
+     * @brief Trigger on the next sample regardless of the condition
+     */
+    void forceTrigger();
+
+    /**
+     * @brief Take the oldest completed record, waiting up to timeout_ms
+     * @param record Receives the record
+     * @param timeout_ms Time to wait (0 = do not wait)
+     * @return true if a record was taken
+     */
+    bool waitForRecord(CaptureRecord& record, int timeout_ms);
+
+    /**
+     * @brief Get number of completed records not taken yet
+     */
+    size_t pendingRecords() const;
+
+    /**
+     * @brief Get number of records dropped because maxRecords were pending
+     */
+    uint64_t droppedRecords() const { return dropped_.load(); }
+
+    /**
+     * @brief Get number of samples taken since start()
+     */
+    uint64_t sampleCount() const { return samples_.load(); }
+
+    /**
+     * @brief Get number of failed samples since start()
+     */
+    uint64_t errorCount() const { return errors_.load(); }
+
+    /**
+     * @brief Get the sampling rate measured over the last second
+     * @return Samples per second
+     */
+    double sampleRate() const;
+
+private:
+    TDKLambdaG30* supply_;
+    CaptureTrigger trigger_;
+    CaptureConfig config_;
+    std::function<void(const CaptureRecord&)> callback_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> armed_;
+    std::atomic<bool> force_;
+    std::atomic<uint64_t> samples_;
+    std::atomic<uint64_t> errors_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> rate_mHz_;    ///< Measured rate in millihertz
+
+    mutable std::mutex recordMutex_;
+    std::condition_variable recordCv_;
+    std::deque<CaptureRecord> records_;
+
+    void captureLoop();
+    bool triggered(const TelemetrySample& previous, const TelemetrySample& current,
+                   std::string& reason) const;
+    void publish(CaptureRecord&& record);
+};
+
+} // namespace TDKLambda
+
+#endif // G30_CAPTURE_H
@@ -0,0 +1,205 @@
+/**
+ * @file g30_clock.h
+ * @brief Injectable time source for driver delays and schedulers
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * The driver's settling delays, ramps, retry backoff and circuit breaker,
+ * and the schedulers built on it (PowerSequencer, SynchronizedRamp,
+ * SweepEngine), read time and sleep through an IClock. SystemClock is the
+ * default. VirtualClock lets tests run hour-long sequences in
+ * milliseconds of real time and assert their timing exactly:
+ *
+ * @code
+ * VirtualClock clock;
+ * G30Config config;
+ * config.clock = &clock;
+ * TDKLambdaG30 psu(config);
+ * psu.connect();
+ *
+ * auto t0 = clock.now();
+ * psu.setVoltageWithRamp(12.0, 1.0);  // 12 s of ramp steps
+ * assert(clock.now() - t0 >= std::chrono::seconds(12));
+ * @endcode
+ *
+ * Socket I/O timeouts always run in real time.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_CLOCK_H
+#define G30_CLOCK_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+
+namespace TDKLambda {
+
+/**
+ * @brief Time source and sleeper
+ *
+ * Time points are steady_clock time points, so code storing them does
+ * not depend on the implementation in use.
+ */
+class IClock {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    virtual ~IClock() = default;
+
+    /**
+     * @brief Get the current time
+     */
+    virtual TimePoint now() const = 0;
+
+    /**
+     * @brief Block the calling thread until a time point
+     * @param deadline Wake-up time (returns at once if already passed)
+     */
+    virtual void sleepUntil(TimePoint deadline) = 0;
+
+    /**
+     * @brief Block the calling thread for a duration
+     * @param duration Sleep length
+     */
+    template <typename Rep, typename Period>
+    void sleepFor(std::chrono::duration<Rep, Period> duration) {
+        sleepUntil(now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration));
+    }
+
+    /**
+     * @brief Announce a worker thread that runs concurrently with others
+     *
+     * Schedulers take a hold for each worker before starting it and
+     * release it when the worker is done, so a virtual clock does not pass
+     * time while a worker is still busy. No-op for real clocks.
+     */
+    virtual void hold() {}
+
+    /**
+     * @brief Release a hold taken by hold()
+     */
+    virtual void release() {}
+};
+
+/**
+ * @brief RAII hold on a clock
+ *
+ * A scheduler takes the hold before starting a worker and the worker adopts
+ * it, so the hold is released when the worker body returns or throws:
+ * @code
+ * clock.hold();
+ * std::async(std::launch::async, [&clock]() {
+ *     ClockHold hold(clock, std::adopt_lock);
+ *     ...
+ * });
+ * @endcode
+ */
+class ClockHold {
+public:
+    explicit ClockHold(IClock& clock) : clock_(clock) { clock_.hold(); }
+    ClockHold(IClock& clock, std::adopt_lock_t) : clock_(clock) {}
+    ~ClockHold() { clock_.release(); }
+
+    ClockHold(const ClockHold&) = delete;
+    ClockHold& operator=(const ClockHold&) = delete;
+
+private:
+    IClock& clock_;
+};
+
+/**
+ * @brief std::chrono::steady_clock and std::this_thread sleeps
+ */
+class SystemClock : public IClock {
+public:
+    /**
+     * @brief Get the shared instance (used when no clock is configured)
+     */
+    static SystemClock& instance();
+
+    TimePoint now() const override;
+    void sleepUntil(TimePoint deadline) override;
+};
+
+/**
+ * @brief Clock whose time only moves when it is advanced
+ *
+ * With auto-advance (the default) a sleep that leaves no held worker
+ * running moves time straight to the earliest pending wake-up, so a single
+ * thread never waits in real time and concurrent workers of a scheduler
+ * wake in exact deadline order. A thread that sleeps while held workers
+ * run must hold the clock as well, or it lets their time pass early.
+ *
+ * Without auto-advance, sleepers wait until advance() or advanceTo() moves
+ * time past their deadline, e.g. from a test driving a simulator.
+ */
+class VirtualClock : public IClock {
+public:
+    /**
+     * @brief Construct a virtual clock
+     * @param autoAdvance Jump to the earliest wake-up when all workers sleep
+     * @param start Initial time
+     */
+    explicit VirtualClock(bool autoAdvance = true, TimePoint start = TimePoint());
+
+    TimePoint now() const override;
+    void sleepUntil(TimePoint deadline) override;
+    void hold() override;
+    void release() override;
+
+    /**
+     * @brief Move time forward and wake the sleepers that are due
+     * @param duration Time to add (negative values are ignored)
+     */
+    void advance(std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Move time forward to a time point (earlier points are ignored)
+     * @param time New time
+     */
+    void advanceTo(TimePoint time);
+
+    /**
+     * @brief Enable or disable auto-advance
+     */
+    void setAutoAdvance(bool enable);
+
+    /**
+     * @brief Get number of threads sleeping on the clock
+     */
+    size_t sleepers() const;
+
+    /**
+     * @brief Wait in real time until at least count threads sleep on the clock
+     * @param count Number of sleepers
+     * @param timeout_ms Real-time limit
+     * @return true if reached
+     */
+    bool waitForSleepers(size_t count, int timeout_ms) const;
+
+    /**
+     * @brief Get number of sleeps that had to wait for time to pass
+     */
+    uint64_t sleepCount() const;
+
+private:
+    mutable std::mutex mutex_;
+    mutable std::condition_variable cv_;
+    TimePoint now_;
+    std::multiset<TimePoint> deadlines_;    ///< One entry per sleeping thread
+    size_t holds_;
+    bool autoAdvance_;
+    uint64_t sleeps_;
+
+    void autoAdvanceLocked();
+};
+
+} // namespace TDKLambda
+
+#endif // G30_CLOCK_H
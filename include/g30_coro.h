@@ -0,0 +1,421 @@
+/**
+ * @file g30_coro.h
+ * @brief Optional C++20 coroutine API over an epoll event loop
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * Lets test sequences be written as coroutines:
+ *
+ * @code
+ * Task<void> powerUp(AsyncG30& psu) {
+ *     co_await psu.setVoltage(12.0);
+ *     co_await psu.enableOutput(true);
+ *     double v = co_await psu.waitUntilSettled(12.0, 0.05, 2000);
+ *     std::cout << "Settled at " << v << " V" << std::endl;
+ * }
+ *
+ * EventLoop loop;
+ * AsyncG30 psu(loop, *g30);
+ * loop.spawn(powerUp(psu));
+ * loop.run();   // Returns when every spawned sequence has finished
+ * @endcode
+ *
+ * Sequences should be plain functions taking their state as parameters;
+ * a capturing lambda coroutine would outlive its closure object.
+ *
+ * All coroutines run on the thread calling EventLoop::run(), so sequence
+ * code needs no locking and thousands of sequences cost only their
+ * coroutine frames. Timers are served by a timerfd. Device I/O is not done
+ * on the loop: the driver is blocking, so this is a thread-pool bridge.
+ * Each AsyncG30 gets its own lane, a FIFO queue whose calls run one at a
+ * time and in order, as the driver would serialize them per device anyway.
+ * Lanes share a bounded pool of lane threads, so a fleet costs at most
+ * laneThreads OS threads, not one per device. Up to laneThreads supplies
+ * never hold each other up; beyond that a call waits for a free lane thread
+ * only while all of them are busy, e.g. when that many supplies are
+ * unresponsive at once. Concurrent device I/O is therefore capped at
+ * laneThreads; the loop does not drive the sockets itself. Other blocking()
+ * calls share a separate small pool. Finished calls resume their coroutine
+ * on the loop thread through an eventfd.
+ *
+ * Built only when CMake option G30_BUILD_COROUTINES is ON (requires C++20).
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_CORO_H
+#define G30_CORO_H
+
+#if __cplusplus < 202002L
+#error "g30_coro.h requires C++20 (configure with -DG30_BUILD_COROUTINES=ON)"
+#endif
+
+#include "tdk_lambda_g30.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace TDKLambda {
+
+template <typename T> class Task;
+
+namespace detail {
+
+struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept {
+        std::coroutine_handle<> continuation = h.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+    void return_value(T v) { value.emplace(std::move(v)); }
+
+    T result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+
+    void result() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazily started coroutine producing a T
+ *
+ * A Task starts when it is co_awaited (or passed to EventLoop::spawn) and
+ * resumes its awaiter when it completes. Exceptions propagate to the awaiter.
+ */
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    explicit Task(Handle handle) noexcept : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+
+    T await_resume() { return handle_.promise().result(); }
+
+private:
+    Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+/**
+ * @brief Single-threaded epoll event loop for coroutine sequences
+ */
+class EventLoop {
+public:
+    /**
+     * @brief Construct an event loop
+     * @param workerThreads Shared pool threads for blocking() calls without a lane
+     * @param laneThreads Maximum threads serving lanes (started as lanes are added)
+     * @throws G30Exception if epoll/eventfd/timerfd cannot be created
+     */
+    explicit EventLoop(size_t workerThreads = 4, size_t laneThreads = 16);
+
+    /**
+     * @brief Destructor - stops the worker pool and all lanes
+     */
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * @brief Start a sequence
+     *
+     * The sequence runs up to its first suspension point immediately and
+     * continues on the thread calling run().
+     *
+     * @param task Top-level sequence
+     */
+    void spawn(Task<void> task);
+
+    /**
+     * @brief Run until all spawned sequences finished or stop() is called
+     *
+     * Exceptions escaping a spawned sequence are reported to the error
+     * handler and do not stop the loop.
+     */
+    void run();
+
+    /**
+     * @brief Ask run() to return (thread-safe)
+     */
+    void stop();
+
+    /**
+     * @brief Set handler for exceptions escaping spawned sequences
+     * @param handler Error handler function
+     */
+    void setErrorHandler(std::function<void(const std::string&)> handler);
+
+    /**
+     * @brief Resume a coroutine on the loop thread (thread-safe)
+     * @param handle Suspended coroutine
+     */
+    void post(std::coroutine_handle<> handle);
+
+    /**
+     * @brief Run a function on the worker pool (thread-safe)
+     * @param job Function to run
+     */
+    void submit(std::function<void()> job);
+
+    /// Lane index selecting the shared worker pool
+    static constexpr size_t kSharedPool = static_cast<size_t>(-1);
+
+    /**
+     * @brief Add a FIFO queue whose jobs run one at a time on the lane threads (thread-safe)
+     *
+     * Starts another lane thread while there are fewer than laneThreads.
+     *
+     * @return Lane index for submit() and blocking()
+     */
+    size_t addLane();
+
+    /**
+     * @brief Run a function on a lane (thread-safe)
+     * @param job Function to run
+     * @param lane Lane from addLane(), or kSharedPool
+     */
+    void submit(std::function<void()> job, size_t lane);
+
+    /**
+     * @brief Awaitable timer
+     */
+    struct SleepAwaiter {
+        EventLoop& loop;
+        std::chrono::steady_clock::time_point deadline;
+
+        bool await_ready() const noexcept { return deadline <= std::chrono::steady_clock::now(); }
+        void await_suspend(std::coroutine_handle<> h) { loop.addTimer(deadline, h); }
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief Suspend the calling coroutine for a duration
+     * @param ms Duration in milliseconds
+     * @return Awaitable
+     */
+    SleepAwaiter sleepFor(int ms) {
+        return SleepAwaiter{*this, std::chrono::steady_clock::now() + std::chrono::milliseconds(ms)};
+    }
+
+    /**
+     * @brief Awaitable that runs a blocking call on the worker pool
+     */
+    template <typename T>
+    struct BlockingCall {
+        EventLoop& loop;
+        std::function<T()> call;
+        size_t lane;
+        std::optional<T> value;
+        std::exception_ptr error;
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> h) {
+            loop.submit([this, h]() {
+                try {
+                    value.emplace(call());
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                loop.post(h);
+            }, lane);
+        }
+
+        T await_resume() {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return std::move(*value);
+        }
+    };
+
+    /**
+     * @brief Await a blocking function without blocking the loop thread
+     * @param call Function to run
+     * @param lane Lane from addLane(), or kSharedPool
+     * @return Awaitable yielding the function's result
+     */
+    template <typename T>
+    BlockingCall<T> blocking(std::function<T()> call, size_t lane = kSharedPool) {
+        return BlockingCall<T>{*this, std::move(call), lane, std::nullopt, nullptr};
+    }
+
+private:
+    struct Lane {
+        std::deque<std::function<void()>> jobs;
+        bool scheduled = false;     ///< Queued in readyLanes_ or running a job
+    };
+
+    struct Timer {
+        std::chrono::steady_clock::time_point deadline;
+        std::coroutine_handle<> handle;
+        bool operator>(const Timer& other) const { return deadline > other.deadline; }
+    };
+
+    int epollFd_;
+    int eventFd_;
+    int timerFd_;
+    std::atomic<bool> stopRequested_;
+    size_t active_;
+    std::function<void(const std::string&)> errorHandler_;
+
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers_;
+
+    std::mutex readyMutex_;
+    std::vector<std::coroutine_handle<>> ready_;
+
+    std::mutex jobMutex_;
+    std::condition_variable jobCv_;
+    std::deque<std::function<void()>> jobs_;
+    bool workersStopping_;
+    std::vector<std::thread> workers_;
+
+    std::mutex laneMutex_;
+    std::condition_variable laneCv_;
+    std::deque<std::unique_ptr<Lane>> lanes_;     ///< Guarded by laneMutex_, lanes are never removed
+    std::deque<Lane*> readyLanes_;                ///< Lanes with jobs and none running
+    bool lanesStopping_;
+    size_t maxLaneThreads_;
+    std::vector<std::thread> laneThreads_;
+
+    void addTimer(std::chrono::steady_clock::time_point deadline, std::coroutine_handle<> handle);
+    void armTimer();
+    void wake();
+    void workerLoop();
+    void laneLoop();
+
+    friend class DetachedTask;
+    void taskFinished(std::exception_ptr error);
+};
+
+/**
+ * @brief Coroutine front end of one TDKLambdaG30
+ *
+ * Each operation runs the corresponding blocking driver call on a lane of
+ * the loop owned by this front end, in the order the operations were
+ * awaited. Create one AsyncG30 per device.
+ */
+class AsyncG30 {
+public:
+    /**
+     * @brief Construct an async front end
+     * @param loop Event loop resuming the coroutines
+     * @param psu Connected supply (not owned)
+     */
+    AsyncG30(EventLoop& loop, TDKLambdaG30& psu);
+
+    Task<double> measureVoltage();
+    Task<double> measureCurrent();
+    Task<void> setVoltage(double voltage);
+    Task<void> setCurrent(double current);
+    Task<void> enableOutput(bool enable);
+    Task<std::string> query(std::string query);
+
+    /**
+     * @brief Poll the output voltage until it is within tolerance of target
+     * @param target Expected voltage in volts
+     * @param tolerance Accepted deviation in volts
+     * @param timeout_ms Give up after this time
+     * @param poll_ms Interval between measurements
+     * @return Final measured voltage
+     * @throws G30Exception on timeout or communication error
+     */
+    Task<double> waitUntilSettled(double target, double tolerance, int timeout_ms, int poll_ms = 20);
+
+    TDKLambdaG30& device() { return psu_; }
+
+private:
+    EventLoop& loop_;
+    TDKLambdaG30& psu_;
+    size_t lane_;
+};
+
+} // namespace TDKLambda
+
+#endif // G30_CORO_H
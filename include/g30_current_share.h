@@ -0,0 +1,243 @@
+/**
+ * @file g30_current_share.h
+ * @brief Current sharing control of paralleled G30 units
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * Outputs of G30 units wired in parallel do not share load current evenly:
+ * the unit with the slightly higher output voltage supplies most of it.
+ * CurrentSharingController treats N paralleled units as one high-current
+ * source. It splits the current limit across the units, reads every unit's
+ * current over the pipelined query path at a high rate, and trims the
+ * individual voltage setpoints until the shares agree within a tolerance.
+ * A unit that trips protection or stops answering is switched off and
+ * its share of the limit is given to the remaining units.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_CURRENT_SHARE_H
+#define G30_CURRENT_SHARE_H
+
+#include "tdk_lambda_g30.h"
+#include "g30_telemetry.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Current sharing settings
+ */
+struct CurrentShareConfig {
+    int period_ms;              ///< Control cycle period
+    double tolerance;           ///< Allowed deviation of a share from the mean (fraction)
+    double minShareCurrent_A;   ///< Mean current below which no trimming is done
+    double trimGain_VperA;      ///< Voltage trim per ampere of share error and cycle
+    double maxTrim_V;           ///< Largest trim of a unit relative to the common setpoint
+    uint32_t tripMask;          ///< STAT:QUES? bits treated as a protection trip
+    int failuresBeforeDrop;     ///< Consecutive failed readings before a unit is dropped
+
+    CurrentShareConfig()
+        : period_ms(20),
+          tolerance(0.05),
+          minShareCurrent_A(0.5),
+          trimGain_VperA(0.005),
+          maxTrim_V(0.1),
+          tripMask(STATUS_OVP | STATUS_OCP | STATUS_OTP),
+          failuresBeforeDrop(3) {}
+};
+
+/**
+ * @brief Events reported by the controller
+ */
+enum class ShareEvent {
+    UNIT_TRIPPED,       ///< Unit reported a protection bit and was switched off
+    UNIT_LOST,          ///< Unit stopped answering and was dropped
+    UNIT_RESTORED,      ///< Unit rejoined after restoreUnit()
+    CAPACITY_REDUCED    ///< Remaining units cannot carry the full limit (unit = size())
+};
+
+/**
+ * @brief Result of one control cycle
+ */
+struct ShareReport {
+    std::vector<double> voltages;   ///< Measured voltage per unit (0 if not read)
+    std::vector<double> currents;   ///< Measured current per unit (0 if not read)
+    std::vector<double> trims;      ///< Voltage trim per unit
+    std::vector<bool> active;       ///< Unit takes part in sharing
+    double totalCurrent;            ///< Sum of the measured currents
+    double imbalance;               ///< Largest |share - mean| / mean (0 below minShareCurrent_A)
+    bool balanced;                  ///< imbalance within the tolerance
+    bool trimmed;                   ///< Setpoints were adjusted in this cycle
+
+    ShareReport()
+        : totalCurrent(0),
+          imbalance(0),
+          balanced(true),
+          trimmed(false) {}
+};
+
+/**
+ * @brief Treats paralleled G30 units as one high-current source
+ *
+ * Trims are sent with sendBatch() and therefore do not go through the
+ * driver's cached configuration; call readConfig() on a unit before using
+ * applyConfig() on it after sharing.
+ *
+ * Example usage:
+ * @code
+ * CurrentSharingController share({psu1.get(), psu2.get(), psu3.get()});
+ * share.setEventCallback([](size_t unit, ShareEvent event, const std::string& detail) {
+ *     std::cerr << "unit " << unit << ": " << detail << std::endl;
+ * });
+ * share.setOutput(12.0, 120.0);   // 40 A limit per unit
+ * share.enableOutput(true);
+ * share.start();
+ * ...
+ * ShareReport r = share.lastReport();
+ * @endcode
+ */
+class CurrentSharingController {
+public:
+    /**
+     * @brief Construct a controller
+     * @param supplies Connected, paralleled supplies (not owned)
+     * @param config Control settings
+     * @throws G30Exception if the list is empty or contains null, or a setting is invalid
+     */
+    explicit CurrentSharingController(const std::vector<TDKLambdaG30*>& supplies,
+                                      const CurrentShareConfig& config = CurrentShareConfig());
+
+    /**
+     * @brief Destructor - stops the control loop
+     */
+    ~CurrentSharingController();
+
+    CurrentSharingController(const CurrentSharingController&) = delete;
+    CurrentSharingController& operator=(const CurrentSharingController&) = delete;
+
+    /**
+     * @brief Set callback for events (only while stopped)
+     *
+     * Called with (unit, event, detail) from the thread running the cycle.
+     *
+     * @param callback Event handler
+     * @throws G30Exception if the loop is running
+     */
+    void setEventCallback(std::function<void(size_t, ShareEvent, const std::string&)> callback);
+
+    /**
+     * @brief Program the common voltage and split the current limit
+     *
+     * Every active unit gets the voltage and totalCurrent / active units as
+     * its limit (capped at the unit's rating). Trims are cleared.
+     *
+     * @param voltage Output voltage in volts
+     * @param totalCurrent Current limit of the combined source in amperes
+     * @throws G30Exception if out of range, no unit is active, or a unit fails
+     */
+    void setOutput(double voltage, double totalCurrent);
+
+    /**
+     * @brief Enable or disable the outputs of all active units concurrently
+     * @param enable true to enable, false to disable
+     */
+    void enableOutput(bool enable);
+
+    /**
+     * @brief Run one control cycle: read, check trips, rebalance
+     * @return Cycle report
+     */
+    ShareReport step();
+
+    /**
+     * @brief Start the control loop thread
+     */
+    void start();
+
+    /**
+     * @brief Stop the control loop and join the thread
+     */
+    void stop();
+
+    /**
+     * @brief Check if the control loop is running
+     * @return true if running
+     */
+    bool isRunning() const { return running_.load(); }
+
+    /**
+     * @brief Clear protection on a dropped unit and let it rejoin
+     *
+     * The unit is programmed with the common voltage and its output is
+     * switched on if the others are on; the limit is split again.
+     *
+     * @param unit Unit index
+     * @throws G30Exception if the index is invalid or the unit fails
+     */
+    void restoreUnit(size_t unit);
+
+    /**
+     * @brief Get the report of the most recent cycle
+     */
+    ShareReport lastReport() const;
+
+    /**
+     * @brief Get the number of units currently sharing
+     */
+    size_t activeUnits() const;
+
+    /**
+     * @brief Get the current limit programmed on each active unit
+     */
+    double unitCurrentLimit() const;
+
+    /**
+     * @brief Get number of paralleled units
+     */
+    size_t size() const { return supplies_.size(); }
+
+private:
+    struct PendingEvent {
+        size_t unit;
+        ShareEvent event;
+        std::string detail;
+    };
+
+    std::vector<TDKLambdaG30*> supplies_;
+    CurrentShareConfig config_;
+    std::function<void(size_t, ShareEvent, const std::string&)> callback_;
+
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::mutex stopMutex_;
+    std::condition_variable stopCv_;
+
+    // Serializes cycles with setOutput()/restoreUnit(); guards everything below
+    mutable std::mutex controlMutex_;
+    std::vector<bool> active_;
+    std::vector<double> trims_;
+    std::vector<int> failures_;
+    double voltage_;
+    double totalCurrent_;
+    double unitLimit_;
+    bool outputEnabled_;
+    ShareReport report_;
+    std::vector<PendingEvent> pending_;     ///< Events raised under the lock, fired after it
+
+    void controlLoop();
+    void dropUnit(size_t unit, ShareEvent event, const std::string& detail);
+    void distributeLimit();
+    void notify(size_t unit, ShareEvent event, const std::string& detail);
+};
+
+} // namespace TDKLambda
+
+#endif // G30_CURRENT_SHARE_H
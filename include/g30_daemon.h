@@ -0,0 +1,276 @@
+/**
+ * @file g30_daemon.h
+ * @brief Connection-owning multiplexing daemon and its Unix-socket client
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * The G30 accepts only a few simultaneous TCP sessions. G30Daemon owns the
+ * device connections and serves any number of local clients over a Unix
+ * domain socket. Per device, requests from all clients are taken
+ * round-robin (one per client per turn) and consecutive queries are merged
+ * into a single pipelined round trip. Duplicates of side-effect-free
+ * queries (MEAS:...?, OUTP?, STAT:QUES?, VOLT?, CURR?, VOLT:PROT?, *IDN?)
+ * are answered once, and those queries may be answered from a response
+ * cache if they tolerate stale data; any other query, such as SYST:ERR?,
+ * always gets its own answer. Requests of a client that disconnects are
+ * dropped.
+ * Replies are queued per client and written by the listener without
+ * blocking, so a client that stops reading never stalls a device; it is
+ * disconnected once its queue exceeds DaemonConfig::maxClientQueue.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_DAEMON_H
+#define G30_DAEMON_H
+
+#include "tdk_lambda_g30.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Binary client protocol
+ *
+ * Every message is a FrameHeader followed by `length` payload bytes.
+ * Integers are in host byte order (the socket is local to the host).
+ */
+namespace DaemonProtocol {
+
+/**
+ * @brief Frame types
+ */
+enum FrameType : uint16_t {
+    FRAME_QUERY = 1,        ///< Payload: SCPI query. maxAge_ms > 0 allows a cached answer
+    FRAME_COMMAND = 2,      ///< Payload: SCPI command (no response from the device)
+    FRAME_LIST = 3,         ///< List device names (device field ignored)
+    FRAME_RESPONSE = 0x81,  ///< Payload: response text (empty for commands)
+    FRAME_ERROR = 0x82      ///< Payload: error message
+};
+
+/**
+ * @brief Frame header (16 bytes)
+ */
+struct FrameHeader {
+    uint32_t length;        ///< Payload length in bytes
+    uint16_t type;          ///< FrameType
+    uint16_t device;        ///< Device index (see FRAME_LIST)
+    uint32_t requestId;     ///< Echoed in the reply
+    uint32_t maxAge_ms;     ///< Query: accepted cache age (0 = always ask the device)
+};
+
+static_assert(sizeof(FrameHeader) == 16, "Daemon frame header must be 16 bytes");
+
+constexpr uint32_t kMaxPayload = 64 * 1024;    ///< Larger frames close the connection
+
+} // namespace DaemonProtocol
+
+/**
+ * @brief Daemon settings
+ */
+struct DaemonConfig {
+    std::string socketPath;     ///< Unix socket path
+    int maxBatch;               ///< Maximum requests merged into one device turn
+    size_t maxClientQueue;      ///< Reply bytes queued for a client before it is disconnected
+
+    DaemonConfig()
+        : socketPath("/tmp/g30d.sock"),
+          maxBatch(32),
+          maxClientQueue(1024 * 1024) {}
+};
+
+/**
+ * @brief Daemon counters
+ */
+struct DaemonStats {
+    uint64_t requests;          ///< Requests received
+    uint64_t cacheHits;         ///< Queries answered from the cache
+    uint64_t mergedQueries;     ///< Duplicate side-effect-free queries answered by another client's round trip
+    uint64_t deviceRoundTrips;  ///< Pipelined query batches sent to devices
+    uint64_t clients;           ///< Clients connected so far
+
+    DaemonStats()
+        : requests(0),
+          cacheHits(0),
+          mergedQueries(0),
+          deviceRoundTrips(0),
+          clients(0) {}
+};
+
+/**
+ * @brief Multiplexing daemon owning the device connections
+ *
+ * Example usage:
+ * @code
+ * DaemonConfig dc;
+ * dc.socketPath = "/run/g30d.sock";
+ * G30Daemon daemon(dc);
+ * G30Config rail1;
+ * rail1.ipAddress = "192.168.1.100";
+ * daemon.addDevice("rail1", rail1);
+ * daemon.start();
+ * @endcode
+ */
+class G30Daemon {
+public:
+    /**
+     * @brief Construct a daemon
+     * @param config Daemon settings
+     */
+    explicit G30Daemon(const DaemonConfig& config);
+
+    /**
+     * @brief Destructor - stops the daemon
+     */
+    ~G30Daemon();
+
+    G30Daemon(const G30Daemon&) = delete;
+    G30Daemon& operator=(const G30Daemon&) = delete;
+
+    /**
+     * @brief Add a device connection owned by the daemon (only while stopped)
+     *
+     * The device is connected without *RST (resetOnConnect is cleared), so
+     * starting the daemon keeps the supply's present settings.
+     *
+     * @param name Device name reported to clients
+     * @param config Connection parameters
+     * @throws G30Exception if the daemon is running
+     */
+    void addDevice(const std::string& name, const G30Config& config);
+
+    /**
+     * @brief Add an existing supply instance (only while stopped)
+     * @param name Device name reported to clients
+     * @param psu Supply instance, ownership is transferred
+     * @throws G30Exception if the daemon is running or psu is null
+     */
+    void addDevice(const std::string& name, std::unique_ptr<TDKLambdaG30> psu);
+
+    /**
+     * @brief Connect all devices, bind the socket and start serving
+     *
+     * A socket file left by a daemon that died is replaced; one that a
+     * running daemon still accepts connections on is not.
+     *
+     * @throws G30Exception if a device cannot be connected, the socket is in
+     *         use by a running daemon or cannot be bound
+     */
+    void start();
+
+    /**
+     * @brief Stop serving, close client connections and join all threads
+     *
+     * Devices are disconnected with their outputs left as the clients set them.
+     */
+    void stop();
+
+    /**
+     * @brief Check if the daemon is serving
+     * @return true if running
+     */
+    bool isRunning() const { return running_.load(); }
+
+    /**
+     * @brief Get current counters
+     * @return Statistics snapshot
+     */
+    DaemonStats stats() const;
+
+private:
+    struct Client;
+    struct Request;
+    struct Device;
+
+    DaemonConfig config_;
+    std::vector<std::unique_ptr<Device>> devices_;
+    std::atomic<bool> running_;
+    int listenFd_;
+    int wakePipe_[2];
+    std::thread listener_;
+
+    std::atomic<uint64_t> requests_;
+    std::atomic<uint64_t> cacheHits_;
+    std::atomic<uint64_t> mergedQueries_;
+    std::atomic<uint64_t> roundTrips_;
+    std::atomic<uint64_t> clientCount_;
+
+    void listenLoop();
+    void deviceLoop(Device& device);
+    void runQueries(Device& device, const std::vector<Request>& turn, size_t begin, size_t end);
+    void dropRequests(const Client& client);
+    bool handleFrame(const std::shared_ptr<Client>& client,
+                     const DaemonProtocol::FrameHeader& header, std::string payload);
+    void reply(Client& client, uint16_t type, uint32_t requestId, const std::string& payload);
+};
+
+/**
+ * @brief Synchronous client of a G30Daemon
+ *
+ * Example usage:
+ * @code
+ * G30DaemonClient client("/run/g30d.sock");
+ * std::vector<std::string> names = client.listDevices();
+ * double v = std::stod(client.query(0, "MEAS:VOLT?", 200));  // accept 200 ms old data
+ * client.command(0, "VOLT 5.000");
+ * @endcode
+ */
+class G30DaemonClient {
+public:
+    /**
+     * @brief Connect to a daemon
+     * @param socketPath Unix socket path
+     * @throws G30Exception if the connection fails
+     */
+    explicit G30DaemonClient(const std::string& socketPath);
+
+    /**
+     * @brief Destructor - closes the connection
+     */
+    ~G30DaemonClient();
+
+    G30DaemonClient(const G30DaemonClient&) = delete;
+    G30DaemonClient& operator=(const G30DaemonClient&) = delete;
+
+    /**
+     * @brief Get names of the devices served by the daemon
+     * @return Device names, indexed by device number
+     * @throws G30Exception on error
+     */
+    std::vector<std::string> listDevices();
+
+    /**
+     * @brief Send a query to a device
+     * @param device Device index
+     * @param query SCPI query
+     * @param maxAge_ms Accepted age of a cached answer (0 = always ask the device)
+     * @return Trimmed response
+     * @throws G30Exception on error
+     */
+    std::string query(uint16_t device, const std::string& query, uint32_t maxAge_ms = 0);
+
+    /**
+     * @brief Send a command to a device
+     * @param device Device index
+     * @param command SCPI command
+     * @throws G30Exception on error
+     */
+    void command(uint16_t device, const std::string& command);
+
+private:
+    int fd_;
+    uint32_t nextRequestId_;
+
+    std::string transact(uint16_t type, uint16_t device, const std::string& payload, uint32_t maxAge_ms);
+};
+
+} // namespace TDKLambda
+
+#endif // G30_DAEMON_H
@@ -0,0 +1,211 @@
+/**
+ * @file g30_health.h
+ * @brief Connection health monitoring with RTT tracking and heartbeats
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * HealthMonitor probes every supply whose connection has been idle for a
+ * heartbeat interval with one cheap query and keeps per-device round-trip
+ * statistics (EWMA, minimum, jitter, loss). Devices answering application
+ * traffic are not probed. From these statistics each device is classified
+ * as healthy, degraded or down, so schedulers can route around slow or
+ * unreachable units before a real command hits the full timeout.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_HEALTH_H
+#define G30_HEALTH_H
+
+#include "tdk_lambda_g30.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Health classification of one device
+ */
+enum class HealthState {
+    UNKNOWN,        ///< Not probed yet
+    HEALTHY,        ///< Answering within the RTT and loss limits
+    DEGRADED,       ///< Answering, but slow or lossy
+    DOWN            ///< Consecutive heartbeats lost
+};
+
+/**
+ * @brief Get a printable name of a health state
+ * @param state Health state
+ * @return Name such as "healthy"
+ */
+const char* healthStateName(HealthState state);
+
+/**
+ * @brief Round-trip statistics of one device
+ */
+struct RttStats {
+    uint64_t probes;            ///< Heartbeats sent
+    uint64_t losses;            ///< Heartbeats without a reply
+    int consecutiveLosses;      ///< Current run of lost heartbeats
+    double last_ms;             ///< Last measured RTT
+    double ewma_ms;             ///< Smoothed RTT (gain 1/8)
+    double min_ms;              ///< Lowest RTT seen
+    double jitter_ms;           ///< Smoothed RTT variation (gain 1/16, as RFC 3550)
+    double lossRate;            ///< Smoothed loss fraction (gain 1/10)
+
+    RttStats()
+        : probes(0),
+          losses(0),
+          consecutiveLosses(0),
+          last_ms(0.0),
+          ewma_ms(0.0),
+          min_ms(0.0),
+          jitter_ms(0.0),
+          lossRate(0.0) {}
+};
+
+/**
+ * @brief Health monitor settings
+ */
+struct HealthConfig {
+    int interval_ms;            ///< Heartbeat period of an idle device
+    int probeTimeout_ms;        ///< Wait for a heartbeat reply (one attempt, never retried)
+    std::string probeQuery;     ///< Cheapest query of the device
+    double degradedRtt_ms;      ///< Smoothed RTT above which a device is degraded
+    double degradedLossRate;    ///< Loss rate above which a device is degraded
+    int downAfterLosses;        ///< Consecutive losses before a device is down
+
+    HealthConfig()
+        : interval_ms(1000),
+          probeTimeout_ms(250),
+          probeQuery("OUTP?"),
+          degradedRtt_ms(20.0),
+          degradedLossRate(0.05),
+          downAfterLosses(3) {}
+};
+
+/**
+ * @brief Heartbeat-based health monitor for a set of supplies
+ *
+ * Example usage:
+ * @code
+ * HealthMonitor health({psu1.get(), psu2.get()});
+ * health.setStateCallback([](size_t device, HealthState from, HealthState to) {
+ *     std::cout << device << ": " << healthStateName(to) << std::endl;
+ * });
+ * health.start();
+ * ...
+ * for (size_t d : health.devicesIn(HealthState::HEALTHY)) { ... }
+ * @endcode
+ */
+class HealthMonitor {
+public:
+    /**
+     * @brief Construct a monitor
+     * @param supplies Connected supplies (not owned)
+     * @param config Monitor settings
+     * @throws G30Exception if the supply list is empty or contains null
+     */
+    explicit HealthMonitor(const std::vector<TDKLambdaG30*>& supplies,
+                           const HealthConfig& config = HealthConfig());
+
+    /**
+     * @brief Destructor - stops monitoring
+     */
+    ~HealthMonitor();
+
+    HealthMonitor(const HealthMonitor&) = delete;
+    HealthMonitor& operator=(const HealthMonitor&) = delete;
+
+    /**
+     * @brief Set callback for state changes (only while stopped)
+     *
+     * Called from the monitor threads with (device, previous, current).
+     *
+     * @param callback State change handler
+     * @throws G30Exception if the monitor is running
+     */
+    void setStateCallback(std::function<void(size_t, HealthState, HealthState)> callback);
+
+    /**
+     * @brief Start one heartbeat thread per supply
+     */
+    void start();
+
+    /**
+     * @brief Stop monitoring and join the threads
+     */
+    void stop();
+
+    /**
+     * @brief Check if monitoring is active
+     * @return true if running
+     */
+    bool isRunning() const { return running_.load(); }
+
+    /**
+     * @brief Send one heartbeat now and update the statistics
+     * @param device Supply index
+     * @return Resulting health state
+     */
+    HealthState probe(size_t device);
+
+    /**
+     * @brief Get the health state of a device
+     * @param device Supply index
+     * @return Current state
+     */
+    HealthState state(size_t device) const;
+
+    /**
+     * @brief Get the RTT statistics of a device
+     * @param device Supply index
+     * @return Statistics snapshot
+     */
+    RttStats stats(size_t device) const;
+
+    /**
+     * @brief Get the devices currently in a state
+     * @param state State to select
+     * @return Supply indices in ascending order
+     */
+    std::vector<size_t> devicesIn(HealthState state) const;
+
+    /**
+     * @brief Get number of monitored supplies
+     * @return Supply count
+     */
+    size_t size() const { return supplies_.size(); }
+
+private:
+    struct DeviceHealth {
+        RttStats stats;
+        HealthState state;
+    };
+
+    std::vector<TDKLambdaG30*> supplies_;
+    HealthConfig config_;
+    std::function<void(size_t, HealthState, HealthState)> callback_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_;
+
+    std::mutex stopMutex_;
+    std::condition_variable stopCv_;
+
+    mutable std::mutex healthMutex_;
+    std::vector<DeviceHealth> health_;
+
+    void monitorLoop(size_t device);
+    HealthState classify(const RttStats& stats) const;
+    void record(size_t device, bool answered, double rtt_ms);
+};
+
+} // namespace TDKLambda
+
+#endif // G30_HEALTH_H
@@ -0,0 +1,236 @@
+/**
+ * @file g30_multichannel.h
+ * @brief Logical multi-channel power supply built from several units
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * MultiChannelSupply presents a rack of single-channel G30 units (or any
+ * IPowerSupply) as one instrument. Channels 1..N are mapped onto the
+ * underlying supplies in order, so code written against the channel
+ * argument of IPowerSupply drives the whole rack. Whole-instrument
+ * operations and the batch accessors talk to all units concurrently.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_MULTICHANNEL_H
+#define G30_MULTICHANNEL_H
+
+#include "tdk_lambda_g30.h"
+#include <functional>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Composite IPowerSupply mapping channels onto several supplies
+ *
+ * Every supply contributes as many channels as its capabilities report,
+ * so a G30 adds one channel and a nested composite adds all of its own.
+ * Per-channel calls are forwarded to the owning supply; calls on channels
+ * of different supplies may be made from different threads in parallel.
+ *
+ * Example usage:
+ * @code
+ * MultiChannelSupply rack({psu1.get(), psu2.get(), psu3.get()});
+ * rack.connect();                          // All units in parallel
+ * rack.setVoltage(5.0, 2);                 // Channel 2 = psu2
+ * rack.setVoltages({12.0, 5.0, 3.3});      // One round of parallel writes
+ * rack.enableOutput(true);
+ * std::vector<double> v = rack.measureVoltages();
+ * @endcode
+ */
+class MultiChannelSupply : public PowerSupply::IPowerSupply {
+public:
+    /**
+     * @brief Construct over supplies owned by the caller
+     * @param supplies Supplies in channel order (not owned)
+     * @throws G30Exception if the list is empty or contains null
+     */
+    explicit MultiChannelSupply(const std::vector<PowerSupply::IPowerSupply*>& supplies);
+
+    ~MultiChannelSupply() override = default;
+
+    MultiChannelSupply(const MultiChannelSupply&) = delete;
+    MultiChannelSupply& operator=(const MultiChannelSupply&) = delete;
+
+    // ==================== Channel Mapping ====================
+
+    /**
+     * @brief Get number of logical channels
+     * @return Channel count N (channels are numbered 1..N)
+     */
+    int channelCount() const { return static_cast<int>(routes_.size()); }
+
+    /**
+     * @brief Get number of underlying supplies
+     * @return Supply count
+     */
+    size_t unitCount() const { return units_.size(); }
+
+    /**
+     * @brief Get the supply behind a channel
+     * @param channel Logical channel (1..N)
+     * @return Underlying supply
+     * @throws G30Exception if the channel is out of range
+     */
+    PowerSupply::IPowerSupply* supply(int channel) const;
+
+    /**
+     * @brief Get the channel number of a logical channel on its supply
+     * @param channel Logical channel (1..N)
+     * @return Channel number passed to the underlying supply
+     * @throws G30Exception if the channel is out of range
+     */
+    int unitChannel(int channel) const;
+
+    // ==================== IPowerSupply ====================
+
+    /**
+     * @brief Connect all supplies concurrently
+     * @throws G30Exception naming the first supply that failed
+     */
+    void connect() override;
+
+    /**
+     * @brief Disconnect all supplies concurrently
+     */
+    void disconnect() override;
+
+    /**
+     * @brief Check if every supply is connected
+     */
+    bool isConnected() const override;
+
+    /**
+     * @brief Enable or disable all outputs concurrently
+     * @param enable true to enable, false to disable
+     */
+    void enableOutput(bool enable) override;
+
+    /**
+     * @brief Check if every output is enabled
+     */
+    bool isOutputEnabled() const override;
+
+    /**
+     * @brief Reset all supplies concurrently
+     */
+    void reset() override;
+
+    void setVoltage(double voltage, int channel = 1) override;
+    double getVoltage(int channel = 1) const override;
+    double measureVoltage(int channel = 1) const override;
+    void setCurrent(double current, int channel = 1) override;
+    double getCurrent(int channel = 1) const override;
+    double measureCurrent(int channel = 1) const override;
+    double measurePower(int channel = 1) const override;
+    void setOverVoltageProtection(double voltage, int channel = 1) override;
+    PowerSupply::PowerSupplyStatus getStatus(int channel = 1) const override;
+
+    /**
+     * @brief Clear protection faults on all supplies concurrently
+     */
+    void clearProtection() override;
+
+    /**
+     * @brief Get identifications of all supplies joined with "; "
+     */
+    std::string getIdentification() const override;
+
+    /**
+     * @brief Get capabilities of the composite
+     *
+     * numberOfChannels is the channel count, maxVoltage and maxCurrent are
+     * the largest of any channel, maxPower is the sum over the supplies and
+     * a feature is reported only if every supply has it.
+     */
+    PowerSupply::PowerSupplyCapabilities getCapabilities() const override;
+
+    /**
+     * @brief Get the common vendor (CUSTOM if the supplies differ)
+     */
+    PowerSupply::Vendor getVendor() const override;
+
+    /**
+     * @brief Get the model, e.g. "3xG30"
+     */
+    std::string getModel() const override;
+
+    /**
+     * @brief Send a raw command to all supplies concurrently
+     * @return Responses in supply order joined with ';'
+     */
+    std::string sendCommand(const std::string& command) override;
+
+    /**
+     * @brief Send a raw query to all supplies concurrently
+     * @return Responses in supply order joined with ';'
+     */
+    std::string sendQuery(const std::string& query) const override;
+
+    // ==================== Batch Operations ====================
+
+    /**
+     * @brief Program one voltage per channel, all supplies in parallel
+     * @param voltages Voltage per channel (size N)
+     * @throws G30Exception on size mismatch or naming the first failed channel
+     */
+    void setVoltages(const std::vector<double>& voltages);
+
+    /**
+     * @brief Program one current limit per channel, all supplies in parallel
+     * @param currents Current per channel (size N)
+     * @throws G30Exception on size mismatch or naming the first failed channel
+     */
+    void setCurrents(const std::vector<double>& currents);
+
+    /**
+     * @brief Measure all output voltages in parallel
+     * @return Voltage per channel
+     */
+    std::vector<double> measureVoltages() const;
+
+    /**
+     * @brief Measure all output currents in parallel
+     * @return Current per channel
+     */
+    std::vector<double> measureCurrents() const;
+
+    /**
+     * @brief Read the status of all channels in parallel
+     * @return Status per channel
+     */
+    std::vector<PowerSupply::PowerSupplyStatus> getStatuses() const;
+
+private:
+    struct Route {
+        size_t unit;            ///< Index into units_
+        int channel;            ///< Channel on that supply
+    };
+
+    std::vector<PowerSupply::IPowerSupply*> units_;
+    std::vector<Route> routes_;
+
+    void buildRoutes();
+    const Route& route(int channel) const;
+
+    /**
+     * Run fn(unit) for every supply, one thread per supply. All tasks
+     * finish before the first failure is rethrown as a G30Exception.
+     */
+    void forEachUnit(const std::function<void(size_t)>& fn) const;
+
+    /**
+     * Run fn(channelIndex) for every channel (0-based). Channels of one
+     * supply run in order on that supply's thread.
+     */
+    void forEachChannel(const std::function<void(size_t)>& fn) const;
+
+    std::string joinResponses(const std::function<std::string(PowerSupply::IPowerSupply*)>& fn) const;
+};
+
+} // namespace TDKLambda
+
+#endif // G30_MULTICHANNEL_H
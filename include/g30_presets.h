@@ -0,0 +1,130 @@
+/**
+ * @file g30_presets.h
+ * @brief Named test recipes stored in G30 setup memories (*SAV, *RCL)
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * Maps recipe names to the supply's internal setup memories so that
+ * switching recipes costs a single *RCL write instead of re-sending every
+ * setpoint. Slot contents that were not written in this session are
+ * verified lazily, on their first recall.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_PRESETS_H
+#define G30_PRESETS_H
+
+#include "tdk_lambda_g30.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Host-side bookkeeping of recipes stored in one supply
+ *
+ * Example usage:
+ * @code
+ * PresetBank presets(*psu);
+ *
+ * DeviceConfig burnIn;
+ * burnIn.voltage = 12.0;
+ * burnIn.current = 3.0;
+ * burnIn.overVoltageProtection = 14.0;
+ * presets.store("burn-in", burnIn);
+ *
+ * presets.recall("burn-in");   // single *RCL write
+ * @endcode
+ */
+class PresetBank {
+public:
+    /**
+     * @brief Construct a preset bank for a supply
+     * @param psu Connected supply (not owned)
+     */
+    explicit PresetBank(TDKLambdaG30& psu);
+
+    /**
+     * @brief Program a configuration and store it under a name
+     *
+     * Reuses the recipe's slot if the name is known, otherwise takes the
+     * first free slot.
+     *
+     * @param name Recipe name
+     * @param config Settings to store
+     * @return Slot used
+     * @throws G30Exception if no slot is free or communication fails
+     */
+    int store(const std::string& name, const DeviceConfig& config);
+
+    /**
+     * @brief Register a recipe already present in a slot (e.g. from an earlier session)
+     *
+     * The slot is verified against the expected settings on its first recall.
+     *
+     * @param name Recipe name
+     * @param slot Slot holding the recipe
+     * @param expected Settings the slot is expected to contain
+     * @throws G30Exception if slot is out of range or already used by another recipe
+     */
+    void assign(const std::string& name, int slot, const DeviceConfig& expected);
+
+    /**
+     * @brief Switch the supply to a stored recipe
+     *
+     * If a recipe registered with assign() turns out not to match its slot
+     * on the first recall, the settings from before the recall are restored
+     * with the output off before the exception is thrown.
+     *
+     * @param name Recipe name
+     * @throws G30Exception if unknown, if lazy verification fails or on communication error
+     */
+    void recall(const std::string& name);
+
+    /**
+     * @brief Forget a recipe (the slot contents are left untouched)
+     * @param name Recipe name
+     */
+    void remove(const std::string& name);
+
+    /**
+     * @brief Check whether a recipe is known
+     * @param name Recipe name
+     * @return true if known
+     */
+    bool contains(const std::string& name) const;
+
+    /**
+     * @brief Get the slot of a recipe
+     * @param name Recipe name
+     * @return Slot number
+     * @throws G30Exception if unknown
+     */
+    int slotOf(const std::string& name) const;
+
+    /**
+     * @brief Get all recipe names
+     * @return Names in alphabetical order
+     */
+    std::vector<std::string> names() const;
+
+private:
+    struct Entry {
+        int slot;
+        DeviceConfig expected;
+        bool verified;
+    };
+
+    TDKLambdaG30& psu_;
+    std::map<std::string, Entry> entries_;
+
+    int freeSlot() const;
+    bool slotInUse(int slot, const std::string& except) const;
+};
+
+} // namespace TDKLambda
+
+#endif // G30_PRESETS_H
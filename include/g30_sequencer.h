@@ -0,0 +1,286 @@
+/**
+ * @file g30_sequencer.h
+ * @brief Dependency-graph power sequencing across several G30 units
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * A PowerSequence is a directed acyclic graph of rail steps. Each step
+ * waits for the steps it depends on, waits an optional delay, performs
+ * one action on one supply (program a voltage or current, switch the
+ * output) and then optionally polls the measured voltage until it crosses
+ * a threshold within a timeout. PowerSequencer runs independent branches
+ * concurrently and returns a timing trace comparing every step with the
+ * time the specification allows.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_SEQUENCER_H
+#define G30_SEQUENCER_H
+
+#include "tdk_lambda_g30.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Action performed by a sequence step
+ */
+enum class SequenceAction {
+    NONE,           ///< No action (pure delay or condition step)
+    SET_VOLTAGE,    ///< Program voltage to value
+    SET_CURRENT,    ///< Program current limit to value
+    OUTPUT_ON,      ///< Enable the output
+    OUTPUT_OFF      ///< Disable the output
+};
+
+/**
+ * @brief Completion condition of a sequence step
+ */
+enum class SequenceCondition {
+    NONE,           ///< Complete as soon as the action returns
+    VOLTAGE_ABOVE,  ///< Measured voltage >= threshold
+    VOLTAGE_BELOW   ///< Measured voltage <= threshold
+};
+
+/**
+ * @brief One node of a power sequence
+ */
+struct SequenceStep {
+    std::string name;               ///< Unique step name
+    size_t device;                  ///< Index of the supply in the sequencer
+    std::vector<std::string> after; ///< Steps that must complete first
+    int delay_ms;                   ///< Wait after the dependencies before acting
+    SequenceAction action;          ///< Action to perform
+    double value;                   ///< Voltage or current for SET_* actions
+    SequenceCondition condition;    ///< Completion condition
+    double threshold;               ///< Voltage threshold of the condition
+    int timeout_ms;                 ///< Time allowed for the condition (from the action)
+
+    SequenceStep()
+        : device(0),
+          delay_ms(0),
+          action(SequenceAction::NONE),
+          value(0.0),
+          condition(SequenceCondition::NONE),
+          threshold(0.0),
+          timeout_ms(1000) {}
+};
+
+/**
+ * @brief A validated DAG of sequence steps
+ *
+ * Example usage (3.3 V rail up before 1.8 V and 1.2 V, which come up together):
+ * @code
+ * PowerSequence up;
+ * up.setVoltage("v33", 0, 3.3)
+ *   .outputOn("v33_on", 0, {"v33"}).waitAbove(3.0, 50)
+ *   .outputOn("v18_on", 1, {"v33_on"}, 5).waitAbove(1.7, 50)
+ *   .outputOn("v12_on", 2, {"v33_on"}, 5).waitAbove(1.1, 50);
+ * @endcode
+ */
+class PowerSequence {
+public:
+    /**
+     * @brief Add a fully specified step
+     * @param step Step definition
+     * @return *this for chaining
+     * @throws G30Exception if the name is empty or already used
+     */
+    PowerSequence& add(const SequenceStep& step);
+
+    /**
+     * @brief Add a SET_VOLTAGE step
+     */
+    PowerSequence& setVoltage(const std::string& name, size_t device, double voltage,
+                              const std::vector<std::string>& after = {}, int delay_ms = 0);
+
+    /**
+     * @brief Add a SET_CURRENT step
+     */
+    PowerSequence& setCurrent(const std::string& name, size_t device, double current,
+                              const std::vector<std::string>& after = {}, int delay_ms = 0);
+
+    /**
+     * @brief Add an OUTPUT_ON step
+     */
+    PowerSequence& outputOn(const std::string& name, size_t device,
+                            const std::vector<std::string>& after = {}, int delay_ms = 0);
+
+    /**
+     * @brief Add an OUTPUT_OFF step
+     */
+    PowerSequence& outputOff(const std::string& name, size_t device,
+                             const std::vector<std::string>& after = {}, int delay_ms = 0);
+
+    /**
+     * @brief Add a step that only waits for its dependencies and a delay
+     */
+    PowerSequence& delay(const std::string& name, int delay_ms,
+                         const std::vector<std::string>& after = {});
+
+    /**
+     * @brief Make the last added step wait for voltage >= threshold
+     * @param threshold Voltage threshold
+     * @param timeout_ms Time allowed after the action
+     * @throws G30Exception if no step was added
+     */
+    PowerSequence& waitAbove(double threshold, int timeout_ms);
+
+    /**
+     * @brief Make the last added step wait for voltage <= threshold
+     * @param threshold Voltage threshold
+     * @param timeout_ms Time allowed after the action
+     * @throws G30Exception if no step was added
+     */
+    PowerSequence& waitBelow(double threshold, int timeout_ms);
+
+    /**
+     * @brief Check dependencies and compute the execution order
+     *
+     * Called by PowerSequencer::run(); may be called earlier to fail fast.
+     *
+     * @return Step indices in topological order
+     * @throws G30Exception on unknown dependencies or cycles
+     */
+    std::vector<size_t> validate() const;
+
+    const std::vector<SequenceStep>& steps() const { return steps_; }
+    size_t size() const { return steps_.size(); }
+
+private:
+    std::vector<SequenceStep> steps_;
+};
+
+/**
+ * @brief Outcome of one step
+ */
+enum class StepOutcome {
+    PENDING,        ///< Not started
+    DONE,           ///< Action performed and condition met
+    TIMEOUT,        ///< Condition not met within timeout_ms
+    FAILED,         ///< Action or measurement failed
+    SKIPPED         ///< Not run because the sequence was aborted
+};
+
+/**
+ * @brief Get a printable name of a step outcome
+ * @param outcome Step outcome
+ * @return Name such as "done"
+ */
+const char* stepOutcomeName(StepOutcome outcome);
+
+/**
+ * @brief Timing of one step, actual versus specification
+ *
+ * All times are in milliseconds from the start of the run. The specified
+ * start assumes every action and condition completes instantly, so it is
+ * the earliest time the graph and its delays allow.
+ */
+struct StepTrace {
+    std::string name;               ///< Step name
+    size_t device;                  ///< Supply index
+    StepOutcome outcome;            ///< Result
+    double specStart_ms;            ///< Earliest start allowed by the spec
+    double start_ms;                ///< Action issued
+    double actionDone_ms;           ///< Action returned
+    double done_ms;                 ///< Condition met (or step ended)
+    double lateness_ms;             ///< start_ms - specStart_ms
+    double lastVoltage;             ///< Last measured voltage of a condition
+    int polls;                      ///< Measurements taken for the condition
+    std::string error;              ///< Failure description
+
+    StepTrace()
+        : device(0),
+          outcome(StepOutcome::PENDING),
+          specStart_ms(0),
+          start_ms(0),
+          actionDone_ms(0),
+          done_ms(0),
+          lateness_ms(0),
+          lastVoltage(0),
+          polls(0) {}
+};
+
+/**
+ * @brief Result of a sequence run
+ */
+struct SequenceTrace {
+    std::vector<StepTrace> steps;   ///< Per-step trace in definition order
+    bool completed;                 ///< Every step reached DONE
+    double duration_ms;             ///< Wall time of the run
+    double specDuration_ms;         ///< Critical-path time of the spec
+    double maxLateness_ms;          ///< Worst start lateness over the run steps
+
+    SequenceTrace()
+        : completed(false),
+          duration_ms(0),
+          specDuration_ms(0),
+          maxLateness_ms(0) {}
+};
+
+/**
+ * @brief Sequencer settings
+ */
+struct SequencerConfig {
+    int pollInterval_ms;        ///< Period of condition measurements
+    bool disableOnAbort;        ///< Switch off every sequenced output when a step fails
+
+    SequencerConfig()
+        : pollInterval_ms(2),
+          disableOnAbort(true) {}
+};
+
+/**
+ * @brief Executes power sequences on a set of supplies
+ *
+ * Each step runs on its own thread as soon as its dependencies have
+ * completed, so independent branches proceed concurrently. Conditions are
+ * polled with single pipelined MEAS:VOLT? queries, which carry no settling
+ * delay. When a step fails no further steps are started, running steps
+ * finish, and (with disableOnAbort) all outputs used by the sequence are
+ * switched off.
+ *
+ * Example usage:
+ * @code
+ * PowerSequencer sequencer({psu1.get(), psu2.get(), psu3.get()});
+ * SequenceTrace trace = sequencer.run(up);
+ * for (const auto& s : trace.steps) {
+ *     std::cout << s.name << " " << stepOutcomeName(s.outcome) << " +"
+ *               << s.lateness_ms << " ms" << std::endl;
+ * }
+ * @endcode
+ */
+class PowerSequencer {
+public:
+    /**
+     * @brief Construct a sequencer
+     * @param supplies Connected supplies (not owned)
+     * @param config Sequencer settings
+     * @throws G30Exception if the list is empty or contains null
+     */
+    explicit PowerSequencer(const std::vector<TDKLambdaG30*>& supplies,
+                            const SequencerConfig& config = SequencerConfig());
+
+    /**
+     * @brief Run a sequence to completion or abort
+     * @param sequence Sequence to run
+     * @return Timing trace (check completed)
+     * @throws G30Exception if the sequence is invalid or names an unknown device
+     */
+    SequenceTrace run(const PowerSequence& sequence);
+
+private:
+    std::vector<TDKLambdaG30*> supplies_;
+    SequencerConfig config_;
+
+    void runStep(const SequenceStep& step, StepTrace& trace,
+                 std::chrono::steady_clock::time_point t0) const;
+};
+
+} // namespace TDKLambda
+
+#endif // G30_SEQUENCER_H
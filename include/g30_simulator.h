@@ -0,0 +1,358 @@
+/**
+ * @file g30_simulator.h
+ * @brief In-process TCP simulator of a TDK Lambda G30 for tests and benchmarks
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * G30Simulator listens on a loopback TCP port and answers the SCPI subset
+ * used by the driver, so TDKLambdaG30 can be exercised through its real
+ * TCP path without hardware:
+ *
+ * @code
+ * G30Simulator sim;
+ * sim.start();
+ *
+ * G30Config config;
+ * config.ipAddress = "127.0.0.1";
+ * config.tcpPort = sim.port();
+ * TDKLambdaG30 psu(config);
+ * psu.connect();
+ * @endcode
+ *
+ * The SCPI state machine (SimulatedDevice) is independent of the transport
+ * so other front ends can host many devices.
+ *
+ * Sharing a VirtualClock between the simulator and the driver runs the
+ * driver's delays and the simulated response time in virtual time.
+ *
+ * Each device drives an electrical load model (open, resistive, constant
+ * current, parallel RC or series RL) with CV/CC crossover, a slew-limited output,
+ * measurement noise and OVP/OCP trips. The model is advanced lazily to the
+ * clock's present time when a message arrives.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_SIMULATOR_H
+#define G30_SIMULATOR_H
+
+#include "tdk_lambda_g30.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Kind of simulated load on the output
+ */
+enum class LoadType {
+    OPEN,               ///< No load
+    RESISTIVE,          ///< Resistor R
+    CONSTANT_CURRENT,   ///< Electronic load sinking a fixed current
+    RC,                 ///< Resistor R in parallel with capacitor C
+    RL                  ///< Resistor R in series with inductor L
+};
+
+/**
+ * @brief Load connected to a simulated output
+ *
+ * Example: 10 ohm with 4.7 mF of bulk capacitance
+ * @code
+ * LoadModel load = LoadModel::rc(10.0, 4.7e-3);
+ * @endcode
+ */
+struct LoadModel {
+    LoadType type;              ///< Load kind
+    double resistance_ohm;      ///< R (RESISTIVE, RC, RL)
+    double current_A;           ///< Sink current (CONSTANT_CURRENT)
+    double capacitance_F;       ///< C (RC)
+    double inductance_H;        ///< L (RL)
+
+    LoadModel()
+        : type(LoadType::OPEN),
+          resistance_ohm(0.0),
+          current_A(0.0),
+          capacitance_F(0.0),
+          inductance_H(0.0) {}
+
+    static LoadModel open();
+    static LoadModel resistive(double ohms);
+    static LoadModel constantCurrent(double amps);
+    static LoadModel rc(double ohms, double farads);
+    static LoadModel rl(double ohms, double henries);
+};
+
+/**
+ * @brief Simulator settings
+ */
+struct SimulatorConfig {
+    std::string bindAddress;        ///< Listen address
+    int port;                       ///< Listen port (0 = pick a free port)
+    int responseDelay_us;           ///< Delay before each reply (device processing time)
+    std::string identification;     ///< *IDN? response
+    double maxVoltage;              ///< Rated voltage
+    double maxCurrent;              ///< Rated current
+    int setupSlots;                 ///< *SAV/*RCL slots
+    IClock* clock;                  ///< Time source of the response delay and load model (nullptr = system clock, not owned)
+
+    // Electrical model
+    LoadModel load;                 ///< Load at power-on
+    double slewRate_V_per_s;        ///< Output voltage slew limit (0 = instantaneous)
+    double voltageNoise_V;          ///< RMS noise of MEAS:VOLT? (0 = exact)
+    double currentNoise_A;          ///< RMS noise of MEAS:CURR? (0 = exact)
+    bool overCurrentProtection;     ///< OCP at power-on: constant-current operation trips the output
+    int solverStep_us;              ///< Fixed step of the load model solver
+    uint64_t noiseSeed;             ///< Seed of the measurement noise
+
+    SimulatorConfig()
+        : bindAddress("127.0.0.1"),
+          port(0),
+          responseDelay_us(0),
+          identification("TDK-LAMBDA,G30-30-56,SIM000001,1.0"),
+          maxVoltage(30.0),
+          maxCurrent(56.0),
+          setupSlots(4),
+          clock(nullptr),
+          slewRate_V_per_s(0.0),
+          voltageNoise_V(0.0),
+          currentNoise_A(0.0),
+          overCurrentProtection(false),
+          solverStep_us(50),
+          noiseSeed(1) {}
+};
+
+/**
+ * @brief Programmed and reported state of a simulated supply
+ */
+struct SimulatedState {
+    double voltage;                 ///< Voltage setpoint
+    double current;                 ///< Current limit
+    double overVoltageProtection;   ///< OVP level
+    bool outputEnabled;             ///< Output state
+    bool overCurrentProtection;     ///< OCP enabled (CURR:PROT:STAT)
+    uint32_t questionable;          ///< STAT:QUES? register
+
+    SimulatedState()
+        : voltage(0.0),
+          current(0.0),
+          overVoltageProtection(33.0),
+          outputEnabled(false),
+          overCurrentProtection(false),
+          questionable(0) {}
+};
+
+/**
+ * @brief Electrical output of a simulated supply (noise-free)
+ */
+struct SimulatedOutput {
+    double voltage;                 ///< Terminal voltage
+    double current;                 ///< Output current
+    bool constantCurrent;           ///< Regulating current (CC) rather than voltage (CV)
+
+    SimulatedOutput()
+        : voltage(0.0),
+          current(0.0),
+          constantCurrent(false) {}
+};
+
+/**
+ * @brief SCPI state machine and load model of one simulated supply (not thread-safe)
+ *
+ * The load model is a fixed-step solver: every step first slews the
+ * internal reference toward the setpoint, then solves the load against a
+ * CV source with a current limit. The first-order RC and RL dynamics are
+ * integrated with their exact exponential solution, so the solver is
+ * stable for any step. Once nothing changes any more the remaining steps
+ * are skipped, so an idle device costs nothing however long it idles.
+ */
+class SimulatedDevice {
+public:
+    /**
+     * @brief Construct a device
+     * @param config Settings; must outlive the device
+     * @throws G30Exception on an invalid load or solver step
+     */
+    explicit SimulatedDevice(const SimulatorConfig& config = SimulatorConfig());
+
+    /**
+     * @brief Process one received line
+     *
+     * The load model is first advanced to the present time of the clock.
+     * Compound messages separated by ';' are executed in order; the answers
+     * of their queries are joined with ';' into one reply line.
+     *
+     * @param line Line without terminator
+     * @param reply Reply line including '\n' is appended (nothing for pure commands)
+     */
+    void process(const std::string& line, std::string& reply);
+
+    /**
+     * @brief Return to power-on defaults (*RST)
+     */
+    void reset();
+
+    const SimulatedState& state() const { return state_; }
+    SimulatedState& state() { return state_; }
+
+    /**
+     * @brief Advance the load model to a time point
+     *
+     * Protection trips found on the way switch the output off and set
+     * their STAT:QUES? bit.
+     *
+     * @param now Time of the configured clock; earlier times are ignored
+     */
+    void update(IClock::TimePoint now);
+
+    /**
+     * @brief Replace the load (takes effect from the last update on)
+     * @param load New load
+     * @throws G30Exception on non-positive R, C, L or negative current
+     */
+    void setLoad(const LoadModel& load);
+
+    const LoadModel& load() const { return load_; }
+
+    /**
+     * @brief Electrical output as of the last update
+     */
+    SimulatedOutput output() const;
+
+    /**
+     * @brief Number of SCPI messages executed
+     */
+    uint64_t messageCount() const { return messages_; }
+
+    /**
+     * @brief Give the device its own serial number
+     *
+     * A non-zero serial replaces the third field of the *IDN? response with
+     * "SIM" and the zero-padded number, so devices sharing one
+     * SimulatorConfig still identify themselves uniquely.
+     *
+     * @param serial Serial number (0 = use SimulatorConfig::identification as is)
+     */
+    void setSerialNumber(uint32_t serial) { serial_ = serial; }
+
+    /**
+     * @brief Restart the measurement noise from another seed
+     * @param seed Seed (devices sharing a config otherwise draw the same noise)
+     */
+    void setNoiseSeed(uint64_t seed);
+
+private:
+    const SimulatorConfig* config_;
+    SimulatedState state_;
+    std::vector<SimulatedState> slots_;     ///< Allocated by the first *SAV
+    std::vector<std::string> errors_;       ///< Allocated by the first error
+    uint64_t messages_;
+    uint32_t serial_;
+
+    // Load model
+    LoadModel load_;
+    IClock::TimePoint updated_;     ///< Time the model was advanced to
+    bool started_;
+    bool settled_;                  ///< Last step changed nothing
+    bool constantCurrent_;
+    double reference_;              ///< Slew-limited internal reference (V)
+    double outputVoltage_;
+    double outputCurrent_;
+    double loadState_;              ///< Capacitor voltage (RC) or inductor current (RL)
+    double stepDecay_;              ///< exp(-step / tau) of the load
+    double carry_;                  ///< Elapsed time short of a whole step (s)
+    uint64_t noise_;                ///< xorshift64 state
+
+    IClock& clock() const { return config_->clock ? *config_->clock : SystemClock::instance(); }
+    std::string execute(const std::string& message);
+    bool setValue(const std::string& argument, double limit, double& target);
+    void pushError(const char* error);
+    void step(double dt);
+    double measurement(double value, double rms);
+};
+
+/**
+ * @brief Loopback TCP server hosting one SimulatedDevice
+ *
+ * Any number of connections share the device. All clients are served by
+ * one thread; responseDelay_us therefore also delays other clients, like
+ * the real instrument's single command parser.
+ */
+class G30Simulator {
+public:
+    explicit G30Simulator(const SimulatorConfig& config = SimulatorConfig());
+
+    /**
+     * @brief Destructor - stops the server
+     */
+    ~G30Simulator();
+
+    G30Simulator(const G30Simulator&) = delete;
+    G30Simulator& operator=(const G30Simulator&) = delete;
+
+    /**
+     * @brief Bind the listen socket and start serving
+     * @throws G30Exception if the socket cannot be bound
+     */
+    void start();
+
+    /**
+     * @brief Stop serving and close all connections
+     */
+    void stop();
+
+    /**
+     * @brief Bound port (valid after start())
+     */
+    int port() const { return port_; }
+
+    /**
+     * @brief Copy of the current device state (thread-safe)
+     */
+    SimulatedState state() const;
+
+    /**
+     * @brief Electrical output at the present time (thread-safe)
+     */
+    SimulatedOutput output() const;
+
+    /**
+     * @brief Replace the load, e.g. for a load step (thread-safe)
+     * @param load New load
+     * @throws G30Exception on an invalid load
+     */
+    void setLoad(const LoadModel& load);
+
+    /**
+     * @brief Set bits in the questionable status register (thread-safe)
+     * @param bits Bits to set, e.g. TelemetryStatusBits
+     */
+    void raiseStatus(uint32_t bits);
+
+    /**
+     * @brief Number of SCPI messages executed (thread-safe)
+     */
+    uint64_t messageCount() const;
+
+private:
+    SimulatorConfig config_;
+    mutable std::mutex deviceMutex_;
+    mutable SimulatedDevice device_;
+
+    int listenFd_;
+    int wakeFd_;
+    int port_;
+    std::atomic<bool> running_;
+    std::thread server_;
+
+    IClock& clock() const { return config_.clock ? *config_.clock : SystemClock::instance(); }
+    void serve();
+};
+
+} // namespace TDKLambda
+
+#endif // G30_SIMULATOR_H
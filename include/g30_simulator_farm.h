@@ -0,0 +1,302 @@
+/**
+ * @file g30_simulator_farm.h
+ * @brief Thousands of simulated G30 endpoints served by one epoll thread
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * SimulatorFarm hosts many independent SimulatedDevices in one process,
+ * each listening on its own loopback port (or its own loopback address),
+ * so fleet-level code can be load-tested against 1000+ supplies on a
+ * laptop:
+ *
+ * @code
+ * SimulatorFarmConfig farmConfig;
+ * farmConfig.devices = 2000;
+ * farmConfig.latency = {LatencyProfile::lan(), LatencyProfile::congested()};
+ * SimulatorFarm farm(farmConfig);
+ * farm.start();
+ *
+ * std::vector<std::unique_ptr<TDKLambdaG30>> fleet;
+ * for (size_t i = 0; i < farm.size(); ++i) {
+ *     fleet.emplace_back(new TDKLambdaG30(farm.endpointConfig(i)));
+ *     fleet.back()->connect();
+ * }
+ * @endcode
+ *
+ * A single thread serves every listen socket and connection through epoll.
+ * Replies are delayed by a per-device latency profile on a timer queue, so
+ * a slow device never stalls the others. A device costs about 250 bytes
+ * plus its listen socket; buffers exist only per open connection.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_SIMULATOR_FARM_H
+#define G30_SIMULATOR_FARM_H
+
+#include "g30_simulator.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Response time distribution of a simulated device
+ *
+ * Each reply is delayed by base_us plus a uniform 0..jitter_us, plus
+ * spike_us with probability spikeProbability. A device parses one
+ * message at a time, as the instrument does, so replies queue behind
+ * a slow one.
+ */
+struct LatencyProfile {
+    int base_us;                ///< Fixed processing time
+    int jitter_us;              ///< Uniformly distributed extra delay
+    double spikeProbability;    ///< Chance of a slow reply
+    int spike_us;               ///< Extra delay of a slow reply
+    double dropProbability;     ///< Chance that a query is never answered
+
+    LatencyProfile()
+        : base_us(0),
+          jitter_us(0),
+          spikeProbability(0.0),
+          spike_us(0),
+          dropProbability(0.0) {}
+
+    /**
+     * @brief Constant delay
+     */
+    static LatencyProfile fixed(int us);
+
+    /**
+     * @brief Healthy instrument on a local network (0.3-0.5 ms)
+     */
+    static LatencyProfile lan();
+
+    /**
+     * @brief Busy network: 2-5 ms with 1% of 50 ms stalls
+     */
+    static LatencyProfile congested();
+
+    /**
+     * @brief Unreliable device: LAN timing, 1% of 200 ms stalls, 0.5% lost replies
+     */
+    static LatencyProfile flaky();
+};
+
+/**
+ * @brief Farm settings
+ */
+struct SimulatorFarmConfig {
+    size_t devices;                         ///< Number of simulated supplies
+    SimulatorConfig device;                 ///< Settings of every device (bindAddress, port and responseDelay_us unused)
+    std::string bindAddress;                ///< Address of device 0
+    int basePort;                           ///< Port of device 0 (0 = a free port per device)
+    bool distinctAddresses;                 ///< Device i listens on bindAddress + i, all on basePort
+    std::vector<LatencyProfile> latency;    ///< Device i uses latency[i % size] (empty = immediate replies)
+    bool uniqueSerials;                     ///< Device i reports serial SIM<i + 1> in *IDN?
+    uint64_t seed;                          ///< Seed of the latency and drop draws
+
+    SimulatorFarmConfig()
+        : devices(1000),
+          bindAddress("127.0.0.1"),
+          basePort(0),
+          distinctAddresses(false),
+          uniqueSerials(true),
+          seed(1) {}
+};
+
+/**
+ * @brief Farm counters
+ */
+struct SimulatorFarmStats {
+    uint64_t messages;          ///< SCPI lines processed
+    uint64_t replies;           ///< Replies sent
+    uint64_t dropped;           ///< Replies withheld by dropProbability
+    uint64_t accepted;          ///< Connections accepted
+    size_t connections;         ///< Connections open now
+    size_t pending;             ///< Replies waiting for their latency to pass
+
+    SimulatorFarmStats()
+        : messages(0),
+          replies(0),
+          dropped(0),
+          accepted(0),
+          connections(0),
+          pending(0) {}
+};
+
+/**
+ * @brief Many simulated supplies behind one epoll loop
+ *
+ * Latency is measured in real time even when SimulatorFarmConfig::device
+ * has a clock; the load models follow that clock. Accessors are
+ * thread-safe.
+ */
+class SimulatorFarm {
+public:
+    /**
+     * @brief Construct the devices (no sockets yet)
+     * @param config Farm settings
+     * @throws G30Exception on invalid settings
+     */
+    explicit SimulatorFarm(const SimulatorFarmConfig& config = SimulatorFarmConfig());
+
+    /**
+     * @brief Destructor - stops the farm
+     */
+    ~SimulatorFarm();
+
+    SimulatorFarm(const SimulatorFarm&) = delete;
+    SimulatorFarm& operator=(const SimulatorFarm&) = delete;
+
+    /**
+     * @brief Bind every endpoint and start serving
+     *
+     * Raises the soft open-file limit up to the hard limit if one
+     * descriptor per device would not fit.
+     *
+     * @throws G30Exception if the descriptors do not fit or an endpoint cannot be bound
+     */
+    void start();
+
+    /**
+     * @brief Stop serving and close all sockets (device state is kept)
+     */
+    void stop();
+
+    /**
+     * @brief Number of devices
+     */
+    size_t size() const { return devices_.size(); }
+
+    /**
+     * @brief Listen address of a device
+     */
+    std::string address(size_t device) const;
+
+    /**
+     * @brief Listen port of a device (valid after start())
+     */
+    int port(size_t device) const;
+
+    /**
+     * @brief Driver configuration pointing at a device (valid after start())
+     * @param device Device index
+     * @param base Settings to copy (ipAddress and tcpPort are overwritten)
+     */
+    G30Config endpointConfig(size_t device, const G30Config& base = G30Config()) const;
+
+    /**
+     * @brief Copy of a device's state
+     */
+    SimulatedState state(size_t device) const;
+
+    /**
+     * @brief Electrical output of a device at the present time
+     */
+    SimulatedOutput output(size_t device) const;
+
+    /**
+     * @brief Replace the load of a device
+     * @throws G30Exception on an invalid load
+     */
+    void setLoad(size_t device, const LoadModel& load);
+
+    /**
+     * @brief Set bits in a device's questionable status register
+     */
+    void raiseStatus(size_t device, uint32_t bits);
+
+    /**
+     * @brief Switch a device to another latency profile
+     * @param device Device index
+     * @param profile Index into SimulatorFarmConfig::latency
+     */
+    void setLatencyProfile(size_t device, size_t profile);
+
+    /**
+     * @brief Get the counters
+     */
+    SimulatorFarmStats stats() const;
+
+private:
+    struct Endpoint {
+        SimulatedDevice device;
+        int listenFd;
+        uint16_t port;
+        uint16_t profile;
+        int64_t busyUntil_ns;       ///< When the device's parser is free again (loop thread only)
+
+        explicit Endpoint(const SimulatorConfig& config)
+            : device(config), listenFd(-1), port(0), profile(0), busyUntil_ns(0) {}
+    };
+
+    struct Connection {
+        uint32_t device;
+        uint32_t generation;        ///< Tells a reused descriptor from the connection a reply was for
+        bool open;
+        std::string rx;
+        std::string tx;
+
+        Connection() : device(0), generation(0), open(false) {}
+    };
+
+    struct PendingReply {
+        int64_t due_ns;
+        uint64_t sequence;          ///< Keeps replies due at the same time in order
+        int fd;
+        uint32_t generation;
+        std::string text;
+    };
+
+    struct LaterFirst {
+        bool operator()(const PendingReply& a, const PendingReply& b) const {
+            return a.due_ns != b.due_ns ? a.due_ns > b.due_ns : a.sequence > b.sequence;
+        }
+    };
+
+    SimulatorFarmConfig config_;
+    mutable std::mutex mutex_;              ///< Guards the devices
+    mutable std::vector<Endpoint> devices_;
+    std::vector<Connection> connections_;   ///< Indexed by socket descriptor (loop thread only)
+    std::priority_queue<PendingReply, std::vector<PendingReply>, LaterFirst> pending_;
+    uint64_t random_;                       ///< xorshift64 state (loop thread only)
+    uint64_t sequence_;
+    int64_t armed_ns_;                      ///< Expiry the timer is set to (0 = disarmed)
+
+    int epollFd_;
+    int wakeFd_;
+    int timerFd_;
+    std::atomic<bool> running_;
+    std::thread server_;
+
+    std::atomic<uint64_t> messages_;
+    std::atomic<uint64_t> replies_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> accepted_;
+    std::atomic<size_t> open_;
+    std::atomic<size_t> queued_;
+
+    IClock& clock() const { return config_.device.clock ? *config_.device.clock : SystemClock::instance(); }
+    void closeAll();
+    void serve();
+    void acceptConnections(size_t device);
+    void receive(int fd);
+    void transmit(int fd, const char* data, size_t length);
+    void flush(int fd);
+    void closeConnection(int fd);
+    void dispatchDue(int64_t now_ns);
+    void armTimer();
+    int64_t latency_ns(const LatencyProfile& profile, bool& drop);
+    double uniform();
+};
+
+} // namespace TDKLambda
+
+#endif // G30_SIMULATOR_FARM_H
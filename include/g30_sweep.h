@@ -0,0 +1,250 @@
+/**
+ * @file g30_sweep.h
+ * @brief Automated V/I characterization sweeps over one or more G30 units
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * Plans linear, logarithmic or adaptively refined voltage/current point
+ * sets, runs them on many supplies in parallel and streams the results
+ * into a columnar table. Per device, the measurement queries of one point
+ * are pipelined together with the setpoints of the next point, so the
+ * sweep rate is bounded by the configured settling time rather than by
+ * per-command library overhead.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_SWEEP_H
+#define G30_SWEEP_H
+
+#include "tdk_lambda_g30.h"
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Point spacing along a sweep axis
+ */
+enum class SweepSpacing {
+    LINEAR,         ///< Evenly spaced points
+    LOGARITHMIC     ///< Points evenly spaced in log10 (start and stop must be > 0)
+};
+
+/**
+ * @brief One axis (voltage or current) of a sweep grid
+ */
+struct SweepAxis {
+    double start;           ///< First value
+    double stop;            ///< Last value
+    int points;             ///< Number of points including both ends
+    SweepSpacing spacing;   ///< Point spacing
+
+    SweepAxis()
+        : start(0),
+          stop(0),
+          points(1),
+          spacing(SweepSpacing::LINEAR) {}
+
+    SweepAxis(double startValue, double stopValue, int pointCount,
+              SweepSpacing pointSpacing = SweepSpacing::LINEAR)
+        : start(startValue),
+          stop(stopValue),
+          points(pointCount),
+          spacing(pointSpacing) {}
+
+    /**
+     * @brief Expand the axis into its values
+     * @return Axis values in sweep order
+     * @throws G30Exception on invalid axis definition
+     */
+    std::vector<double> values() const;
+};
+
+/**
+ * @brief A single sweep point (voltage setpoint, current limit)
+ */
+struct SweepPoint {
+    double voltage;     ///< Voltage setpoint in volts
+    double current;     ///< Current limit in amperes
+
+    SweepPoint()
+        : voltage(0),
+          current(0) {}
+
+    SweepPoint(double v, double i)
+        : voltage(v),
+          current(i) {}
+};
+
+/**
+ * @brief Adaptive refinement settings
+ *
+ * After the planned points have been measured, a midpoint is inserted
+ * between neighbouring points whose measured voltage or current differs by
+ * more than the given thresholds. Refinement repeats up to maxDepth times.
+ */
+struct AdaptiveRefinement {
+    bool enabled;           ///< Enable adaptive refinement
+    double maxVoltageStep;  ///< Largest accepted measured voltage change between neighbours (V)
+    double maxCurrentStep;  ///< Largest accepted measured current change between neighbours (A)
+    int maxDepth;           ///< Maximum refinement passes
+
+    AdaptiveRefinement()
+        : enabled(false),
+          maxVoltageStep(0.5),
+          maxCurrentStep(0.5),
+          maxDepth(3) {}
+};
+
+/**
+ * @brief Ordered set of points to visit
+ */
+class SweepPlan {
+public:
+    SweepPlan() = default;
+
+    /**
+     * @brief Cartesian grid, voltage varying fastest
+     * @param voltage Voltage axis
+     * @param current Current axis
+     * @return Plan visiting every (voltage, current) pair
+     */
+    static SweepPlan grid(const SweepAxis& voltage, const SweepAxis& current);
+
+    /**
+     * @brief Plan from an explicit point list
+     * @param points Points in visiting order
+     * @return Plan
+     */
+    static SweepPlan fromPoints(const std::vector<SweepPoint>& points);
+
+    /**
+     * @brief Enable adaptive refinement for this plan
+     * @param refinement Refinement settings
+     * @return Reference to this plan
+     */
+    SweepPlan& refine(const AdaptiveRefinement& refinement);
+
+    const std::vector<SweepPoint>& points() const { return points_; }
+    const AdaptiveRefinement& refinement() const { return refinement_; }
+    size_t size() const { return points_.size(); }
+
+private:
+    std::vector<SweepPoint> points_;
+    AdaptiveRefinement refinement_;
+};
+
+/**
+ * @brief One measured sweep row
+ */
+struct SweepRow {
+    size_t device;          ///< Index of the supply in the engine
+    double setVoltage;      ///< Commanded voltage (V)
+    double setCurrent;      ///< Commanded current limit (A)
+    double measVoltage;     ///< Measured voltage (V)
+    double measCurrent;     ///< Measured current (A)
+    double time_ms;         ///< Measurement time since sweep start
+};
+
+/**
+ * @brief Columnar result table
+ *
+ * Each column is a contiguous vector, which keeps large sweeps compact and
+ * lets results be handed to analysis code without reshaping. Appending is
+ * thread-safe; reading is intended after the sweep has finished.
+ */
+class SweepTable {
+public:
+    SweepTable() = default;
+    SweepTable(SweepTable&& other) noexcept;
+    SweepTable& operator=(SweepTable&& other) noexcept;
+
+    /**
+     * @brief Append one row
+     * @param row Row to append
+     */
+    void append(const SweepRow& row);
+
+    /**
+     * @brief Reserve space for a number of rows
+     * @param rows Expected row count
+     */
+    void reserve(size_t rows);
+
+    size_t size() const { return device.size(); }
+
+    std::vector<size_t> device;
+    std::vector<double> setVoltage;
+    std::vector<double> setCurrent;
+    std::vector<double> measVoltage;
+    std::vector<double> measCurrent;
+    std::vector<double> time_ms;
+
+private:
+    std::mutex mutex_;
+};
+
+/**
+ * @brief Sweep execution settings
+ */
+struct SweepConfig {
+    int settle_ms;          ///< Wait between applying a point and measuring it
+    bool enableOutput;      ///< Switch outputs on before and off after the sweep (also when it fails)
+
+    SweepConfig()
+        : settle_ms(20),
+          enableOutput(true) {}
+};
+
+/**
+ * @brief Runs sweep plans on several supplies in parallel
+ *
+ * Example usage:
+ * @code
+ * SweepEngine engine({psu1.get(), psu2.get()});
+ * SweepPlan plan = SweepPlan::grid(SweepAxis(0.0, 12.0, 25), SweepAxis(1.0, 1.0, 1));
+ * SweepTable table = engine.run(plan);
+ * @endcode
+ */
+class SweepEngine {
+public:
+    /**
+     * @brief Construct an engine over a set of supplies
+     * @param supplies Connected supplies (not owned)
+     * @param config Sweep settings
+     * @throws G30Exception if the supply list is empty or contains null
+     */
+    explicit SweepEngine(const std::vector<TDKLambdaG30*>& supplies,
+                         const SweepConfig& config = SweepConfig());
+
+    /**
+     * @brief Set a callback invoked for every measured row as it arrives
+     * @param callback Row callback (called from device worker threads)
+     */
+    void setRowCallback(std::function<void(const SweepRow&)> callback);
+
+    /**
+     * @brief Run a plan on every supply in parallel
+     * @param plan Points to visit
+     * @return Columnar results of all devices
+     * @throws G30Exception on invalid points or if any supply fails
+     */
+    SweepTable run(const SweepPlan& plan);
+
+private:
+    std::vector<TDKLambdaG30*> supplies_;
+    SweepConfig config_;
+    std::function<void(const SweepRow&)> rowCallback_;
+
+    std::vector<SweepRow> runDevice(size_t index, const std::vector<SweepPoint>& points,
+                                    SweepTable& table,
+                                    std::chrono::steady_clock::time_point t0) const;
+};
+
+} // namespace TDKLambda
+
+#endif // G30_SWEEP_H
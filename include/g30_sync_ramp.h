@@ -0,0 +1,119 @@
+/**
+ * @file g30_sync_ramp.h
+ * @brief Lock-step synchronized voltage ramps across multiple G30 units
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * Drives several TDKLambdaG30 instances along a shared timebase so that
+ * multi-rail DUTs are ramped together. One worker per supply sends each
+ * step's setpoint as a single batched write when the step is due and reads
+ * the output back with one pipelined query; the cross-device skew,
+ * lateness and tracking error of each step are reported.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_SYNC_RAMP_H
+#define G30_SYNC_RAMP_H
+
+#include "tdk_lambda_g30.h"
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief Settings for a synchronized ramp
+ */
+struct SyncRampConfig {
+    int stepInterval_ms;        ///< Period of the shared timebase in milliseconds
+    bool measureTracking;       ///< Read back output voltage after every step
+
+    SyncRampConfig()
+        : stepInterval_ms(100),
+          measureTracking(true) {}
+};
+
+/**
+ * @brief Timing and tracking figures of a single ramp step
+ */
+struct SyncRampStep {
+    int index;                          ///< Step number (0-based)
+    std::vector<double> setpoints;      ///< Commanded voltage per device
+    std::vector<double> measured;       ///< Measured voltage per device (empty if not measured)
+    double skew_ms;                     ///< Spread of setpoint dispatch times across devices
+    double lateness_ms;                 ///< Last dispatch after the step's due time (overrun of the step before)
+    double trackingError;               ///< Largest |measured - setpoint| across devices in volts
+
+    SyncRampStep()
+        : index(0),
+          skew_ms(0),
+          lateness_ms(0),
+          trackingError(0) {}
+};
+
+/**
+ * @brief Result of a synchronized ramp
+ */
+struct SyncRampResult {
+    std::vector<SyncRampStep> steps;    ///< Per-step report
+    double maxSkew_ms;                  ///< Worst skew over all steps
+    double maxLateness_ms;              ///< Worst lateness over all steps
+    double maxTrackingError;            ///< Worst tracking error over all steps in volts
+    double duration_ms;                 ///< Total ramp duration
+
+    SyncRampResult()
+        : maxSkew_ms(0),
+          maxLateness_ms(0),
+          maxTrackingError(0),
+          duration_ms(0) {}
+};
+
+/**
+ * @brief Ramps several supplies in lock-step on a shared timebase
+ *
+ * All supplies start from their present setpoint and reach their targets
+ * at the same time. The number of steps is chosen so that the fastest
+ * moving rail does not exceed the requested ramp rate.
+ *
+ * Example usage:
+ * @code
+ * SynchronizedRamp ramp({psu1.get(), psu2.get()});
+ * SyncRampResult r = ramp.rampVoltage({12.0, 5.0}, 2.0);
+ * std::cout << "Max skew: " << r.maxSkew_ms << " ms" << std::endl;
+ * @endcode
+ */
+class SynchronizedRamp {
+public:
+    /**
+     * @brief Construct a synchronized ramp over a set of supplies
+     * @param supplies Connected supplies (not owned)
+     * @param config Ramp settings
+     * @throws G30Exception if the supply list is empty or contains null
+     */
+    explicit SynchronizedRamp(const std::vector<TDKLambdaG30*>& supplies,
+                              const SyncRampConfig& config = SyncRampConfig());
+
+    /**
+     * @brief Ramp all supplies to their target voltages together
+     * @param targets Target voltage per supply (same order as constructor)
+     * @param rampRate Maximum ramp rate of any rail in V/s
+     * @return Per-step skew and tracking report
+     * @throws G30Exception on invalid arguments or if any supply fails
+     */
+    SyncRampResult rampVoltage(const std::vector<double>& targets, double rampRate);
+
+    /**
+     * @brief Get number of supplies driven by this ramp
+     * @return Supply count
+     */
+    size_t size() const { return supplies_.size(); }
+
+private:
+    std::vector<TDKLambdaG30*> supplies_;
+    SyncRampConfig config_;
+};
+
+} // namespace TDKLambda
+
+#endif // G30_SYNC_RAMP_H
@@ -0,0 +1,181 @@
+/**
+ * @file g30_telemetry.h
+ * @brief Periodic telemetry sampling of one or more G30 units
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * A TelemetrySampler polls voltage, current, questionable status and
+ * output state of every supply on its own thread, using one pipelined
+ * round trip per sample, and hands each sample to the registered sinks.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_TELEMETRY_H
+#define G30_TELEMETRY_H
+
+#include "tdk_lambda_g30.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace TDKLambda {
+
+/**
+ * @brief STAT:QUES? bits decoded by the driver
+ */
+enum TelemetryStatusBits : uint32_t {
+    STATUS_OVP = 0x01,          ///< Over-voltage protection tripped
+    STATUS_OCP = 0x02,          ///< Over-current protection tripped
+    STATUS_OTP = 0x10           ///< Over-temperature
+};
+
+/**
+ * @brief One telemetry reading of one supply
+ */
+struct TelemetrySample {
+    uint32_t device;            ///< Index of the supply in the sampler
+    uint64_t sequence;          ///< Per-device sample counter
+    int64_t timestamp_ns;       ///< steady_clock time of the reading
+    double voltage;             ///< Measured voltage (V)
+    double current;             ///< Measured current (A)
+    double power;               ///< voltage * current (W)
+    uint32_t status;            ///< Raw STAT:QUES? value
+    bool outputEnabled;         ///< Output state
+    bool valid;                 ///< false if the reading failed
+
+    TelemetrySample()
+        : device(0),
+          sequence(0),
+          timestamp_ns(0),
+          voltage(0),
+          current(0),
+          power(0),
+          status(0),
+          outputEnabled(false),
+          valid(false) {}
+};
+
+/**
+ * @brief Consumer of telemetry samples
+ *
+ * onSample() is called from the sampler's device threads, possibly
+ * concurrently for different devices, and must not block for long.
+ */
+class ITelemetrySink {
+public:
+    virtual ~ITelemetrySink() = default;
+
+    /**
+     * @brief Receive one sample
+     * @param sample Sample data
+     */
+    virtual void onSample(const TelemetrySample& sample) = 0;
+};
+
+/**
+ * @brief Sampler settings
+ */
+struct TelemetryConfig {
+    int period_ms;              ///< Sampling period per device
+    bool readStatus;            ///< Include STAT:QUES? and OUTP? in every sample
+
+    TelemetryConfig()
+        : period_ms(100),
+          readStatus(true) {}
+};
+
+/**
+ * @brief Polls a set of supplies and fans samples out to sinks
+ *
+ * Example usage:
+ * @code
+ * TelemetrySampler sampler({psu1.get(), psu2.get()});
+ * sampler.addSink(std::make_shared<MySink>());
+ * sampler.start();
+ * ...
+ * sampler.stop();
+ * @endcode
+ */
+class TelemetrySampler {
+public:
+    /**
+     * @brief Construct a sampler
+     * @param supplies Connected supplies (not owned)
+     * @param config Sampler settings
+     * @throws G30Exception if the supply list is empty or contains null
+     */
+    explicit TelemetrySampler(const std::vector<TDKLambdaG30*>& supplies,
+                              const TelemetryConfig& config = TelemetryConfig());
+
+    /**
+     * @brief Destructor - stops sampling
+     */
+    ~TelemetrySampler();
+
+    TelemetrySampler(const TelemetrySampler&) = delete;
+    TelemetrySampler& operator=(const TelemetrySampler&) = delete;
+
+    /**
+     * @brief Register a sink (only while stopped)
+     * @param sink Sample consumer
+     * @throws G30Exception if the sampler is running
+     */
+    void addSink(std::shared_ptr<ITelemetrySink> sink);
+
+    /**
+     * @brief Start one sampling thread per supply
+     */
+    void start();
+
+    /**
+     * @brief Stop sampling and join the threads
+     */
+    void stop();
+
+    /**
+     * @brief Check if sampling is active
+     * @return true if running
+     */
+    bool isRunning() const { return running_.load(); }
+
+    /**
+     * @brief Get the most recent sample of a device
+     * @param device Supply index
+     * @return Latest sample (valid == false before the first reading)
+     */
+    TelemetrySample latest(size_t device) const;
+
+    /**
+     * @brief Get number of sampled supplies
+     * @return Supply count
+     */
+    size_t size() const { return supplies_.size(); }
+
+    /**
+     * @brief Get number of failed readings since construction
+     * @return Error count
+     */
+    uint64_t errorCount() const { return errors_.load(); }
+
+private:
+    std::vector<TDKLambdaG30*> supplies_;
+    TelemetryConfig config_;
+    std::vector<std::shared_ptr<ITelemetrySink>> sinks_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_;
+    std::atomic<uint64_t> errors_;
+
+    mutable std::mutex latestMutex_;
+    std::vector<TelemetrySample> latest_;
+
+    void sampleLoop(size_t device);
+};
+
+} // namespace TDKLambda
+
+#endif // G30_TELEMETRY_H
@@ -0,0 +1,190 @@
+/**
+ * @file g30_telemetry_shm.h
+ * @brief Shared-memory publication of live telemetry for local processes
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * TelemetryShmPublisher is a telemetry sink that writes the latest sample
+ * of every device into a POSIX shared-memory segment. Each device owns one
+ * cache-line sized slot protected by a sequence lock, so any number of
+ * TelemetryShmReader instances in other processes can read consistent
+ * snapshots lock-free and without a system call per read.
+ *
+ * @author Professional Power Supply Control Library
+ * @copyright MIT License
+ */
+
+#ifndef G30_TELEMETRY_SHM_H
+#define G30_TELEMETRY_SHM_H
+
+#include "g30_telemetry.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace TDKLambda {
+
+/**
+ * @brief Shared-memory layout (version 1)
+ *
+ * Fields are stored as 64-bit atomics so concurrent reads are well defined;
+ * doubles are kept as their bit patterns.
+ */
+namespace TelemetryShm {
+
+constexpr uint32_t kMagic = 0x47333054;     ///< "G30T"
+constexpr uint32_t kVersion = 1;
+constexpr int kMaxReadRetries = 1000;       ///< Reads of a slot stuck mid-update before giving up
+
+/**
+ * @brief Segment header
+ */
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+    std::atomic<uint64_t> publishCount;     ///< Total samples published
+    uint32_t publisherPid;                  ///< Process owning the segment
+    uint8_t reserved[36];
+};
+
+/**
+ * @brief One device slot (one cache line)
+ *
+ * The writer makes seq odd, stores the words and makes seq even again.
+ * A reader retries while seq is odd or changed during its copy, up to
+ * kMaxReadRetries times.
+ */
+struct Slot {
+    std::atomic<uint32_t> seq;
+    uint32_t device;
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> timestamp_ns;
+    std::atomic<uint64_t> voltageBits;
+    std::atomic<uint64_t> currentBits;
+    std::atomic<uint64_t> powerBits;
+    std::atomic<uint64_t> statusWord;       ///< status | outputEnabled << 32 | valid << 33
+    uint64_t reserved;
+};
+
+static_assert(sizeof(Header) == 64, "Telemetry shm header must be one cache line");
+static_assert(sizeof(Slot) == 64, "Telemetry shm slot must be one cache line");
+
+} // namespace TelemetryShm
+
+/**
+ * @brief Telemetry sink publishing into a shared-memory segment
+ *
+ * Example usage:
+ * @code
+ * auto shm = std::make_shared<TelemetryShmPublisher>("/g30_telemetry", sampler.size());
+ * sampler.addSink(shm);
+ * sampler.start();
+ * @endcode
+ */
+class TelemetryShmPublisher : public ITelemetrySink {
+public:
+    /**
+     * @brief Create a shared-memory segment
+     *
+     * A segment of the same name left behind by a publisher that no longer
+     * runs is replaced; one whose publisher is still alive is not touched.
+     *
+     * @param name POSIX shm name, e.g. "/g30_telemetry"
+     * @param slotCount Number of device slots
+     * @param unlinkOnClose Remove the segment name when the publisher is destroyed
+     * @throws G30Exception if the segment cannot be created or another live
+     *         process (or an unknown program) owns the name
+     */
+    TelemetryShmPublisher(const std::string& name, size_t slotCount, bool unlinkOnClose = true);
+
+    /**
+     * @brief Destructor - unmaps (and optionally unlinks) the segment
+     */
+    ~TelemetryShmPublisher() override;
+
+    TelemetryShmPublisher(const TelemetryShmPublisher&) = delete;
+    TelemetryShmPublisher& operator=(const TelemetryShmPublisher&) = delete;
+
+    /**
+     * @brief Publish a sample into its device slot
+     * @param sample Sample data (ignored if device is out of range)
+     */
+    void onSample(const TelemetrySample& sample) override;
+
+    /**
+     * @brief Get the segment name
+     * @return shm name
+     */
+    const std::string& name() const { return name_; }
+
+private:
+    std::string name_;
+    bool unlinkOnClose_;
+    size_t mappedSize_;
+    TelemetryShm::Header* header_;
+    TelemetryShm::Slot* slots_;
+};
+
+/**
+ * @brief Lock-free reader of a telemetry segment from any local process
+ *
+ * Example usage:
+ * @code
+ * TelemetryShmReader reader("/g30_telemetry");
+ * TelemetrySample s;
+ * if (reader.read(0, s) && s.valid) {
+ *     std::cout << s.voltage << " V" << std::endl;
+ * }
+ * @endcode
+ */
+class TelemetryShmReader {
+public:
+    /**
+     * @brief Map an existing segment read-only
+     * @param name POSIX shm name
+     * @throws G30Exception if the segment is missing or has an unknown layout
+     */
+    explicit TelemetryShmReader(const std::string& name);
+
+    /**
+     * @brief Destructor - unmaps the segment
+     */
+    ~TelemetryShmReader();
+
+    TelemetryShmReader(const TelemetryShmReader&) = delete;
+    TelemetryShmReader& operator=(const TelemetryShmReader&) = delete;
+
+    /**
+     * @brief Read a consistent snapshot of one device slot
+     * @param device Slot index
+     * @param sample Receives the snapshot
+     * @return false if device is out of range, nothing was published yet, or
+     *         the slot stayed mid-update for kMaxReadRetries attempts (stale;
+     *         e.g. the writer died inside an update)
+     */
+    bool read(size_t device, TelemetrySample& sample) const;
+
+    /**
+     * @brief Get number of slots in the segment
+     * @return Slot count
+     */
+    size_t slotCount() const { return slotCount_; }
+
+    /**
+     * @brief Get total number of samples published so far
+     * @return Publish counter
+     */
+    uint64_t publishCount() const;
+
+private:
+    size_t mappedSize_;
+    size_t slotCount_;
+    const TelemetryShm::Header* header_;
+    const TelemetryShm::Slot* slots_;
+};
+
+} // namespace TDKLambda
+
+#endif // G30_TELEMETRY_SHM_H
@@ -15,10 +15,14 @@
 #define TDK_LAMBDA_G30_H
 
 #include "power_supply_interface.h"
+#include "g30_clock.h"
 #include <string>
 #include <memory>
 #include <stdexcept>
 #include <functional>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <vector>
 
 namespace TDKLambda {
@@ -76,6 +80,156 @@ public:
     virtual void close() = 0;
 };
 
+/**
+ * @brief Non-owning view of a contiguous byte range
+ */
+struct ConstBuffer {
+    const char* data;
+    size_t size;
+
+    ConstBuffer() : data(nullptr), size(0) {}
+    ConstBuffer(const char* bytes, size_t length) : data(bytes), size(length) {}
+    ConstBuffer(const std::string& text) : data(text.data()), size(text.size()) {}
+};
+
+/**
+ * @brief Buffer-oriented communication interface (version 2)
+ *
+ * Writes gather caller-owned buffers into one message and reads fill
+ * caller buffers or return a view into the transport's receive buffer, so
+ * no string is allocated or copied at the interface boundary.
+ * Implementations may use LineBuffer for the receive side; existing
+ * ICommunication implementations are used through CommunicationAdapter.
+ */
+class ICommunicationV2 {
+public:
+    virtual ~ICommunicationV2() = default;
+
+    /**
+     * @brief Write the concatenation of several buffers as one message
+     *
+     * Implementations must send all bytes (looping on short writes) or throw.
+     *
+     * @param buffers Buffers to send, in order
+     * @param count Number of buffers
+     * @return Number of bytes written
+     */
+    virtual size_t write(const ConstBuffer* buffers, size_t count) = 0;
+
+    /**
+     * @brief Read available bytes into a caller buffer
+     * @param buffer Destination
+     * @param capacity Size of destination
+     * @param timeout_ms Maximum wait for the first byte
+     * @return Number of bytes read (0 on timeout)
+     */
+    virtual size_t read(char* buffer, size_t capacity, int timeout_ms) = 0;
+
+    /**
+     * @brief Read one newline-terminated line
+     *
+     * The view excludes the terminator and stays valid until the next call
+     * on this object. On timeout any partial data is consumed and returned.
+     *
+     * @param timeout_ms Timeout in milliseconds
+     * @param line Receives a view of the line
+     * @return true if a complete line was read, false on timeout
+     */
+    virtual bool readLine(int timeout_ms, ConstBuffer& line) = 0;
+
+    /**
+     * @brief Check if port is open
+     * @return true if open, false otherwise
+     */
+    virtual bool isOpen() const = 0;
+
+    /**
+     * @brief Close the port, discarding buffered input
+     */
+    virtual void close() = 0;
+};
+
+/**
+ * @brief Receive buffer with line extraction for ICommunicationV2 transports
+ *
+ * Bytes are received directly into the buffer (prepare/commit) and lines
+ * are handed out as views; consumed space is reclaimed lazily, so the
+ * buffer stops allocating once it has grown to the largest burst.
+ */
+class LineBuffer {
+public:
+    LineBuffer();
+
+    /**
+     * @brief Get space for at least bytes more bytes
+     * @param bytes Space required
+     * @return Write position; call commit() with the number of bytes stored
+     */
+    char* prepare(size_t bytes);
+
+    /**
+     * @brief Mark bytes written after prepare() as received
+     * @param bytes Number of bytes stored
+     */
+    void commit(size_t bytes);
+
+    /**
+     * @brief Take the next complete line (terminator stripped)
+     * @param line Receives a view valid until the next non-const call
+     * @return false if no complete line is buffered
+     */
+    bool nextLine(ConstBuffer& line);
+
+    /**
+     * @brief Take at most capacity buffered bytes
+     * @param buffer Destination
+     * @param capacity Size of destination
+     * @return Number of bytes copied
+     */
+    size_t take(char* buffer, size_t capacity);
+
+    /**
+     * @brief Take everything buffered (e.g. a partial line on timeout)
+     * @return View valid until the next non-const call
+     */
+    ConstBuffer takeAll();
+
+    void clear();
+    bool empty() const { return begin_ == end_; }
+
+private:
+    std::vector<char> data_;
+    size_t begin_;      ///< First unconsumed byte
+    size_t end_;        ///< One past the last received byte
+    size_t scanned_;    ///< Bytes after begin_ already known to contain no '\n'
+};
+
+/**
+ * @brief Exposes an ICommunication implementation as ICommunicationV2
+ *
+ * Writes are gathered into one reused string; the per-message copy of the
+ * version 1 interface remains, but nothing beyond it.
+ */
+class CommunicationAdapter : public ICommunicationV2 {
+public:
+    /**
+     * @brief Wrap a version 1 port
+     * @param port Port to adapt (owned)
+     */
+    explicit CommunicationAdapter(std::unique_ptr<ICommunication> port);
+
+    size_t write(const ConstBuffer* buffers, size_t count) override;
+    size_t read(char* buffer, size_t capacity, int timeout_ms) override;
+    bool readLine(int timeout_ms, ConstBuffer& line) override;
+    bool isOpen() const override;
+    void close() override;
+
+private:
+    std::unique_ptr<ICommunication> port_;
+    std::string message_;
+    LineBuffer rx_;
+};
+
 /**
  * @brief Configuration structure for TDK Lambda G30
  */
@@ -87,10 +241,121 @@ struct G30Config {
     // Common settings
     int timeout_ms;             ///< Communication timeout in milliseconds
 
+    bool resetOnConnect;        ///< Send *RST and *CLS in connect() (keeps present settings if false)
+
+    // Adaptive response timeouts (srtt + k * rttvar, as TCP's RTO)
+    bool adaptiveTimeout;       ///< Derive response timeouts from observed RTT (timeout_ms until measured)
+    int minTimeout_ms;          ///< Adaptive timeout floor
+    int maxTimeout_ms;          ///< Adaptive timeout ceiling
+    double rttVarianceFactor;   ///< k in srtt + k * rttvar
+
+    // Failure handling
+    int queryRetries;           ///< Extra attempts for idempotent queries that time out (0 = off)
+    int retryBackoff_ms;        ///< Backoff before the first retry (doubled per retry, +-50% jitter)
+    int breakerThreshold;       ///< Consecutive failed transactions that open the circuit (0 = off)
+    int breakerOpen_ms;         ///< Time an open circuit fails fast before a probe query
+    int staleDrain_ms;          ///< Longest wait for a timed-out query's late reply before the next write
+
+    // Device features
+    int setupSlots;             ///< Number of *SAV/*RCL setup memories (slots 1..setupSlots)
+
+    // Timing
+    IClock* clock;              ///< Time source of delays, ramps and the breaker (nullptr = system clock, not owned)
+
     G30Config()
         : ipAddress(""),
           tcpPort(8003),  // TDK Lambda G30 default TCP port
-          timeout_ms(1000) {}
+          timeout_ms(1000),
+          resetOnConnect(true),
+          adaptiveTimeout(false),
+          minTimeout_ms(20),
+          maxTimeout_ms(2000),
+          rttVarianceFactor(4.0),
+          queryRetries(0),
+          retryBackoff_ms(10),
+          breakerThreshold(0),
+          breakerOpen_ms(2000),
+          staleDrain_ms(20),
+          setupSlots(4),
+          clock(nullptr) {}
+};
+
+/**
+ * @brief Snapshot of the programmable device settings
+ */
+struct DeviceConfig {
+    double voltage;                 ///< Voltage setpoint in volts
+    double current;                 ///< Current limit in amperes
+    double overVoltageProtection;   ///< OVP level in volts
+    bool outputEnabled;             ///< Output state
+
+    DeviceConfig()
+        : voltage(0),
+          current(0),
+          overVoltageProtection(0),
+          outputEnabled(false) {}
+};
+
+/**
+ * @brief Quantity read by measureAveraged()
+ */
+enum class MeasureMetric {
+    VOLTAGE,        ///< MEAS:VOLT?
+    CURRENT,        ///< MEAS:CURR?
+    POWER           ///< MEAS:VOLT? * MEAS:CURR? of the same burst slot
+};
+
+/**
+ * @brief Result of an oversampled measurement
+ */
+struct AveragedMeasurement {
+    double mean;            ///< Mean of the kept samples
+    double stddev;          ///< Sample standard deviation of the kept samples
+    double median;          ///< Median of all samples
+    double min;             ///< Smallest kept sample
+    double max;             ///< Largest kept sample
+    int samples;            ///< Samples kept
+    int rejected;           ///< Samples rejected as outliers
+    double spread_ms;       ///< Time between the first and the last response
+    double duration_ms;     ///< Time from the call to the last response
+
+    AveragedMeasurement()
+        : mean(0),
+          stddev(0),
+          median(0),
+          min(0),
+          max(0),
+          samples(0),
+          rejected(0),
+          spread_ms(0),
+          duration_ms(0) {}
+};
+
+/**
+ * @brief Circuit breaker state of one device
+ */
+enum class CircuitState {
+    CLOSED,         ///< Normal operation
+    OPEN,           ///< Device failing; transactions fail fast
+    HALF_OPEN       ///< Probing whether the device recovered
+};
+
+/**
+ * @brief Round-trip time estimate of one device
+ */
+struct RttEstimate {
+    uint64_t samples;       ///< Round trips measured
+    uint64_t timeouts;      ///< Responses that timed out
+    double srtt_ms;         ///< Smoothed RTT
+    double rttvar_ms;       ///< RTT variation
+    int timeout_ms;         ///< Response timeout currently applied
+
+    RttEstimate()
+        : samples(0),
+          timeouts(0),
+          srtt_ms(0),
+          rttvar_ms(0),
+          timeout_ms(0) {}
 };
 
 /**
@@ -106,7 +371,8 @@ struct G30Config {
  * - RAII-compliant resource management
  * - Exception-based error handling
  * - Ethernet (TCP/IP) communication
- * - Thread-safe operations (when used with proper locking)
+ * - Device I/O transactions serialized internally, so one instance can be
+ *   shared by a sampler thread and application threads
  * - Full SCPI command support
  * - Generic PowerSupply interface compliance
  *
@@ -137,6 +403,13 @@ public:
      */
     TDKLambdaG30(std::unique_ptr<ICommunication> commPort, const G30Config& config);
 
+    /**
+     * @brief Construct with a buffer-oriented communication implementation
+     * @param commPort Custom communication port implementation
+     * @param config Configuration parameters
+     */
+    TDKLambdaG30(std::unique_ptr<ICommunicationV2> commPort, const G30Config& config);
+
     /**
      * @brief Destructor - ensures proper cleanup
      */
@@ -267,6 +540,24 @@ public:
      */
     double measurePower(int channel = 1) const override;
 
+    /**
+     * @brief Measure with host-side oversampling
+     *
+     * Sends n measurement queries back to back in one pipelined burst, so
+     * the cost is about one round trip plus n device conversions instead
+     * of n settled single readings. Samples whose modified z-score
+     * (0.6745 * |x - median| / MAD) exceeds outlierThreshold are rejected
+     * before the mean and standard deviation are taken.
+     *
+     * @param metric Quantity to measure
+     * @param n Number of samples (>= 1)
+     * @param outlierThreshold Modified z-score limit (0 = keep all samples)
+     * @return Statistics of the burst
+     * @throws G30Exception on invalid arguments or communication error
+     */
+    AveragedMeasurement measureAveraged(MeasureMetric metric, int n,
+                                        double outlierThreshold = 3.5) const;
+
     /**
      * @brief Set over-voltage protection level
      * @param voltage OVP level in volts
@@ -354,6 +645,57 @@ public:
      */
     void setMaxCurrent(double maxCurrent);
 
+    // ==================== Configuration Snapshots ====================
+
+    /**
+     * @brief Read the full device configuration in one compound query
+     *
+     * The result also becomes the reference snapshot for applyConfig().
+     *
+     * @return Current device configuration
+     * @throws G30Exception on communication error
+     */
+    DeviceConfig readConfig() const;
+
+    /**
+     * @brief Apply a configuration, sending only the parameters that differ
+     *
+     * The target is compared against the last snapshot (read with
+     * readConfig() if none is held) and all changed parameters are sent in
+     * one batched message, ordered so that OVP never trips during the change.
+     * Raw writes (sendCommand(), sendBatch()) discard the snapshot. If the
+     * output is to stay on, its state is queried first with one pipelined
+     * round trip, since a protection trip switches it off behind the
+     * snapshot. The snapshot is shared with the setters of other threads;
+     * of two concurrent applyConfig() calls the last one to send wins.
+     *
+     * @param target Desired configuration
+     * @return Number of parameters that were changed
+     * @throws G30Exception if target is out of range, its voltage exceeds its
+     *         OVP level, or communication fails
+     */
+    int applyConfig(const DeviceConfig& target);
+
+    /**
+     * @brief Store the present settings in an internal setup memory (*SAV)
+     * @param slot Memory slot (1..G30Config::setupSlots)
+     * @throws G30Exception if slot is out of range or communication fails
+     */
+    void saveSetup(int slot);
+
+    /**
+     * @brief Recall settings from an internal setup memory (*RCL)
+     * @param slot Memory slot (1..G30Config::setupSlots)
+     * @throws G30Exception if slot is out of range or communication fails
+     */
+    void recallSetup(int slot);
+
+    /**
+     * @brief Get number of setup memories
+     * @return Slot count
+     */
+    int getSetupSlots() const { return config_.setupSlots; }
+
     // ==================== Advanced Features ====================
 
     /**
@@ -372,6 +714,104 @@ public:
      */
     std::string sendQuery(const std::string& query) const override;
 
+    /**
+     * @brief Send several SCPI commands in a single message
+     *
+     * Commands are newline-terminated and written back to back without the
+     * per-command settling delay of sendCommand().
+     *
+     * @param commands SCPI command strings
+     * @throws G30Exception on communication error
+     */
+    void sendBatch(const std::vector<std::string>& commands);
+
+    /**
+     * @brief Send pre-encoded command fragments in a single message
+     *
+     * The fragments are sent as they are (each command must carry its own
+     * terminator) with one vectored write, so large encoded sequences are sent
+     * without being concatenated first. Like every other write, the batch
+     * fails fast on an open circuit and is sent only after late replies to
+     * timed-out queries have been discarded.
+     *
+     * @param fragments Encoded command bytes
+     * @param count Number of fragments
+     * @throws G30Exception on communication error
+     */
+    void sendBatch(const ConstBuffer* fragments, size_t count);
+
+    /**
+     * @brief Send several SCPI queries pipelined in a single message
+     *
+     * All queries are written at once and the responses are read back in
+     * order, so a batch costs about one round trip instead of one per query.
+     *
+     * @param queries SCPI query strings
+     * @param timeout_ms Per-response timeout (0 = G30Config::timeout_ms)
+     * @return One trimmed response per query
+     * @throws G30Exception on communication error or missing response
+     */
+    std::vector<std::string> sendQueries(const std::vector<std::string>& queries,
+                                         int timeout_ms = 0) const;
+
+    /**
+     * @brief Send pipelined queries and report their round-trip time
+     *
+     * Like sendQueries(), and also yields the time from writing the queries
+     * to the first response of the successful attempt. Time spent waiting
+     * for another caller's transaction on the same supply is not included.
+     * The timeout also bounds the wait for a late reply owed by an earlier
+     * timed-out query, so a heartbeat never blocks longer than it allows.
+     *
+     * @param queries SCPI query strings
+     * @param timeout_ms Per-response timeout (0 = G30Config::timeout_ms)
+     * @param rtt_ms Receives the round-trip time in milliseconds
+     * @param retries Extra attempts if the queries are idempotent
+     *        (-1 = G30Config::queryRetries, 0 = report every loss)
+     * @return One trimmed response per query
+     * @throws G30Exception on communication error or missing response
+     */
+    std::vector<std::string> sendQueries(const std::vector<std::string>& queries,
+                                         int timeout_ms, double& rtt_ms, int retries = -1) const;
+
+    /**
+     * @brief Time the last complete response line was received
+     * @return steady_clock time, or the epoch if nothing was received yet
+     */
+    std::chrono::steady_clock::time_point lastResponseTime() const;
+
+    /**
+     * @brief Get the time source of delays and ramps (G30Config::clock)
+     * @return Configured clock, or the system clock
+     */
+    IClock& clock() const { return config_.clock ? *config_.clock : SystemClock::instance(); }
+
+    /**
+     * @brief Get the round-trip estimate and the timeout it yields
+     *
+     * RTT is sampled only on pipelined queries (sendQueries), which have no
+     * settling delay; single queries (sendQuery and the getters built on it)
+     * sleep 50 ms before reading, so their reply time is not a round trip.
+     * With G30Config::adaptiveTimeout the response timeout is
+     * srtt + k * rttvar within [minTimeout_ms, maxTimeout_ms], doubled after
+     * each timeout until the next sample; otherwise it is timeout_ms.
+     *
+     * @return Current estimate
+     */
+    RttEstimate rttEstimate() const;
+
+    /**
+     * @brief Get the circuit breaker state
+     *
+     * After G30Config::breakerThreshold consecutive failed transactions
+     * the circuit opens and every transaction throws at once. After
+     * breakerOpen_ms the next transaction first sends a probe query; a
+     * reply closes the circuit, silence keeps it open for another period.
+     *
+     * @return Current state
+     */
+    CircuitState circuitState() const;
+
     /**
      * @brief Set custom error handler callback
      * @param handler Error handler function
@@ -379,10 +819,10 @@ public:
     void setErrorHandler(std::function<void(const std::string&)> handler);
 
 private:
-    std::unique_ptr<ICommunication> commPort_;
+    std::unique_ptr<ICommunicationV2> commPort_;
     G30Config config_;
     bool connected_;
-    mutable bool outputEnabled_;
+    mutable bool outputEnabled_;        // Guarded by stateMutex_
 
     // Safety limits
     double maxVoltage_;
@@ -391,6 +831,43 @@ private:
     // Error handling
     std::function<void(const std::string&)> errorHandler_;
 
+    // Serializes write/read transactions on commPort_ (not moved with the object)
+    mutable std::mutex ioMutex_;
+
+    // Gather list reused by writeMessages() (guarded by ioMutex_)
+    mutable std::vector<ConstBuffer> txBuffers_;
+
+    // Replies still owed by timed-out queries, discarded before the next write
+    mutable size_t staleReplies_;
+
+    // steady_clock nanoseconds of the last complete response line
+    mutable std::atomic<int64_t> lastResponse_ns_;
+
+    // Round-trip estimator and circuit breaker (own lock: readable while a
+    // transaction is in progress)
+    mutable std::mutex linkMutex_;
+    mutable RttEstimate rtt_;
+    mutable CircuitState circuit_;
+    mutable int consecutiveFailures_;
+    mutable std::chrono::steady_clock::time_point circuitOpened_;
+
+    // Last known device configuration, used by applyConfig(); the setters
+    // of all threads update it, so it has its own lock (never held over I/O)
+    mutable std::mutex stateMutex_;
+    mutable DeviceConfig snapshot_;
+    mutable bool snapshotValid_;
+
+    /**
+     * @brief Discard the configuration snapshot
+     */
+    void invalidateSnapshot() const;
+
+    /**
+     * @brief Record a known output state in the cached state
+     * @param enabled Output state
+     */
+    void storeOutputState(bool enabled) const;
+
     /**
      * @brief Validate voltage is within limits
      * @param voltage Voltage to validate
@@ -405,6 +882,13 @@ private:
      */
     void validateCurrent(double current) const;
 
+    /**
+     * @brief Validate setup memory slot number
+     * @param slot Slot to validate
+     * @throws G30Exception if out of range
+     */
+    void validateSetupSlot(int slot) const;
+
     /**
      * @brief Parse numeric response from device
      * @param response Response string
@@ -413,6 +897,106 @@ private:
      */
     double parseNumericResponse(const std::string& response) const;
 
+    /**
+     * @brief Write one message to the device under the I/O lock
+     * @param data Command or query (a missing terminator is supplied)
+     */
+    void transmit(const std::string& data) const;
+
+    /**
+     * @brief Checks every write goes through first (caller holds ioMutex_)
+     *
+     * Fails fast on an open circuit and discards replies owed by timed-out
+     * queries, so nothing sent next can be paired with a stale reply.
+     *
+     * @param timeout_ms Response timeout of the transaction (0 = responseTimeout())
+     */
+    void prepareWrite(int timeout_ms = 0) const;
+
+    /**
+     * @brief Write one message without copying it (caller holds ioMutex_)
+     * @param message Command or query (a missing terminator is supplied)
+     * @param timeout_ms Response timeout of the transaction (0 = responseTimeout())
+     */
+    void writeMessage(const std::string& message, int timeout_ms = 0) const;
+
+    /**
+     * @brief Write several messages as one transmission (caller holds ioMutex_)
+     * @param messages Commands or queries (missing terminators are supplied)
+     * @param timeout_ms Response timeout of the transaction (0 = responseTimeout())
+     */
+    void writeMessages(const std::vector<std::string>& messages, int timeout_ms = 0) const;
+
+    /**
+     * @brief Consume replies owed by timed-out queries (caller holds ioMutex_)
+     *
+     * Waits at most G30Config::staleDrain_ms, and never longer than the
+     * transaction's own response timeout; a reply that is later still is
+     * given up as lost.
+     *
+     * @param timeout_ms Response timeout of the transaction (0 = responseTimeout())
+     */
+    void discardStaleInput(int timeout_ms = 0) const;
+
+    /**
+     * @brief Get the response timeout to apply now
+     * @return Timeout in milliseconds
+     */
+    int responseTimeout() const;
+
+    /**
+     * @brief Feed one measured round trip into the estimator
+     * @param rtt_ms Write-to-first-response time
+     */
+    void recordRtt(double rtt_ms) const;
+
+    /**
+     * @brief Back off the adaptive timeout after a response timed out
+     */
+    void recordTimeout() const;
+
+    /**
+     * @brief Fail fast while the circuit is open, probe once it may close
+     * @param timeout_ms Response timeout of the transaction (0 = responseTimeout())
+     * @throws G30Exception if the circuit is (still) open
+     *
+     * The caller must hold ioMutex_.
+     */
+    void checkCircuit(int timeout_ms = 0) const;
+
+    /**
+     * @brief Record the outcome of a transaction for the circuit breaker
+     * @param success true if the device answered
+     */
+    void recordOutcome(bool success) const;
+
+    /**
+     * @brief Sleep before retry number attempt (exponential, jittered)
+     * @param attempt Retry number starting at 1
+     */
+    void retryBackoff(int attempt) const;
+
+    /**
+     * @brief Read one response line (the transport keeps surplus bytes)
+     * @param timeout_ms Timeout in milliseconds
+     * @param line Receives the trimmed line
+     * @return true if a complete line was read, false on timeout
+     */
+    bool readResponseLine(int timeout_ms, std::string& line) const;
+
+    /**
+     * @brief Pipelined query transaction with retries (see sendQueries)
+     * @param queries SCPI query strings
+     * @param timeout_ms Per-response timeout (0 = responseTimeout())
+     * @param arrivals If not null, receives the arrival time of each response
+     * @param rtt_ms If not null, receives the write-to-first-response time
+     * @param retries Extra attempts if idempotent (-1 = G30Config::queryRetries)
+     * @return One trimmed response per query
+     */
+    std::vector<std::string> queryPipelined(const std::vector<std::string>& queries, int timeout_ms,
+                                            std::vector<std::chrono::steady_clock::time_point>* arrivals,
+                                            double* rtt_ms = nullptr, int retries = -1) const;
+
     /**
      * @brief Trim whitespace from string
      * @param str String to trim
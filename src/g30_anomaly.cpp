@@ -0,0 +1,319 @@
+/**
+ * @file g30_anomaly.cpp
+ * @brief Implementation of the streaming anomaly detector
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_anomaly.h"
+#include <algorithm>
+#include <cmath>
+
+namespace TDKLambda {
+
+namespace {
+
+enum Detector { DETECT_SPIKE, DETECT_UP, DETECT_DOWN, DETECTORS };
+
+// Samples enter the baseline clipped to this many deviations (Huber-style),
+// so a burst cannot inflate the variance faster than the detectors react
+const double kBaselineClip = 3.0;
+
+} // namespace
+
+const char* anomalyMetricName(AnomalyMetric metric) {
+    switch (metric) {
+        case AnomalyMetric::VOLTAGE:        return "voltage";
+        case AnomalyMetric::CURRENT:        return "current";
+        case AnomalyMetric::POWER:          return "power";
+        case AnomalyMetric::VOLTAGE_RIPPLE: return "voltage ripple";
+        case AnomalyMetric::CURRENT_RIPPLE: return "current ripple";
+    }
+    return "unknown";
+}
+
+const char* anomalyKindName(AnomalyKind kind) {
+    switch (kind) {
+        case AnomalyKind::SPIKE:       return "spike";
+        case AnomalyKind::DRIFT_UP:    return "drift up";
+        case AnomalyKind::DRIFT_DOWN:  return "drift down";
+        case AnomalyKind::LEVEL_SHIFT: return "level shift";
+    }
+    return "unknown";
+}
+
+/**
+ * Fixed-size state of one metric of one device
+ */
+struct AnomalyDetector::MetricState {
+    AnomalyMetric metric;
+    int samples;            // Samples seen since the last reset
+    double mean;            // Baseline EWMA
+    double variance;        // Baseline EW variance
+    double fast;            // Fast EWMA of the metric
+    double lastRaw;         // Previous raw signal (ripple metrics)
+    double cusumHigh;
+    double cusumLow;
+    int64_t highStart_ns;   // Last time cusumHigh left zero
+    int64_t lowStart_ns;
+    int shiftRun;           // Consecutive samples beyond shiftThreshold
+    int64_t shiftStart_ns;  // First sample of that run
+    int cooldown[DETECTORS];
+
+    explicit MetricState(AnomalyMetric m) : metric(m) { clear(); }
+
+    void clear() {
+        samples = 0;
+        mean = variance = fast = lastRaw = 0.0;
+        cusumHigh = cusumLow = 0.0;
+        highStart_ns = lowStart_ns = 0;
+        shiftRun = 0;
+        shiftStart_ns = 0;
+        std::fill(cooldown, cooldown + DETECTORS, 0);
+    }
+};
+
+/**
+ * State of one device: its metrics and the evidence ring
+ */
+struct AnomalyDetector::DeviceState {
+    std::mutex mutex;
+    std::vector<MetricState> metrics;
+    std::vector<TelemetrySample> ring;
+    size_t head;
+    size_t filled;
+    double lastVoltage;
+    bool haveVoltage;
+
+    DeviceState() : head(0), filled(0), lastVoltage(0.0), haveVoltage(false) {}
+};
+
+AnomalyDetector::AnomalyDetector(size_t devices, const AnomalyConfig& config)
+    : config_(config),
+      events_(0) {
+
+    if (devices == 0) {
+        throw G30Exception("Anomaly detector needs at least one device");
+    }
+    if (config_.metrics.empty()) {
+        throw G30Exception("Anomaly detector needs at least one metric");
+    }
+    if (config_.baselineAlpha <= 0 || config_.baselineAlpha >= 1 ||
+        config_.fastAlpha <= 0 || config_.fastAlpha >= 1) {
+        throw G30Exception("EWMA gains must be between 0 and 1");
+    }
+    if (config_.warmupSamples < 2 || config_.stddevFloor <= 0) {
+        throw G30Exception("Invalid warm-up length or deviation floor");
+    }
+
+    devices_.reserve(devices);
+    for (size_t d = 0; d < devices; ++d) {
+        std::unique_ptr<DeviceState> state(new DeviceState());
+        for (AnomalyMetric m : config_.metrics) {
+            state->metrics.emplace_back(m);
+        }
+        state->ring.resize(config_.evidenceSamples);
+        devices_.push_back(std::move(state));
+    }
+}
+
+AnomalyDetector::~AnomalyDetector() = default;
+
+void AnomalyDetector::setEventCallback(std::function<void(const AnomalyEvent&)> callback) {
+    callback_ = callback;
+}
+
+void AnomalyDetector::reset(size_t device) {
+    if (device >= devices_.size()) {
+        throw G30Exception("Anomaly device index out of range");
+    }
+    DeviceState& state = *devices_[device];
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (auto& m : state.metrics) {
+        m.clear();
+    }
+}
+
+bool AnomalyDetector::baseline(size_t device, AnomalyMetric metric, double& mean, double& stddev) const {
+    if (device >= devices_.size()) {
+        throw G30Exception("Anomaly device index out of range");
+    }
+    DeviceState& state = *devices_[device];
+    std::lock_guard<std::mutex> lock(state.mutex);
+    for (const auto& m : state.metrics) {
+        if (m.metric == metric && m.samples >= config_.warmupSamples) {
+            mean = m.mean;
+            stddev = std::max(std::sqrt(m.variance), config_.stddevFloor);
+            return true;
+        }
+    }
+    return false;
+}
+
+void AnomalyDetector::onSample(const TelemetrySample& sample) {
+    if (!sample.valid || sample.device >= devices_.size()) {
+        return;
+    }
+
+    DeviceState& state = *devices_[sample.device];
+    std::vector<AnomalyEvent> raised;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        if (!state.ring.empty()) {
+            state.ring[state.head] = sample;
+            state.head = (state.head + 1) % state.ring.size();
+            state.filled = std::min(state.filled + 1, state.ring.size());
+        }
+
+        // A new setpoint changes every baseline; it is not an anomaly
+        if (state.haveVoltage && config_.voltageStepReset_V > 0 &&
+            std::abs(sample.voltage - state.lastVoltage) > config_.voltageStepReset_V) {
+            for (auto& m : state.metrics) {
+                m.clear();
+            }
+        }
+        state.lastVoltage = sample.voltage;
+        state.haveVoltage = true;
+
+        const int shiftPersistence = static_cast<int>(std::ceil(2.0 / config_.fastAlpha));
+
+        for (auto& m : state.metrics) {
+            double x;
+            switch (m.metric) {
+                case AnomalyMetric::CURRENT:        x = sample.current; break;
+                case AnomalyMetric::POWER:          x = sample.power; break;
+                case AnomalyMetric::VOLTAGE_RIPPLE:
+                case AnomalyMetric::CURRENT_RIPPLE: {
+                    double raw = (m.metric == AnomalyMetric::VOLTAGE_RIPPLE) ? sample.voltage : sample.current;
+                    // Successive difference: a step or spike moves it for one or
+                    // two samples only, while a noisier DUT raises it for good
+                    if (m.samples == 0) {
+                        m.lastRaw = raw;
+                    }
+                    x = std::abs(raw - m.lastRaw) / std::sqrt(2.0);
+                    m.lastRaw = raw;
+                    break;
+                }
+                default:                            x = sample.voltage; break;
+            }
+
+            if (m.samples < config_.warmupSamples) {
+                // Running average while warming up, so the baseline starts unbiased
+                double alpha = std::max(config_.baselineAlpha, 1.0 / (m.samples + 1));
+                double diff = x - m.mean;
+                m.mean += alpha * diff;
+                m.variance = (1.0 - alpha) * (m.variance + alpha * diff * diff);
+                m.fast = m.mean;
+                ++m.samples;
+                continue;
+            }
+
+            double sd = std::max(std::sqrt(m.variance), config_.stddevFloor);
+            double z = (x - m.mean) / sd;
+
+            AnomalyEvent event;
+            event.device = sample.device;
+            event.metric = m.metric;
+            event.timestamp_ns = sample.timestamp_ns;
+            event.changeStart_ns = sample.timestamp_ns;
+            event.value = x;
+            event.baselineMean = m.mean;
+            event.baselineStddev = sd;
+
+            // |deviation| is half-normal, far too heavy-tailed for z-score and CUSUM
+            // thresholds; ripple is only checked for a sustained change of level
+            const bool ripple = m.metric == AnomalyMetric::VOLTAGE_RIPPLE ||
+                                m.metric == AnomalyMetric::CURRENT_RIPPLE;
+
+            if (!ripple && std::abs(z) > config_.zThreshold && m.cooldown[DETECT_SPIKE] == 0) {
+                event.kind = AnomalyKind::SPIKE;
+                event.score = z;
+                raised.push_back(event);
+                m.cooldown[DETECT_SPIKE] = config_.cooldownSamples;
+            }
+
+            // Two-sided CUSUM on the clipped z, so a lone spike is not also a drift;
+            // the last time a sum left zero estimates the change start
+            double zc = std::max(-config_.zThreshold, std::min(config_.zThreshold, z));
+            if (m.cusumHigh == 0.0) {
+                m.highStart_ns = sample.timestamp_ns;
+            }
+            if (m.cusumLow == 0.0) {
+                m.lowStart_ns = sample.timestamp_ns;
+            }
+            m.cusumHigh = std::max(0.0, m.cusumHigh + zc - config_.cusumK);
+            m.cusumLow = std::max(0.0, m.cusumLow - zc - config_.cusumK);
+            if (!ripple && m.cusumHigh > config_.cusumH && m.cooldown[DETECT_UP] == 0) {
+                event.kind = AnomalyKind::DRIFT_UP;
+                event.score = m.cusumHigh;
+                event.changeStart_ns = m.highStart_ns;
+                raised.push_back(event);
+                m.cusumHigh = 0.0;
+                m.cooldown[DETECT_UP] = config_.cooldownSamples;
+            }
+            if (!ripple && m.cusumLow > config_.cusumH && m.cooldown[DETECT_DOWN] == 0) {
+                event.kind = AnomalyKind::DRIFT_DOWN;
+                event.score = m.cusumLow;
+                event.changeStart_ns = m.lowStart_ns;
+                raised.push_back(event);
+                m.cusumLow = 0.0;
+                m.cooldown[DETECT_DOWN] = config_.cooldownSamples;
+            }
+
+            // Fast EWMA against the baseline, in standard errors of the fast EWMA;
+            // it must persist so a single spike is not also reported as a shift
+            m.fast += config_.fastAlpha * (x - m.fast);
+            double shift = (m.fast - m.mean) / (sd * std::sqrt(config_.fastAlpha / (2.0 - config_.fastAlpha)));
+            if (std::abs(shift) > config_.shiftThreshold) {
+                if (m.shiftRun++ == 0) {
+                    m.shiftStart_ns = sample.timestamp_ns;
+                }
+            } else {
+                m.shiftRun = 0;
+            }
+            if (m.shiftRun >= shiftPersistence) {
+                event.kind = AnomalyKind::LEVEL_SHIFT;
+                event.score = shift;
+                event.changeStart_ns = m.shiftStart_ns;
+                raised.push_back(event);
+                // The new level is the new normal; learn it from scratch
+                m.clear();
+                continue;
+            }
+
+            // The baseline is frozen while a shift is building up, so it does not chase it
+            if (m.shiftRun == 0) {
+                double diff = std::max(-kBaselineClip, std::min(kBaselineClip, z)) * sd;
+                m.mean += config_.baselineAlpha * diff;
+                m.variance = (1.0 - config_.baselineAlpha) * (m.variance + config_.baselineAlpha * diff * diff);
+            }
+
+            for (int& c : m.cooldown) {
+                if (c > 0) {
+                    --c;
+                }
+            }
+        }
+
+        if (!raised.empty()) {
+            std::vector<TelemetrySample> evidence;
+            evidence.reserve(state.filled);
+            for (size_t i = 0; i < state.filled; ++i) {
+                evidence.push_back(state.ring[(state.head + state.ring.size() - state.filled + i) % state.ring.size()]);
+            }
+            for (auto& e : raised) {
+                e.evidence = evidence;
+            }
+        }
+    }
+
+    events_ += raised.size();
+    if (callback_) {
+        for (const auto& e : raised) {
+            callback_(e);
+        }
+    }
+}
+
+} // namespace TDKLambda
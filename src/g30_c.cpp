@@ -0,0 +1,537 @@
+/**
+ * @file g30_c.cpp
+ * @brief Implementation of the C ABI
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_c.h"
+#include "../include/g30_sweep.h"
+#include "../include/g30_sync_ramp.h"
+#include "../include/g30_telemetry.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+using namespace TDKLambda;
+
+struct g30_device {
+    std::unique_ptr<TDKLambdaG30> psu;
+};
+
+namespace {
+
+/**
+ * @brief Ring buffer sink feeding g30_sampler_drain()
+ */
+class RingSink : public ITelemetrySink {
+public:
+    explicit RingSink(size_t capacity) : capacity_(capacity), dropped_(0) {}
+
+    void onSample(const TelemetrySample& sample) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ring_.size() >= capacity_) {
+            ring_.pop_front();
+            ++dropped_;
+        }
+        ring_.push_back(sample);
+    }
+
+    template <typename Fn>
+    size_t drain(size_t max, Fn&& store) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t n = std::min(max, ring_.size());
+        for (size_t i = 0; i < n; ++i) {
+            store(i, ring_[i]);
+        }
+        ring_.erase(ring_.begin(), ring_.begin() + static_cast<std::ptrdiff_t>(n));
+        return n;
+    }
+
+    uint64_t dropped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+private:
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::deque<TelemetrySample> ring_;
+    uint64_t dropped_;
+};
+
+thread_local std::string lastError;
+
+g30_status fail(g30_status status, const std::string& message) {
+    lastError = message;
+    return status;
+}
+
+/**
+ * @brief Run fn, translating exceptions into status codes
+ *
+ * Arguments and the connection are checked by the wrappers before fn runs,
+ * so a G30Exception here is a communication or device error.
+ */
+template <typename Fn>
+g30_status guarded(Fn&& fn) {
+    try {
+        fn();
+        lastError.clear();
+        return G30_OK;
+    } catch (const G30Exception& e) {
+        return fail(G30_ERR_DEVICE, e.what());
+    } catch (const std::exception& e) {
+        return fail(G30_ERR_INTERNAL, e.what());
+    } catch (...) {
+        return fail(G30_ERR_INTERNAL, "Unknown exception");
+    }
+}
+
+g30_status copyString(const std::string& text, char* buffer, size_t length) {
+    if (!buffer || length == 0) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Output buffer is null or empty");
+    }
+    size_t n = std::min(text.size(), length - 1);
+    std::memcpy(buffer, text.data(), n);
+    buffer[n] = '\0';
+    if (n < text.size()) {
+        return fail(G30_ERR_BUFFER_TOO_SMALL, "Output truncated");
+    }
+    return G30_OK;
+}
+
+void toCSample(const TelemetrySample& in, g30_sample& out) {
+    out.device = in.device;
+    out.status = in.status;
+    out.sequence = in.sequence;
+    out.timestamp_ns = in.timestamp_ns;
+    out.voltage = in.voltage;
+    out.current = in.current;
+    out.power = in.power;
+    out.output_enabled = in.outputEnabled ? 1 : 0;
+    out.valid = in.valid ? 1 : 0;
+}
+
+/**
+ * @brief Check a setpoint against 0..limit (NaN fails)
+ */
+g30_status checkRange(const char* what, double value, double limit) {
+    if (value >= 0 && value <= limit) {
+        return G30_OK;
+    }
+    return fail(G30_ERR_INVALID_ARGUMENT, std::string(what) + " " + std::to_string(value) +
+                " out of range 0.." + std::to_string(limit));
+}
+
+bool collectDevices(g30_device* const* devices, size_t count, std::vector<TDKLambdaG30*>& out) {
+    if (!devices || count == 0) {
+        return false;
+    }
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!devices[i]) {
+            return false;
+        }
+        out.push_back(devices[i]->psu.get());
+    }
+    return true;
+}
+
+} // namespace
+
+struct g30_sampler {
+    std::unique_ptr<TelemetrySampler> sampler;
+    std::shared_ptr<RingSink> ring;
+};
+
+struct g30_sweep_result {
+    SweepTable table;
+};
+
+#define G30_CHECK_HANDLE(h) \
+    do { if (!(h)) return fail(G30_ERR_INVALID_ARGUMENT, "Null handle"); } while (0)
+
+#define G30_CHECK_OUT(p) \
+    do { if (!(p)) return fail(G30_ERR_INVALID_ARGUMENT, "Null output pointer"); } while (0)
+
+#define G30_CHECK_CONNECTED(d) \
+    do { \
+        if (!(d)) return fail(G30_ERR_INVALID_ARGUMENT, "Null handle"); \
+        if (!(d)->psu->isConnected()) return fail(G30_ERR_NOT_CONNECTED, "Not connected to device"); \
+    } while (0)
+
+#define G30_CHECK_STATUS(expr) \
+    do { g30_status status_ = (expr); if (status_ != G30_OK) return status_; } while (0)
+
+extern "C" {
+
+// ==================== General ====================
+
+int g30_api_version(void) {
+    return G30_C_API_VERSION;
+}
+
+const char* g30_last_error(void) {
+    return lastError.c_str();
+}
+
+// ==================== Devices ====================
+
+g30_status g30_open(const char* ip_address, int tcp_port, int timeout_ms, g30_device** out) {
+    G30_CHECK_OUT(out);
+    if (!ip_address) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "IP address is null");
+    }
+    *out = nullptr;
+    return guarded([&]() {
+        G30Config config;
+        config.ipAddress = ip_address;
+        config.tcpPort = tcp_port;
+        if (timeout_ms > 0) {
+            config.timeout_ms = timeout_ms;
+        }
+        config.resetOnConnect = false;     // Reset is requested per g30_connect() call
+        std::unique_ptr<g30_device> device(new g30_device());
+        device->psu.reset(new TDKLambdaG30(config));
+        *out = device.release();
+    });
+}
+
+void g30_close(g30_device* device) {
+    try {
+        delete device;
+    } catch (...) {
+        // Never let an exception escape into foreign code
+    }
+}
+
+g30_status g30_connect(g30_device* device, int reset) {
+    G30_CHECK_HANDLE(device);
+    return guarded([&]() {
+        device->psu->connect();
+        if (reset) {
+            device->psu->reset();
+            device->psu->clearProtection();
+        }
+    });
+}
+
+g30_status g30_disconnect(g30_device* device) {
+    G30_CHECK_HANDLE(device);
+    return guarded([&]() { device->psu->disconnect(); });
+}
+
+int g30_is_connected(const g30_device* device) {
+    return (device && device->psu->isConnected()) ? 1 : 0;
+}
+
+g30_status g30_enable_output(g30_device* device, int enable) {
+    G30_CHECK_CONNECTED(device);
+    return guarded([&]() { device->psu->enableOutput(enable != 0); });
+}
+
+g30_status g30_is_output_enabled(g30_device* device, int* enabled) {
+    G30_CHECK_CONNECTED(device);
+    G30_CHECK_OUT(enabled);
+    return guarded([&]() { *enabled = device->psu->isOutputEnabled() ? 1 : 0; });
+}
+
+g30_status g30_set_voltage(g30_device* device, double voltage) {
+    G30_CHECK_CONNECTED(device);
+    G30_CHECK_STATUS(checkRange("Voltage", voltage, device->psu->getMaxVoltage()));
+    return guarded([&]() { device->psu->setVoltage(voltage); });
+}
+
+g30_status g30_get_voltage(g30_device* device, double* voltage) {
+    G30_CHECK_CONNECTED(device);
+    G30_CHECK_OUT(voltage);
+    return guarded([&]() { *voltage = device->psu->getVoltage(); });
+}
+
+g30_status g30_measure_voltage(g30_device* device, double* voltage) {
+    G30_CHECK_CONNECTED(device);
+    G30_CHECK_OUT(voltage);
+    return guarded([&]() { *voltage = device->psu->measureVoltage(); });
+}
+
+g30_status g30_set_current(g30_device* device, double current) {
+    G30_CHECK_CONNECTED(device);
+    G30_CHECK_STATUS(checkRange("Current", current, device->psu->getMaxCurrent()));
+    return guarded([&]() { device->psu->setCurrent(current); });
+}
+
+g30_status g30_get_current(g30_device* device, double* current) {
+    G30_CHECK_CONNECTED(device);
+    G30_CHECK_OUT(current);
+    return guarded([&]() { *current = device->psu->getCurrent(); });
+}
+
+g30_status g30_measure_current(g30_device* device, double* current) {
+    G30_CHECK_CONNECTED(device);
+    G30_CHECK_OUT(current);
+    return guarded([&]() { *current = device->psu->measureCurrent(); });
+}
+
+g30_status g30_set_ovp(g30_device* device, double voltage) {
+    G30_CHECK_CONNECTED(device);
+    if (!(voltage > 0)) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "OVP level must be positive");
+    }
+    return guarded([&]() { device->psu->setOverVoltageProtection(voltage); });
+}
+
+g30_status g30_get_ovp(g30_device* device, double* voltage) {
+    G30_CHECK_CONNECTED(device);
+    G30_CHECK_OUT(voltage);
+    return guarded([&]() { *voltage = device->psu->getOverVoltageProtection(); });
+}
+
+g30_status g30_clear_protection(g30_device* device) {
+    G30_CHECK_CONNECTED(device);
+    return guarded([&]() { device->psu->clearProtection(); });
+}
+
+g30_status g30_read_config(g30_device* device, g30_device_config* config) {
+    G30_CHECK_CONNECTED(device);
+    G30_CHECK_OUT(config);
+    return guarded([&]() {
+        DeviceConfig c = device->psu->readConfig();
+        config->voltage = c.voltage;
+        config->current = c.current;
+        config->over_voltage_protection = c.overVoltageProtection;
+        config->output_enabled = c.outputEnabled ? 1 : 0;
+    });
+}
+
+g30_status g30_apply_config(g30_device* device, const g30_device_config* config, int* changed) {
+    G30_CHECK_CONNECTED(device);
+    if (!config) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Config is null");
+    }
+    G30_CHECK_STATUS(checkRange("Voltage", config->voltage, device->psu->getMaxVoltage()));
+    G30_CHECK_STATUS(checkRange("Current", config->current, device->psu->getMaxCurrent()));
+    if (!(config->voltage <= config->over_voltage_protection)) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Voltage exceeds the OVP level of the config");
+    }
+    return guarded([&]() {
+        DeviceConfig c;
+        c.voltage = config->voltage;
+        c.current = config->current;
+        c.overVoltageProtection = config->over_voltage_protection;
+        c.outputEnabled = config->output_enabled != 0;
+        int n = device->psu->applyConfig(c);
+        if (changed) {
+            *changed = n;
+        }
+    });
+}
+
+g30_status g30_identification(g30_device* device, char* buffer, size_t length) {
+    G30_CHECK_CONNECTED(device);
+    std::string id;
+    g30_status status = guarded([&]() { id = device->psu->getIdentification(); });
+    return status == G30_OK ? copyString(id, buffer, length) : status;
+}
+
+g30_status g30_query(g30_device* device, const char* query, char* buffer, size_t length) {
+    G30_CHECK_CONNECTED(device);
+    if (!query) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Query is null");
+    }
+    std::string response;
+    g30_status status = guarded([&]() { response = device->psu->sendQuery(query); });
+    return status == G30_OK ? copyString(response, buffer, length) : status;
+}
+
+g30_status g30_command(g30_device* device, const char* command) {
+    G30_CHECK_CONNECTED(device);
+    if (!command || !*command) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Command is null or empty");
+    }
+    return guarded([&]() { device->psu->sendCommand(command); });
+}
+
+// ==================== Telemetry ====================
+
+g30_status g30_sampler_create(g30_device* const* devices, size_t count, int period_ms,
+                              size_t capacity, g30_sampler** out) {
+    G30_CHECK_OUT(out);
+    *out = nullptr;
+    std::vector<TDKLambdaG30*> supplies;
+    if (!collectDevices(devices, count, supplies) || capacity == 0) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Invalid device list or capacity");
+    }
+    if (period_ms <= 0) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Sampling period must be positive");
+    }
+    return guarded([&]() {
+        TelemetryConfig config;
+        config.period_ms = period_ms;
+        std::unique_ptr<g30_sampler> sampler(new g30_sampler());
+        sampler->sampler.reset(new TelemetrySampler(supplies, config));
+        sampler->ring = std::make_shared<RingSink>(capacity);
+        sampler->sampler->addSink(sampler->ring);
+        *out = sampler.release();
+    });
+}
+
+void g30_sampler_destroy(g30_sampler* sampler) {
+    try {
+        delete sampler;
+    } catch (...) {
+        // Never let an exception escape into foreign code
+    }
+}
+
+g30_status g30_sampler_start(g30_sampler* sampler) {
+    G30_CHECK_HANDLE(sampler);
+    return guarded([&]() { sampler->sampler->start(); });
+}
+
+g30_status g30_sampler_stop(g30_sampler* sampler) {
+    G30_CHECK_HANDLE(sampler);
+    return guarded([&]() { sampler->sampler->stop(); });
+}
+
+g30_status g30_sampler_latest(g30_sampler* sampler, size_t device, g30_sample* sample) {
+    G30_CHECK_HANDLE(sampler);
+    G30_CHECK_OUT(sample);
+    if (device >= sampler->sampler->size()) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Device index out of range");
+    }
+    return guarded([&]() { toCSample(sampler->sampler->latest(device), *sample); });
+}
+
+g30_status g30_sampler_drain(g30_sampler* sampler, g30_sample* samples, size_t max, size_t* count) {
+    G30_CHECK_HANDLE(sampler);
+    G30_CHECK_OUT(count);
+    if (!samples && max > 0) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Sample array is null");
+    }
+    return guarded([&]() {
+        *count = sampler->ring->drain(max, [samples](size_t i, const TelemetrySample& s) {
+            toCSample(s, samples[i]);
+        });
+    });
+}
+
+g30_status g30_sampler_drain_columns(g30_sampler* sampler, size_t max, size_t* count,
+                                     uint32_t* device, int64_t* timestamp_ns,
+                                     double* voltage, double* current, uint32_t* status,
+                                     int32_t* output_enabled, int32_t* valid) {
+    G30_CHECK_HANDLE(sampler);
+    G30_CHECK_OUT(count);
+    return guarded([&]() {
+        *count = sampler->ring->drain(max, [=](size_t i, const TelemetrySample& s) {
+            if (device) device[i] = s.device;
+            if (timestamp_ns) timestamp_ns[i] = s.timestamp_ns;
+            if (voltage) voltage[i] = s.voltage;
+            if (current) current[i] = s.current;
+            if (status) status[i] = s.status;
+            if (output_enabled) output_enabled[i] = s.outputEnabled ? 1 : 0;
+            if (valid) valid[i] = s.valid ? 1 : 0;
+        });
+    });
+}
+
+uint64_t g30_sampler_dropped(const g30_sampler* sampler) {
+    return sampler ? sampler->ring->dropped() : 0;
+}
+
+// ==================== Sweeps and Ramps ====================
+
+g30_status g30_sweep_grid(g30_device* const* devices, size_t count,
+                          double v_start, double v_stop, int v_points,
+                          double i_start, double i_stop, int i_points,
+                          int settle_ms, g30_sweep_result** out) {
+    G30_CHECK_OUT(out);
+    *out = nullptr;
+    std::vector<TDKLambdaG30*> supplies;
+    if (!collectDevices(devices, count, supplies)) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Invalid device list");
+    }
+    if (v_points < 1 || i_points < 1 || settle_ms < 0) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Sweep needs at least one point per axis and settle_ms >= 0");
+    }
+    for (auto* psu : supplies) {
+        if (!psu->isConnected()) {
+            return fail(G30_ERR_NOT_CONNECTED, "Not connected to device");
+        }
+        G30_CHECK_STATUS(checkRange("Sweep voltage", std::max(v_start, v_stop), psu->getMaxVoltage()));
+        G30_CHECK_STATUS(checkRange("Sweep voltage", std::min(v_start, v_stop), psu->getMaxVoltage()));
+        G30_CHECK_STATUS(checkRange("Sweep current", std::max(i_start, i_stop), psu->getMaxCurrent()));
+        G30_CHECK_STATUS(checkRange("Sweep current", std::min(i_start, i_stop), psu->getMaxCurrent()));
+    }
+    return guarded([&]() {
+        SweepConfig config;
+        config.settle_ms = settle_ms;
+        SweepEngine engine(supplies, config);
+        SweepPlan plan = SweepPlan::grid(SweepAxis(v_start, v_stop, v_points),
+                                         SweepAxis(i_start, i_stop, i_points));
+        std::unique_ptr<g30_sweep_result> result(new g30_sweep_result());
+        result->table = engine.run(plan);
+        *out = result.release();
+    });
+}
+
+size_t g30_sweep_result_size(const g30_sweep_result* result) {
+    return result ? result->table.size() : 0;
+}
+
+g30_status g30_sweep_result_copy(const g30_sweep_result* result, size_t capacity,
+                                 uint32_t* device, double* set_voltage, double* set_current,
+                                 double* meas_voltage, double* meas_current, double* time_ms) {
+    G30_CHECK_HANDLE(result);
+    const SweepTable& t = result->table;
+    size_t n = std::min(capacity, t.size());
+    for (size_t i = 0; i < n; ++i) {
+        if (device) device[i] = static_cast<uint32_t>(t.device[i]);
+    }
+    if (set_voltage) std::memcpy(set_voltage, t.setVoltage.data(), n * sizeof(double));
+    if (set_current) std::memcpy(set_current, t.setCurrent.data(), n * sizeof(double));
+    if (meas_voltage) std::memcpy(meas_voltage, t.measVoltage.data(), n * sizeof(double));
+    if (meas_current) std::memcpy(meas_current, t.measCurrent.data(), n * sizeof(double));
+    if (time_ms) std::memcpy(time_ms, t.time_ms.data(), n * sizeof(double));
+
+    if (n < t.size()) {
+        return fail(G30_ERR_BUFFER_TOO_SMALL, "Sweep result has " + std::to_string(t.size()) + " rows");
+    }
+    return G30_OK;
+}
+
+void g30_sweep_result_free(g30_sweep_result* result) {
+    delete result;
+}
+
+g30_status g30_ramp_voltage(g30_device* const* devices, size_t count, const double* targets,
+                            double ramp_rate, int step_interval_ms,
+                            double* max_skew_ms, double* max_tracking_error) {
+    std::vector<TDKLambdaG30*> supplies;
+    if (!collectDevices(devices, count, supplies) || !targets) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Invalid device list or targets");
+    }
+    if (!(ramp_rate > 0) || step_interval_ms <= 0) {
+        return fail(G30_ERR_INVALID_ARGUMENT, "Ramp rate and step interval must be positive");
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!supplies[i]->isConnected()) {
+            return fail(G30_ERR_NOT_CONNECTED, "Not connected to device");
+        }
+        G30_CHECK_STATUS(checkRange("Target", targets[i], supplies[i]->getMaxVoltage()));
+    }
+    return guarded([&]() {
+        SyncRampConfig config;
+        config.stepInterval_ms = step_interval_ms;
+        SynchronizedRamp ramp(supplies, config);
+        SyncRampResult r = ramp.rampVoltage(std::vector<double>(targets, targets + count), ramp_rate);
+        if (max_skew_ms) {
+            *max_skew_ms = r.maxSkew_ms;
+        }
+        if (max_tracking_error) {
+            *max_tracking_error = r.maxTrackingError;
+        }
+    });
+}
+
+} // extern "C"
@@ -0,0 +1,331 @@
+/**
+ * @file g30_capture.cpp
+ * @brief Implementation of triggered transient capture
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_capture.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace TDKLambda {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double signalValue(TriggerSignal signal, const TelemetrySample& sample) {
+    switch (signal) {
+        case TriggerSignal::CURRENT: return sample.current;
+        case TriggerSignal::POWER:   return sample.power;
+        default:                     return sample.voltage;
+    }
+}
+
+const char* signalName(TriggerSignal signal) {
+    switch (signal) {
+        case TriggerSignal::CURRENT: return "Current";
+        case TriggerSignal::POWER:   return "Power";
+        default:                     return "Voltage";
+    }
+}
+
+const char* signalUnit(TriggerSignal signal) {
+    switch (signal) {
+        case TriggerSignal::CURRENT: return "A";
+        case TriggerSignal::POWER:   return "W";
+        default:                     return "V";
+    }
+}
+
+} // namespace
+
+// ==================== CaptureTrigger ====================
+
+CaptureTrigger CaptureTrigger::levelCrossing(TriggerSignal signal, double level, TriggerEdge edge) {
+    CaptureTrigger t;
+    t.type = TriggerType::LEVEL;
+    t.signal = signal;
+    t.level = level;
+    t.edge = edge;
+    return t;
+}
+
+CaptureTrigger CaptureTrigger::slope(TriggerSignal signal, double ratePerSecond, TriggerEdge edge) {
+    CaptureTrigger t;
+    t.type = TriggerType::SLOPE;
+    t.signal = signal;
+    t.rate_per_s = ratePerSecond;
+    t.edge = edge;
+    return t;
+}
+
+CaptureTrigger CaptureTrigger::statusBits(uint32_t mask) {
+    CaptureTrigger t;
+    t.type = TriggerType::STATUS;
+    t.statusMask = mask;
+    return t;
+}
+
+// ==================== TransientCapture ====================
+
+TransientCapture::TransientCapture(TDKLambdaG30* supply, const CaptureTrigger& trigger,
+                                   const CaptureConfig& config)
+    : supply_(supply),
+      trigger_(trigger),
+      config_(config),
+      running_(false),
+      armed_(true),
+      force_(false),
+      samples_(0),
+      errors_(0),
+      dropped_(0),
+      rate_mHz_(0) {
+
+    if (!supply_) {
+        throw G30Exception("Transient capture needs a supply");
+    }
+    if (config_.maxRate_Hz < 0 || config_.maxRecords == 0) {
+        throw G30Exception("Invalid capture rate or record limit");
+    }
+    if (trigger_.type == TriggerType::STATUS && (!config_.readStatus || trigger_.statusMask == 0)) {
+        throw G30Exception("Status trigger needs readStatus and a non-empty mask");
+    }
+    if (trigger_.type == TriggerType::SLOPE && trigger_.rate_per_s <= 0) {
+        throw G30Exception("Slope trigger rate must be positive");
+    }
+}
+
+TransientCapture::~TransientCapture() {
+    stop();
+}
+
+void TransientCapture::setRecordCallback(std::function<void(const CaptureRecord&)> callback) {
+    if (running_) {
+        throw G30Exception("Cannot change the capture callback while capturing");
+    }
+    callback_ = callback;
+}
+
+void TransientCapture::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    samples_ = 0;
+    errors_ = 0;
+    thread_ = std::thread(&TransientCapture::captureLoop, this);
+}
+
+void TransientCapture::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void TransientCapture::arm() {
+    armed_ = true;
+}
+
+void TransientCapture::forceTrigger() {
+    armed_ = true;
+    force_ = true;
+}
+
+bool TransientCapture::waitForRecord(CaptureRecord& record, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(recordMutex_);
+    if (!recordCv_.wait_for(lock, std::chrono::milliseconds(std::max(timeout_ms, 0)),
+                            [this]() { return !records_.empty(); })) {
+        return false;
+    }
+    record = std::move(records_.front());
+    records_.pop_front();
+    return true;
+}
+
+size_t TransientCapture::pendingRecords() const {
+    std::lock_guard<std::mutex> lock(recordMutex_);
+    return records_.size();
+}
+
+double TransientCapture::sampleRate() const {
+    return rate_mHz_.load() / 1000.0;
+}
+
+void TransientCapture::captureLoop() {
+    const std::vector<std::string> queries = config_.readStatus
+        ? std::vector<std::string>{"MEAS:VOLT?", "MEAS:CURR?", "STAT:QUES?"}
+        : std::vector<std::string>{"MEAS:VOLT?", "MEAS:CURR?"};
+    const auto minInterval = config_.maxRate_Hz > 0
+        ? std::chrono::nanoseconds(1000000000LL / config_.maxRate_Hz)
+        : std::chrono::nanoseconds(0);
+
+    // Pre-trigger ring; its size is fixed, so memory does not grow while armed
+    std::vector<TelemetrySample> ring(config_.preTrigger);
+    size_t head = 0;
+    size_t filled = 0;
+
+    TelemetrySample previous;
+    bool havePrevious = false;
+    bool collecting = false;
+    CaptureRecord record;
+    uint64_t nextId = 1;
+    uint64_t sequence = 0;
+
+    auto next = Clock::now();
+    auto windowStart = next;
+    uint64_t windowSamples = 0;
+
+    while (running_) {
+        if (minInterval.count() > 0) {
+            std::this_thread::sleep_until(next);
+            next += minInterval;
+            auto now = Clock::now();
+            if (next < now) {
+                next = now;
+            }
+        }
+
+        TelemetrySample sample;
+        sample.sequence = sequence++;
+        try {
+            std::vector<std::string> r = supply_->sendQueries(queries);
+            sample.voltage = std::stod(r[0]);
+            sample.current = std::stod(r[1]);
+            sample.power = sample.voltage * sample.current;
+            if (config_.readStatus) {
+                sample.status = static_cast<uint32_t>(std::stod(r[2]));
+            }
+            sample.valid = true;
+        } catch (const std::exception&) {
+            ++errors_;
+            havePrevious = false;
+            // A dead link fails fast (circuit breaker); do not spin on it
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        auto now = Clock::now();
+        sample.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now.time_since_epoch()).count();
+        ++samples_;
+
+        ++windowSamples;
+        double window_s = std::chrono::duration<double>(now - windowStart).count();
+        if (window_s >= 1.0) {
+            rate_mHz_ = static_cast<uint64_t>(windowSamples * 1000.0 / window_s);
+            windowStart = now;
+            windowSamples = 0;
+        }
+
+        if (collecting) {
+            record.samples.push_back(sample);
+        } else if (armed_) {
+            std::string reason;
+            if (force_.exchange(false)) {
+                reason = "Forced";
+            }
+            if (!reason.empty() || (havePrevious && triggered(previous, sample, reason))) {
+                record = CaptureRecord();
+                record.id = nextId++;
+                record.reason = reason;
+                record.triggerTimestamp_ns = sample.timestamp_ns;
+                record.samples.reserve(filled + 1 + config_.postTrigger);
+                for (size_t i = 0; i < filled; ++i) {
+                    record.samples.push_back(ring[(head + ring.size() - filled + i) % ring.size()]);
+                }
+                record.triggerIndex = record.samples.size();
+                record.samples.push_back(sample);
+                collecting = true;
+            }
+        }
+
+        if (collecting && record.samples.size() >= record.triggerIndex + 1 + config_.postTrigger) {
+            const TelemetrySample& first = record.samples.front();
+            const TelemetrySample& last = record.samples.back();
+            if (record.samples.size() > 1 && last.timestamp_ns > first.timestamp_ns) {
+                record.sampleRate_Hz = (record.samples.size() - 1) * 1e9 /
+                                       static_cast<double>(last.timestamp_ns - first.timestamp_ns);
+            }
+            collecting = false;
+            if (!config_.rearm) {
+                armed_ = false;
+            }
+            publish(std::move(record));
+        }
+
+        if (!ring.empty()) {
+            ring[head] = sample;
+            head = (head + 1) % ring.size();
+            filled = std::min(filled + 1, ring.size());
+        }
+        previous = sample;
+        havePrevious = true;
+    }
+}
+
+bool TransientCapture::triggered(const TelemetrySample& previous, const TelemetrySample& current,
+                                 std::string& reason) const {
+    char text[96];
+
+    if (trigger_.type == TriggerType::STATUS) {
+        uint32_t raised = current.status & ~previous.status & trigger_.statusMask;
+        if (raised == 0) {
+            return false;
+        }
+        std::snprintf(text, sizeof(text), "Status bits 0x%02x set", raised);
+        reason = text;
+        return true;
+    }
+
+    double before = signalValue(trigger_.signal, previous);
+    double after = signalValue(trigger_.signal, current);
+    bool rising = trigger_.edge != TriggerEdge::FALLING;
+    bool falling = trigger_.edge != TriggerEdge::RISING;
+
+    if (trigger_.type == TriggerType::LEVEL) {
+        if (rising && before < trigger_.level && after >= trigger_.level) {
+            std::snprintf(text, sizeof(text), "%s rose above %.3f %s",
+                          signalName(trigger_.signal), trigger_.level, signalUnit(trigger_.signal));
+        } else if (falling && before > trigger_.level && after <= trigger_.level) {
+            std::snprintf(text, sizeof(text), "%s fell below %.3f %s",
+                          signalName(trigger_.signal), trigger_.level, signalUnit(trigger_.signal));
+        } else {
+            return false;
+        }
+        reason = text;
+        return true;
+    }
+
+    double dt = (current.timestamp_ns - previous.timestamp_ns) / 1e9;
+    if (dt <= 0) {
+        return false;
+    }
+    double rate = (after - before) / dt;
+    if ((rising && rate >= trigger_.rate_per_s) || (falling && rate <= -trigger_.rate_per_s)) {
+        std::snprintf(text, sizeof(text), "%s slope %.1f %s/s",
+                      signalName(trigger_.signal), rate, signalUnit(trigger_.signal));
+        reason = text;
+        return true;
+    }
+    return false;
+}
+
+void TransientCapture::publish(CaptureRecord&& record) {
+    if (callback_) {
+        callback_(record);
+    }
+    {
+        std::lock_guard<std::mutex> lock(recordMutex_);
+        if (records_.size() >= config_.maxRecords) {
+            records_.pop_front();
+            ++dropped_;
+        }
+        records_.push_back(std::move(record));
+    }
+    recordCv_.notify_one();
+}
+
+} // namespace TDKLambda
@@ -0,0 +1,124 @@
+/**
+ * @file g30_clock.cpp
+ * @brief Implementation of the system and virtual clocks
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_clock.h"
+#include <algorithm>
+#include <thread>
+
+namespace TDKLambda {
+
+// ==================== SystemClock ====================
+
+SystemClock& SystemClock::instance() {
+    static SystemClock clock;
+    return clock;
+}
+
+IClock::TimePoint SystemClock::now() const {
+    return std::chrono::steady_clock::now();
+}
+
+void SystemClock::sleepUntil(TimePoint deadline) {
+    std::this_thread::sleep_until(deadline);
+}
+
+// ==================== VirtualClock ====================
+
+VirtualClock::VirtualClock(bool autoAdvance, TimePoint start)
+    : now_(start),
+      holds_(0),
+      autoAdvance_(autoAdvance),
+      sleeps_(0) {
+}
+
+IClock::TimePoint VirtualClock::now() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return now_;
+}
+
+void VirtualClock::sleepUntil(TimePoint deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (deadline <= now_) {
+        return;
+    }
+    ++sleeps_;
+    auto entry = deadlines_.insert(deadline);
+    cv_.notify_all();
+    autoAdvanceLocked();
+    cv_.wait(lock, [this, deadline]() { return now_ >= deadline; });
+    deadlines_.erase(entry);
+}
+
+void VirtualClock::hold() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++holds_;
+}
+
+void VirtualClock::release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (holds_ > 0) {
+        --holds_;
+    }
+    autoAdvanceLocked();
+}
+
+void VirtualClock::advance(std::chrono::nanoseconds duration) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (duration.count() > 0) {
+        now_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration);
+        cv_.notify_all();
+    }
+}
+
+void VirtualClock::advanceTo(TimePoint time) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (time > now_) {
+        now_ = time;
+        cv_.notify_all();
+    }
+}
+
+void VirtualClock::setAutoAdvance(bool enable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    autoAdvance_ = enable;
+    autoAdvanceLocked();
+}
+
+size_t VirtualClock::sleepers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<size_t>(std::count_if(deadlines_.begin(), deadlines_.end(),
+                                              [this](TimePoint d) { return d > now_; }));
+}
+
+bool VirtualClock::waitForSleepers(size_t count, int timeout_ms) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, std::chrono::milliseconds(std::max(timeout_ms, 0)), [this, count]() {
+        return static_cast<size_t>(std::count_if(deadlines_.begin(), deadlines_.end(),
+                                                 [this](TimePoint d) { return d > now_; })) >= count;
+    });
+}
+
+uint64_t VirtualClock::sleepCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sleeps_;
+}
+
+void VirtualClock::autoAdvanceLocked() {
+    // Woken sleepers that have not run yet keep their (passed) deadline in
+    // the set; it is then the minimum, so the jump below is a no-op until
+    // they sleep again or release their hold
+    if (!autoAdvance_ || deadlines_.empty() || deadlines_.size() < holds_) {
+        return;
+    }
+    TimePoint earliest = *deadlines_.begin();
+    if (earliest > now_) {
+        now_ = earliest;
+        cv_.notify_all();
+    }
+}
+
+} // namespace TDKLambda
@@ -0,0 +1,343 @@
+/**
+ * @file g30_coro.cpp
+ * @brief Implementation of the coroutine event loop and AsyncG30
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_coro.h"
+#include <cmath>
+#include <cstring>
+
+// Linux/POSIX includes
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace TDKLambda {
+
+// ==================== DetachedTask ====================
+
+/**
+ * @brief Fire-and-forget coroutine owning a spawned sequence
+ */
+class DetachedTask {
+public:
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept {}
+    };
+
+    static DetachedTask start(EventLoop& loop, Task<void> task) {
+        std::exception_ptr error;
+        try {
+            co_await task;
+        } catch (...) {
+            error = std::current_exception();
+        }
+        loop.taskFinished(error);
+    }
+};
+
+// ==================== EventLoop ====================
+
+EventLoop::EventLoop(size_t workerThreads, size_t laneThreads)
+    : epollFd_(-1),
+      eventFd_(-1),
+      timerFd_(-1),
+      stopRequested_(false),
+      active_(0),
+      workersStopping_(false),
+      lanesStopping_(false),
+      maxLaneThreads_(laneThreads == 0 ? 1 : laneThreads) {
+
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    eventFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epollFd_ < 0 || eventFd_ < 0 || timerFd_ < 0) {
+        if (epollFd_ >= 0) ::close(epollFd_);
+        if (eventFd_ >= 0) ::close(eventFd_);
+        if (timerFd_ >= 0) ::close(timerFd_);
+        throw G30Exception("Failed to create event loop descriptors");
+    }
+
+    epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = eventFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, eventFd_, &ev);
+    ev.data.fd = timerFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, timerFd_, &ev);
+
+    if (workerThreads == 0) {
+        workerThreads = 1;
+    }
+    for (size_t i = 0; i < workerThreads; ++i) {
+        workers_.emplace_back(&EventLoop::workerLoop, this);
+    }
+}
+
+EventLoop::~EventLoop() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        workersStopping_ = true;
+    }
+    jobCv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(laneMutex_);
+        lanesStopping_ = true;
+    }
+    laneCv_.notify_all();
+    for (auto& thread : laneThreads_) {
+        thread.join();
+    }
+
+    ::close(timerFd_);
+    ::close(eventFd_);
+    ::close(epollFd_);
+}
+
+void EventLoop::spawn(Task<void> task) {
+    ++active_;
+    // Runs up to its first suspension point right away, on the calling thread
+    DetachedTask::start(*this, std::move(task));
+}
+
+void EventLoop::run() {
+    stopRequested_ = false;
+
+    while (!stopRequested_ && active_ > 0) {
+        epoll_event events[4];
+        int n = epoll_wait(epollFd_, events, 4, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw G30Exception("epoll_wait failed: " + std::string(std::strerror(errno)));
+        }
+
+        for (int i = 0; i < n; ++i) {
+            uint64_t count;
+            if (::read(events[i].data.fd, &count, sizeof(count)) < 0) {
+                // Spurious wakeup, nothing to drain
+            }
+        }
+
+        // Expired timers
+        auto now = std::chrono::steady_clock::now();
+        while (!timers_.empty() && timers_.top().deadline <= now) {
+            std::coroutine_handle<> h = timers_.top().handle;
+            timers_.pop();
+            h.resume();
+        }
+
+        // Coroutines whose blocking calls completed
+        std::vector<std::coroutine_handle<>> ready;
+        {
+            std::lock_guard<std::mutex> lock(readyMutex_);
+            ready.swap(ready_);
+        }
+        for (auto h : ready) {
+            h.resume();
+        }
+
+        armTimer();
+    }
+}
+
+void EventLoop::stop() {
+    stopRequested_ = true;
+    wake();
+}
+
+void EventLoop::setErrorHandler(std::function<void(const std::string&)> handler) {
+    errorHandler_ = handler;
+}
+
+void EventLoop::post(std::coroutine_handle<> handle) {
+    std::lock_guard<std::mutex> lock(readyMutex_);
+    ready_.push_back(handle);
+    wake();
+}
+
+void EventLoop::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex_);
+        jobs_.push_back(std::move(job));
+    }
+    jobCv_.notify_one();
+}
+
+size_t EventLoop::addLane() {
+    std::lock_guard<std::mutex> lock(laneMutex_);
+    if (laneThreads_.size() < maxLaneThreads_) {
+        laneThreads_.emplace_back(&EventLoop::laneLoop, this);
+    }
+    lanes_.emplace_back(new Lane());
+    return lanes_.size() - 1;
+}
+
+void EventLoop::submit(std::function<void()> job, size_t lane) {
+    if (lane == kSharedPool) {
+        submit(std::move(job));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(laneMutex_);
+        if (lane >= lanes_.size()) {
+            throw G30Exception("Unknown event loop lane " + std::to_string(lane));
+        }
+        Lane* target = lanes_[lane].get();
+        target->jobs.push_back(std::move(job));
+        if (target->scheduled) {
+            return;     // Runs after the lane's current job
+        }
+        target->scheduled = true;
+        readyLanes_.push_back(target);
+    }
+    laneCv_.notify_one();
+}
+
+void EventLoop::addTimer(std::chrono::steady_clock::time_point deadline, std::coroutine_handle<> handle) {
+    timers_.push(Timer{deadline, handle});
+    armTimer();
+}
+
+void EventLoop::armTimer() {
+    itimerspec spec;
+    std::memset(&spec, 0, sizeof(spec));
+
+    if (!timers_.empty()) {
+        auto delta = timers_.top().deadline - std::chrono::steady_clock::now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(delta).count();
+        if (ns < 1) {
+            ns = 1;     // Already due: fire immediately (zero would disarm)
+        }
+        spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+    }
+    timerfd_settime(timerFd_, 0, &spec, nullptr);
+}
+
+void EventLoop::wake() {
+    uint64_t one = 1;
+    if (::write(eventFd_, &one, sizeof(one)) < 0) {
+        // Counter saturated: the loop is already due to wake up
+    }
+}
+
+void EventLoop::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex_);
+            jobCv_.wait(lock, [this]() { return workersStopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        job();
+    }
+}
+
+void EventLoop::laneLoop() {
+    std::unique_lock<std::mutex> lock(laneMutex_);
+    while (true) {
+        laneCv_.wait(lock, [this]() { return lanesStopping_ || !readyLanes_.empty(); });
+        if (readyLanes_.empty()) {
+            return;
+        }
+        // One job per turn: a lane stays off readyLanes_ while its job runs,
+        // which keeps its jobs in order, and rejoins at the back afterwards
+        Lane* lane = readyLanes_.front();
+        readyLanes_.pop_front();
+        std::function<void()> job = std::move(lane->jobs.front());
+        lane->jobs.pop_front();
+
+        lock.unlock();
+        job();
+        lock.lock();
+
+        if (lane->jobs.empty()) {
+            lane->scheduled = false;
+        } else {
+            readyLanes_.push_back(lane);
+        }
+    }
+}
+
+void EventLoop::taskFinished(std::exception_ptr error) {
+    --active_;
+    if (error && errorHandler_) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            errorHandler_(e.what());
+        } catch (...) {
+            errorHandler_("Unknown exception in coroutine sequence");
+        }
+    }
+}
+
+// ==================== AsyncG30 ====================
+
+AsyncG30::AsyncG30(EventLoop& loop, TDKLambdaG30& psu)
+    : loop_(loop),
+      psu_(psu),
+      lane_(loop.addLane()) {
+}
+
+Task<double> AsyncG30::measureVoltage() {
+    co_return co_await loop_.blocking<double>([this]() { return psu_.measureVoltage(); }, lane_);
+}
+
+Task<double> AsyncG30::measureCurrent() {
+    co_return co_await loop_.blocking<double>([this]() { return psu_.measureCurrent(); }, lane_);
+}
+
+Task<void> AsyncG30::setVoltage(double voltage) {
+    co_await loop_.blocking<bool>([this, voltage]() { psu_.setVoltage(voltage); return true; }, lane_);
+}
+
+Task<void> AsyncG30::setCurrent(double current) {
+    co_await loop_.blocking<bool>([this, current]() { psu_.setCurrent(current); return true; }, lane_);
+}
+
+Task<void> AsyncG30::enableOutput(bool enable) {
+    co_await loop_.blocking<bool>([this, enable]() { psu_.enableOutput(enable); return true; }, lane_);
+}
+
+Task<std::string> AsyncG30::query(std::string query) {
+    // By reference: the frame outlives the call, and GCC 12 frees a string
+    // captured by value in an awaited temporary from the wrong address
+    co_return co_await loop_.blocking<std::string>([this, &query]() { return psu_.sendQuery(query); }, lane_);
+}
+
+Task<double> AsyncG30::waitUntilSettled(double target, double tolerance, int timeout_ms, int poll_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    while (true) {
+        double v = co_await measureVoltage();
+        if (std::abs(v - target) <= tolerance) {
+            co_return v;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            throw G30Exception("Output did not settle at " + std::to_string(target) +
+                             "V within " + std::to_string(timeout_ms) + " ms (last " +
+                             std::to_string(v) + "V)");
+        }
+        co_await loop_.sleepFor(poll_ms);
+    }
+}
+
+} // namespace TDKLambda
@@ -0,0 +1,409 @@
+/**
+ * @file g30_current_share.cpp
+ * @brief Implementation of the current sharing controller
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_current_share.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <future>
+
+namespace TDKLambda {
+
+namespace {
+
+/**
+ * Run task(u) for every listed unit, one thread per unit, and wait for
+ * all of them. Returns the failure message per listed unit (empty if ok).
+ */
+template <typename Task>
+std::vector<std::string> runOnUnits(const std::vector<size_t>& units, const Task& task) {
+    std::vector<std::future<void>> work;
+    std::vector<std::string> failures(units.size());
+    work.reserve(units.size());
+    for (size_t i = 0; i < units.size(); ++i) {
+        size_t unit = units[i];
+        std::string* failure = &failures[i];
+        work.push_back(std::async(std::launch::async, [&task, unit, failure]() {
+            try {
+                task(unit);
+            } catch (const std::exception& e) {
+                *failure = e.what();
+            }
+        }));
+    }
+    for (auto& w : work) {
+        w.get();
+    }
+    return failures;
+}
+
+std::string formatVoltage(double voltage) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "VOLT %.3f", voltage);
+    return buffer;
+}
+
+} // namespace
+
+CurrentSharingController::CurrentSharingController(const std::vector<TDKLambdaG30*>& supplies,
+                                                   const CurrentShareConfig& config)
+    : supplies_(supplies),
+      config_(config),
+      running_(false),
+      active_(supplies.size(), true),
+      trims_(supplies.size(), 0.0),
+      failures_(supplies.size(), 0),
+      voltage_(0.0),
+      totalCurrent_(0.0),
+      unitLimit_(0.0),
+      outputEnabled_(false) {
+
+    if (supplies_.empty()) {
+        throw G30Exception("Current sharing needs at least one supply");
+    }
+    for (auto* psu : supplies_) {
+        if (!psu) {
+            throw G30Exception("Current sharing supply list contains null");
+        }
+    }
+    if (config_.period_ms <= 0 || config_.failuresBeforeDrop <= 0) {
+        throw G30Exception("Sharing period and failure count must be positive");
+    }
+    if (config_.tolerance <= 0 || config_.trimGain_VperA < 0 || config_.maxTrim_V < 0) {
+        throw G30Exception("Invalid current sharing tolerance or trim settings");
+    }
+}
+
+CurrentSharingController::~CurrentSharingController() {
+    stop();
+}
+
+void CurrentSharingController::setEventCallback(
+        std::function<void(size_t, ShareEvent, const std::string&)> callback) {
+    if (running_) {
+        throw G30Exception("Cannot change the sharing callback while running");
+    }
+    callback_ = callback;
+}
+
+void CurrentSharingController::setOutput(double voltage, double totalCurrent) {
+    double maxVoltage = supplies_.front()->getMaxVoltage();
+    for (auto* psu : supplies_) {
+        maxVoltage = std::min(maxVoltage, psu->getMaxVoltage());
+    }
+    if (voltage < 0 || voltage > maxVoltage) {
+        throw G30Exception("Voltage " + std::to_string(voltage) + "V out of range for the paralleled units");
+    }
+    if (totalCurrent < 0) {
+        throw G30Exception("Total current must not be negative");
+    }
+
+    std::vector<PendingEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex_);
+        std::vector<size_t> units;
+        for (size_t u = 0; u < supplies_.size(); ++u) {
+            if (active_[u]) {
+                units.push_back(u);
+            }
+        }
+        if (units.empty()) {
+            throw G30Exception("No paralleled unit is active");
+        }
+
+        voltage_ = voltage;
+        totalCurrent_ = totalCurrent;
+        std::fill(trims_.begin(), trims_.end(), 0.0);
+
+        std::vector<std::string> failures = runOnUnits(units, [this, voltage](size_t u) {
+            supplies_[u]->setVoltage(voltage);
+        });
+        for (size_t i = 0; i < units.size(); ++i) {
+            if (!failures[i].empty()) {
+                throw G30Exception("Unit " + std::to_string(units[i]) + " failed: " + failures[i]);
+            }
+        }
+        distributeLimit();
+        events.swap(pending_);
+    }
+    for (const auto& e : events) {
+        notify(e.unit, e.event, e.detail);
+    }
+}
+
+void CurrentSharingController::enableOutput(bool enable) {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    std::vector<size_t> units;
+    for (size_t u = 0; u < supplies_.size(); ++u) {
+        if (active_[u]) {
+            units.push_back(u);
+        }
+    }
+
+    std::vector<std::string> failures = runOnUnits(units, [this, enable](size_t u) {
+        supplies_[u]->enableOutput(enable);
+    });
+    outputEnabled_ = enable;
+    for (size_t i = 0; i < units.size(); ++i) {
+        if (!failures[i].empty()) {
+            throw G30Exception("Unit " + std::to_string(units[i]) + " failed: " + failures[i]);
+        }
+    }
+}
+
+ShareReport CurrentSharingController::step() {
+    std::unique_lock<std::mutex> lock(controlMutex_);
+    const size_t n = supplies_.size();
+
+    ShareReport report;
+    report.voltages.assign(n, 0.0);
+    report.currents.assign(n, 0.0);
+    report.active = active_;
+
+    std::vector<size_t> units;
+    for (size_t u = 0; u < n; ++u) {
+        if (active_[u]) {
+            units.push_back(u);
+        }
+    }
+
+    // One pipelined round trip per unit, all units at once
+    std::vector<uint32_t> status(n, 0);
+    std::vector<std::string> failures = runOnUnits(units, [this, &report, &status](size_t u) {
+        std::vector<std::string> r = supplies_[u]->sendQueries({"MEAS:VOLT?", "MEAS:CURR?", "STAT:QUES?"});
+        report.voltages[u] = std::stod(r[0]);
+        report.currents[u] = std::stod(r[1]);
+        status[u] = static_cast<uint32_t>(std::stod(r[2]));
+    });
+
+    std::vector<size_t> measured;
+    bool dropped = false;
+    for (size_t i = 0; i < units.size(); ++i) {
+        size_t u = units[i];
+        if (!failures[i].empty()) {
+            report.voltages[u] = 0.0;
+            report.currents[u] = 0.0;
+            if (++failures_[u] >= config_.failuresBeforeDrop) {
+                dropUnit(u, ShareEvent::UNIT_LOST, failures[i]);
+                dropped = true;
+            }
+            continue;
+        }
+        failures_[u] = 0;
+
+        if (status[u] & config_.tripMask) {
+            char detail[64];
+            std::snprintf(detail, sizeof(detail), "Protection tripped (status 0x%02x)", status[u]);
+            dropUnit(u, ShareEvent::UNIT_TRIPPED, detail);
+            dropped = true;
+            continue;
+        }
+        measured.push_back(u);
+    }
+
+    if (dropped) {
+        distributeLimit();
+        measured.erase(std::remove_if(measured.begin(), measured.end(),
+                                      [this](size_t u) { return !active_[u]; }),
+                       measured.end());
+    }
+
+    for (size_t u : measured) {
+        report.totalCurrent += report.currents[u];
+    }
+
+    // Share errors are only meaningful with real load current on the units
+    if (measured.size() > 1) {
+        double mean = report.totalCurrent / measured.size();
+        if (mean >= config_.minShareCurrent_A) {
+            for (size_t u : measured) {
+                report.imbalance = std::max(report.imbalance, std::abs(report.currents[u] - mean) / mean);
+            }
+            report.balanced = report.imbalance <= config_.tolerance;
+        }
+
+        if (!report.balanced && outputEnabled_) {
+            std::vector<size_t> changed;
+            std::vector<std::string> commands(n);
+            for (size_t u : measured) {
+                double trim = trims_[u] - config_.trimGain_VperA * (report.currents[u] - mean);
+                trim = std::max(-config_.maxTrim_V, std::min(config_.maxTrim_V, trim));
+                double setpoint = std::max(0.0, std::min(supplies_[u]->getMaxVoltage(), voltage_ + trim));
+                commands[u] = formatVoltage(setpoint);
+                if (commands[u] != formatVoltage(voltage_ + trims_[u])) {
+                    changed.push_back(u);
+                }
+                trims_[u] = trim;
+            }
+
+            std::vector<std::string> trimFailures = runOnUnits(changed, [this, &commands](size_t u) {
+                supplies_[u]->sendBatch({commands[u]});
+            });
+            for (size_t i = 0; i < changed.size(); ++i) {
+                if (!trimFailures[i].empty()) {
+                    ++failures_[changed[i]];
+                }
+            }
+            report.trimmed = !changed.empty();
+        }
+    }
+
+    report.trims = trims_;
+    report.active = active_;
+    report_ = report;
+
+    // Callbacks run without the lock so they may query the controller
+    std::vector<PendingEvent> events;
+    events.swap(pending_);
+    lock.unlock();
+    for (const auto& e : events) {
+        notify(e.unit, e.event, e.detail);
+    }
+    return report;
+}
+
+void CurrentSharingController::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    thread_ = std::thread(&CurrentSharingController::controlLoop, this);
+}
+
+void CurrentSharingController::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        running_ = false;
+    }
+    stopCv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void CurrentSharingController::restoreUnit(size_t unit) {
+    if (unit >= supplies_.size()) {
+        throw G30Exception("Sharing unit index out of range");
+    }
+
+    std::vector<PendingEvent> events;
+    {
+        std::lock_guard<std::mutex> lock(controlMutex_);
+        if (active_[unit]) {
+            return;
+        }
+
+        TDKLambdaG30* psu = supplies_[unit];
+        psu->clearProtection();
+        psu->setVoltage(voltage_);
+        active_[unit] = true;
+        failures_[unit] = 0;
+        trims_[unit] = 0.0;
+        distributeLimit();
+        if (outputEnabled_ && active_[unit]) {
+            psu->enableOutput(true);
+        }
+        pending_.push_back({unit, ShareEvent::UNIT_RESTORED, "Unit rejoined"});
+        events.swap(pending_);
+    }
+    for (const auto& e : events) {
+        notify(e.unit, e.event, e.detail);
+    }
+}
+
+ShareReport CurrentSharingController::lastReport() const {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    return report_;
+}
+
+size_t CurrentSharingController::activeUnits() const {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    return static_cast<size_t>(std::count(active_.begin(), active_.end(), true));
+}
+
+double CurrentSharingController::unitCurrentLimit() const {
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    return unitLimit_;
+}
+
+void CurrentSharingController::controlLoop() {
+    const auto period = std::chrono::milliseconds(config_.period_ms);
+    auto next = std::chrono::steady_clock::now();
+
+    while (running_) {
+        step();
+
+        next += period;
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            // A slow cycle restarts the schedule instead of bursting
+            next = now;
+        }
+        std::unique_lock<std::mutex> lock(stopMutex_);
+        stopCv_.wait_until(lock, next, [this]() { return !running_; });
+    }
+}
+
+void CurrentSharingController::dropUnit(size_t unit, ShareEvent event, const std::string& detail) {
+    active_[unit] = false;
+    trims_[unit] = 0.0;
+    failures_[unit] = 0;
+    try {
+        // Keep a faulted unit from fighting the others on the shared bus
+        supplies_[unit]->enableOutput(false);
+    } catch (const std::exception&) {
+    }
+    pending_.push_back({unit, event, detail});
+}
+
+void CurrentSharingController::distributeLimit() {
+    // Units that cannot take their new limit are dropped and the split redone
+    for (;;) {
+        std::vector<size_t> units;
+        double ratedCurrent = 0.0;
+        for (size_t u = 0; u < supplies_.size(); ++u) {
+            if (active_[u]) {
+                units.push_back(u);
+                ratedCurrent = (units.size() == 1) ? supplies_[u]->getMaxCurrent()
+                                                   : std::min(ratedCurrent, supplies_[u]->getMaxCurrent());
+            }
+        }
+        if (units.empty()) {
+            unitLimit_ = 0.0;
+            return;
+        }
+
+        double limit = totalCurrent_ / units.size();
+        if (limit > ratedCurrent) {
+            limit = ratedCurrent;
+            pending_.push_back({supplies_.size(), ShareEvent::CAPACITY_REDUCED,
+                                "Limit reduced to " + std::to_string(limit * units.size()) + "A"});
+        }
+
+        std::vector<std::string> failures = runOnUnits(units, [this, limit](size_t u) {
+            supplies_[u]->setCurrent(limit);
+        });
+        bool dropped = false;
+        for (size_t i = 0; i < units.size(); ++i) {
+            if (!failures[i].empty()) {
+                dropUnit(units[i], ShareEvent::UNIT_LOST, failures[i]);
+                dropped = true;
+            }
+        }
+        unitLimit_ = limit;
+        if (!dropped) {
+            return;
+        }
+    }
+}
+
+void CurrentSharingController::notify(size_t unit, ShareEvent event, const std::string& detail) {
+    if (callback_) {
+        callback_(unit, event, detail);
+    }
+}
+
+} // namespace TDKLambda
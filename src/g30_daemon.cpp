@@ -0,0 +1,725 @@
+/**
+ * @file g30_daemon.cpp
+ * @brief Implementation of the multiplexing daemon and its client
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_daemon.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+
+// Linux/POSIX includes
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace TDKLambda {
+
+using namespace DaemonProtocol;
+
+namespace {
+
+bool sendAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool recvAll(int fd, char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::recv(fd, data, length, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+/**
+ * @brief Check if a query may be merged with other clients' copies or cached
+ *
+ * Only queries without side effects qualify. SYST:ERR? pops the error
+ * queue, so two clients must never share one answer; anything not on the
+ * list is treated the same way. Compound queries qualify if every part does.
+ */
+bool isShareableQuery(const std::string& query) {
+    std::string text;
+    text.reserve(query.size());
+    for (char c : query) {
+        if (!std::isspace(static_cast<unsigned char>(c))) {
+            text += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+
+    static const char* const exact[] = {"OUTP?", "STAT:QUES?", "VOLT?", "CURR?", "VOLT:PROT?", "*IDN?"};
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(';', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string part = text.substr(start, end - start);
+        bool measurement = part.compare(0, 5, "MEAS:") == 0 && part.size() > 6 && part.back() == '?';
+        bool listed = std::find(std::begin(exact), std::end(exact), part) != std::end(exact);
+        if (!measurement && !listed) {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+sockaddr_un unixAddress(const std::string& path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw G30Exception("Socket path too long: " + path);
+    }
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+} // namespace
+
+// ==================== Internal State ====================
+
+struct G30Daemon::Client {
+    explicit Client(int socketFd, uint32_t clientId)
+        : fd(socketFd), id(clientId), open(true) {}
+
+    ~Client() {
+        // Closed only when no worker can still reply on this descriptor
+        ::close(fd);
+    }
+
+    int fd;                     ///< Non-blocking socket
+    uint32_t id;
+    std::atomic<bool> open;     ///< Cleared on error or queue overflow, the listener then drops the client
+    std::mutex txMutex;
+    std::string tx;             ///< Replies not yet written (guarded by txMutex)
+    std::string rx;
+
+    bool pendingOutput() {
+        std::lock_guard<std::mutex> lock(txMutex);
+        return !tx.empty();
+    }
+
+    /**
+     * @brief Write as much queued output as the socket takes without blocking
+     * @return false if the connection failed
+     */
+    bool flush() {
+        std::lock_guard<std::mutex> lock(txMutex);
+        size_t sent = 0;
+        while (sent < tx.size()) {
+            ssize_t n = ::send(fd, tx.data() + sent, tx.size() - sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                tx.clear();
+                return false;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        tx.erase(0, sent);
+        return true;
+    }
+};
+
+struct G30Daemon::Request {
+    std::shared_ptr<Client> client;
+    uint16_t type;
+    uint32_t requestId;
+    std::string payload;
+};
+
+struct G30Daemon::Device {
+    struct CacheEntry {
+        std::string response;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    std::string name;
+    std::unique_ptr<TDKLambdaG30> psu;
+    std::thread worker;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<uint32_t, std::deque<Request>> queues;   ///< Pending requests per client
+    uint32_t lastServed = 0;
+    std::map<std::string, CacheEntry> cache;
+};
+
+// ==================== G30Daemon ====================
+
+G30Daemon::G30Daemon(const DaemonConfig& config)
+    : config_(config),
+      running_(false),
+      listenFd_(-1),
+      wakePipe_{-1, -1},
+      requests_(0),
+      cacheHits_(0),
+      mergedQueries_(0),
+      roundTrips_(0),
+      clientCount_(0) {
+}
+
+G30Daemon::~G30Daemon() {
+    stop();
+}
+
+void G30Daemon::addDevice(const std::string& name, const G30Config& config) {
+    // The daemon shares a running supply; connecting must not reset its settings
+    G30Config shared = config;
+    shared.resetOnConnect = false;
+    addDevice(name, std::make_unique<TDKLambdaG30>(shared));
+}
+
+void G30Daemon::addDevice(const std::string& name, std::unique_ptr<TDKLambdaG30> psu) {
+    if (running_) {
+        throw G30Exception("Cannot add devices while the daemon is running");
+    }
+    if (!psu) {
+        throw G30Exception("Daemon device is null");
+    }
+    if (devices_.size() >= 0xFFFF) {
+        throw G30Exception("Too many daemon devices");
+    }
+
+    std::unique_ptr<Device> device(new Device());
+    device->name = name;
+    device->psu = std::move(psu);
+    devices_.push_back(std::move(device));
+}
+
+void G30Daemon::start() {
+    if (running_) {
+        return;
+    }
+
+    for (auto& device : devices_) {
+        if (!device->psu->isConnected()) {
+            device->psu->connect();
+        }
+    }
+
+    sockaddr_un addr = unixAddress(config_.socketPath);
+
+    // A socket file left by a crashed daemon refuses connections and may be
+    // replaced; one that accepts belongs to a live daemon and is left alone
+    int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        throw G30Exception("Failed to create daemon socket");
+    }
+    int probed = ::connect(probe, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    int probeError = errno;
+    ::close(probe);
+    if (probed == 0) {
+        throw G30Exception("Daemon socket " + config_.socketPath + " is in use by a running daemon");
+    }
+    if (probeError == ECONNREFUSED) {
+        ::unlink(config_.socketPath.c_str());
+    }
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        throw G30Exception("Failed to create daemon socket");
+    }
+    if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listenFd_, 64) < 0) {
+        ::close(listenFd_);
+        listenFd_ = -1;
+        throw G30Exception("Failed to bind daemon socket " + config_.socketPath + ": " +
+                         std::strerror(errno));
+    }
+    if (::pipe2(wakePipe_, O_NONBLOCK | O_CLOEXEC) < 0) {
+        ::close(listenFd_);
+        listenFd_ = -1;
+        throw G30Exception("Failed to create daemon wake pipe");
+    }
+
+    running_ = true;
+    for (auto& device : devices_) {
+        Device* d = device.get();
+        d->worker = std::thread([this, d]() { deviceLoop(*d); });
+    }
+    listener_ = std::thread(&G30Daemon::listenLoop, this);
+}
+
+void G30Daemon::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    char wake = 0;
+    if (::write(wakePipe_[1], &wake, 1) < 0) {
+        // Listener will still notice running_ on its next poll timeout
+    }
+    if (listener_.joinable()) {
+        listener_.join();
+    }
+
+    for (auto& device : devices_) {
+        {
+            std::lock_guard<std::mutex> lock(device->mutex);
+            device->queues.clear();
+        }
+        device->cv.notify_all();
+        if (device->worker.joinable()) {
+            device->worker.join();
+        }
+
+        // Leave the outputs as the clients set them (the destructor would switch them off)
+        device->psu->disconnect();
+    }
+
+    ::close(listenFd_);
+    ::close(wakePipe_[0]);
+    ::close(wakePipe_[1]);
+    listenFd_ = -1;
+    wakePipe_[0] = wakePipe_[1] = -1;
+    ::unlink(config_.socketPath.c_str());
+}
+
+DaemonStats G30Daemon::stats() const {
+    DaemonStats s;
+    s.requests = requests_.load();
+    s.cacheHits = cacheHits_.load();
+    s.mergedQueries = mergedQueries_.load();
+    s.deviceRoundTrips = roundTrips_.load();
+    s.clients = clientCount_.load();
+    return s;
+}
+
+void G30Daemon::listenLoop() {
+    std::vector<std::shared_ptr<Client>> clients;
+    uint32_t nextClientId = 1;
+
+    while (running_) {
+        std::vector<pollfd> fds;
+        fds.reserve(clients.size() + 2);
+        fds.push_back({wakePipe_[0], POLLIN, 0});
+        fds.push_back({listenFd_, POLLIN, 0});
+        for (auto& c : clients) {
+            short events = POLLIN;
+            if (c->pendingOutput()) {
+                events |= POLLOUT;
+            }
+            fds.push_back({c->fd, events, 0});
+        }
+
+        int ready = ::poll(fds.data(), fds.size(), 1000);
+        if (ready <= 0) {
+            continue;
+        }
+        if (fds[0].revents) {
+            // Woken by stop() or by a worker that queued a reply
+            char drain[64];
+            while (::read(wakePipe_[0], drain, sizeof(drain)) > 0) {
+            }
+            if (!running_) {
+                break;
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0) {
+                clients.push_back(std::make_shared<Client>(fd, nextClientId++));
+                ++clientCount_;
+            }
+        }
+
+        std::vector<std::shared_ptr<Client>> alive;
+        alive.reserve(clients.size());
+        for (size_t i = 0; i < clients.size(); ++i) {
+            std::shared_ptr<Client>& client = clients[i];
+            short revents = fds[i + 2].revents;
+            bool keep = client->open;
+
+            if (keep && (revents & (POLLIN | POLLHUP | POLLERR))) {
+                char buffer[4096];
+                ssize_t n = ::recv(client->fd, buffer, sizeof(buffer), 0);
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                    keep = false;
+                } else if (n > 0) {
+                    client->rx.append(buffer, static_cast<size_t>(n));
+
+                    // Dispatch every complete frame
+                    while (keep && client->rx.size() >= sizeof(FrameHeader)) {
+                        FrameHeader header;
+                        std::memcpy(&header, client->rx.data(), sizeof(header));
+                        if (header.length > kMaxPayload) {
+                            keep = false;
+                            break;
+                        }
+                        size_t frameSize = sizeof(header) + header.length;
+                        if (client->rx.size() < frameSize) {
+                            break;
+                        }
+                        std::string payload = client->rx.substr(sizeof(header), header.length);
+                        client->rx.erase(0, frameSize);
+                        keep = handleFrame(client, header, std::move(payload));
+                    }
+                }
+            }
+
+            // Write queued replies, including a final error before closing
+            if (!client->flush() || !client->open) {
+                keep = false;
+            }
+
+            if (keep) {
+                alive.push_back(std::move(client));
+            } else {
+                client->open = false;
+                ::shutdown(client->fd, SHUT_RDWR);
+                dropRequests(*client);
+            }
+        }
+        clients.swap(alive);
+    }
+
+    for (auto& client : clients) {
+        client->open = false;
+        ::shutdown(client->fd, SHUT_RDWR);
+    }
+}
+
+bool G30Daemon::handleFrame(const std::shared_ptr<Client>& client,
+                            const FrameHeader& header, std::string payload) {
+    ++requests_;
+
+    if (header.type == FRAME_LIST) {
+        std::string names;
+        for (auto& device : devices_) {
+            names += device->name;
+            names += '\n';
+        }
+        reply(*client, FRAME_RESPONSE, header.requestId, names);
+        return true;
+    }
+
+    if (header.type != FRAME_QUERY && header.type != FRAME_COMMAND) {
+        reply(*client, FRAME_ERROR, header.requestId, "Unknown frame type");
+        return false;
+    }
+    if (header.device >= devices_.size()) {
+        reply(*client, FRAME_ERROR, header.requestId,
+              "Unknown device " + std::to_string(header.device));
+        return true;
+    }
+
+    Device& device = *devices_[header.device];
+    std::unique_lock<std::mutex> lock(device.mutex);
+
+    if (header.type == FRAME_QUERY && header.maxAge_ms > 0 && isShareableQuery(payload)) {
+        auto it = device.cache.find(payload);
+        if (it != device.cache.end() &&
+            std::chrono::steady_clock::now() - it->second.time <=
+                std::chrono::milliseconds(header.maxAge_ms)) {
+            std::string cached = it->second.response;
+            lock.unlock();
+            ++cacheHits_;
+            reply(*client, FRAME_RESPONSE, header.requestId, cached);
+            return true;
+        }
+    }
+
+    Request request;
+    request.client = client;
+    request.type = header.type;
+    request.requestId = header.requestId;
+    request.payload = std::move(payload);
+    device.queues[client->id].push_back(std::move(request));
+    lock.unlock();
+    device.cv.notify_one();
+    return true;
+}
+
+void G30Daemon::deviceLoop(Device& device) {
+    while (running_) {
+        std::vector<Request> turn;
+        {
+            std::unique_lock<std::mutex> lock(device.mutex);
+            device.cv.wait(lock, [&]() { return !running_ || !device.queues.empty(); });
+            if (!running_) {
+                break;
+            }
+
+            // Round-robin: one request per client per pass, starting after the last client served
+            while (!device.queues.empty() && static_cast<int>(turn.size()) < config_.maxBatch) {
+                auto it = device.queues.upper_bound(device.lastServed);
+                if (it == device.queues.end()) {
+                    it = device.queues.begin();
+                }
+                device.lastServed = it->first;
+                turn.push_back(std::move(it->second.front()));
+                it->second.pop_front();
+                if (it->second.empty()) {
+                    device.queues.erase(it);
+                }
+            }
+        }
+
+        // Requests of clients that disconnected after the pick are not run
+        turn.erase(std::remove_if(turn.begin(), turn.end(),
+                                  [](const Request& r) { return !r.client->open; }),
+                   turn.end());
+
+        // Execute runs of equal request type in pick order
+        size_t begin = 0;
+        while (begin < turn.size()) {
+            size_t end = begin;
+            while (end < turn.size() && turn[end].type == turn[begin].type) {
+                ++end;
+            }
+
+            if (turn[begin].type == FRAME_QUERY) {
+                runQueries(device, turn, begin, end);
+            } else {
+                try {
+                    std::vector<std::string> commands;
+                    commands.reserve(end - begin);
+                    for (size_t i = begin; i < end; ++i) {
+                        commands.push_back(turn[i].payload);
+                    }
+                    device.psu->sendBatch(commands);
+
+                    {
+                        // Any setting may have changed
+                        std::lock_guard<std::mutex> lock(device.mutex);
+                        device.cache.clear();
+                    }
+                    for (size_t i = begin; i < end; ++i) {
+                        reply(*turn[i].client, FRAME_RESPONSE, turn[i].requestId, std::string());
+                    }
+                } catch (const std::exception& e) {
+                    for (size_t i = begin; i < end; ++i) {
+                        reply(*turn[i].client, FRAME_ERROR, turn[i].requestId, e.what());
+                    }
+                }
+            }
+
+            begin = end;
+        }
+    }
+}
+
+void G30Daemon::runQueries(Device& device, const std::vector<Request>& turn, size_t begin, size_t end) {
+    // Identical side-effect-free queries in the run share one device answer;
+    // every other query gets a round trip slot of its own
+    std::vector<std::string> unique;
+    std::vector<size_t> slot(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+        size_t k = unique.size();
+        if (isShareableQuery(turn[i].payload)) {
+            k = 0;
+            while (k < unique.size() && unique[k] != turn[i].payload) {
+                ++k;
+            }
+        }
+        if (k == unique.size()) {
+            unique.push_back(turn[i].payload);
+        } else {
+            ++mergedQueries_;
+        }
+        slot[i - begin] = k;
+    }
+
+    // One pipelined round trip; if it fails, each query is asked on its own
+    // so that one unanswered query only fails the requests that sent it
+    std::vector<std::string> responses(unique.size());
+    std::vector<std::string> errors(unique.size());
+    try {
+        responses = device.psu->sendQueries(unique);
+        ++roundTrips_;
+    } catch (const std::exception& e) {
+        if (unique.size() == 1) {
+            errors[0] = e.what();
+        } else {
+            for (size_t k = 0; k < unique.size(); ++k) {
+                try {
+                    responses[k] = device.psu->sendQueries({unique[k]})[0];
+                    ++roundTrips_;
+                } catch (const std::exception& single) {
+                    errors[k] = single.what();
+                }
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(device.mutex);
+        auto now = std::chrono::steady_clock::now();
+        for (size_t k = 0; k < unique.size(); ++k) {
+            if (errors[k].empty() && isShareableQuery(unique[k])) {
+                device.cache[unique[k]] = Device::CacheEntry{responses[k], now};
+            }
+        }
+    }
+    for (size_t i = begin; i < end; ++i) {
+        size_t k = slot[i - begin];
+        if (errors[k].empty()) {
+            reply(*turn[i].client, FRAME_RESPONSE, turn[i].requestId, responses[k]);
+        } else {
+            reply(*turn[i].client, FRAME_ERROR, turn[i].requestId, errors[k]);
+        }
+    }
+}
+
+void G30Daemon::dropRequests(const Client& client) {
+    for (auto& device : devices_) {
+        std::lock_guard<std::mutex> lock(device->mutex);
+        device->queues.erase(client.id);
+    }
+}
+
+void G30Daemon::reply(Client& client, uint16_t type, uint32_t requestId, const std::string& payload) {
+    if (!client.open) {
+        return;
+    }
+
+    FrameHeader header;
+    header.length = static_cast<uint32_t>(payload.size());
+    header.type = type;
+    header.device = 0;
+    header.requestId = requestId;
+    header.maxAge_ms = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(client.txMutex);
+        if (client.tx.size() + sizeof(header) + payload.size() > config_.maxClientQueue) {
+            // The client is not reading its replies; drop it rather than buffer without bound
+            client.tx.clear();
+            client.open = false;
+        } else {
+            bool wasIdle = client.tx.empty();
+            client.tx.append(reinterpret_cast<const char*>(&header), sizeof(header));
+            client.tx += payload;
+            if (!wasIdle) {
+                return;
+            }
+        }
+    }
+
+    // The listener writes the queue; wake it to poll for POLLOUT or drop the client
+    char wake = 1;
+    if (::write(wakePipe_[1], &wake, 1) < 0) {
+        // Pipe full: the listener is already due to wake
+    }
+}
+
+// ==================== G30DaemonClient ====================
+
+G30DaemonClient::G30DaemonClient(const std::string& socketPath)
+    : fd_(-1),
+      nextRequestId_(1) {
+
+    sockaddr_un addr = unixAddress(socketPath);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0) {
+        throw G30Exception("Failed to create client socket");
+    }
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd_);
+        fd_ = -1;
+        throw G30Exception("Failed to connect to daemon at " + socketPath + ": " +
+                         std::strerror(errno));
+    }
+}
+
+G30DaemonClient::~G30DaemonClient() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+std::vector<std::string> G30DaemonClient::listDevices() {
+    std::string names = transact(FRAME_LIST, 0, std::string(), 0);
+
+    std::vector<std::string> result;
+    size_t start = 0;
+    size_t newline;
+    while ((newline = names.find('\n', start)) != std::string::npos) {
+        result.push_back(names.substr(start, newline - start));
+        start = newline + 1;
+    }
+    return result;
+}
+
+std::string G30DaemonClient::query(uint16_t device, const std::string& query, uint32_t maxAge_ms) {
+    return transact(FRAME_QUERY, device, query, maxAge_ms);
+}
+
+void G30DaemonClient::command(uint16_t device, const std::string& command) {
+    transact(FRAME_COMMAND, device, command, 0);
+}
+
+std::string G30DaemonClient::transact(uint16_t type, uint16_t device,
+                                      const std::string& payload, uint32_t maxAge_ms) {
+    if (payload.size() > kMaxPayload) {
+        throw G30Exception("Daemon request too large");
+    }
+
+    FrameHeader header;
+    header.length = static_cast<uint32_t>(payload.size());
+    header.type = type;
+    header.device = device;
+    header.requestId = nextRequestId_++;
+    header.maxAge_ms = maxAge_ms;
+
+    std::string frame(reinterpret_cast<const char*>(&header), sizeof(header));
+    frame += payload;
+    if (!sendAll(fd_, frame.data(), frame.size())) {
+        throw G30Exception("Failed to send request to daemon");
+    }
+
+    FrameHeader response;
+    if (!recvAll(fd_, reinterpret_cast<char*>(&response), sizeof(response)) ||
+        response.length > kMaxPayload) {
+        throw G30Exception("Daemon connection lost");
+    }
+    std::string body(response.length, '\0');
+    if (response.length > 0 && !recvAll(fd_, &body[0], body.size())) {
+        throw G30Exception("Daemon connection lost");
+    }
+    if (response.requestId != header.requestId) {
+        throw G30Exception("Daemon reply out of sequence");
+    }
+    if (response.type == FRAME_ERROR) {
+        throw G30Exception("Daemon: " + body);
+    }
+
+    return body;
+}
+
+} // namespace TDKLambda
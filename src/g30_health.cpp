@@ -0,0 +1,216 @@
+/**
+ * @file g30_health.cpp
+ * @brief Implementation of the connection health monitor
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_health.h"
+#include <algorithm>
+#include <cmath>
+
+namespace TDKLambda {
+
+const char* healthStateName(HealthState state) {
+    switch (state) {
+        case HealthState::HEALTHY:  return "healthy";
+        case HealthState::DEGRADED: return "degraded";
+        case HealthState::DOWN:     return "down";
+        default:                    return "unknown";
+    }
+}
+
+HealthMonitor::HealthMonitor(const std::vector<TDKLambdaG30*>& supplies, const HealthConfig& config)
+    : supplies_(supplies),
+      config_(config),
+      running_(false),
+      health_(supplies.size()) {
+
+    if (supplies_.empty()) {
+        throw G30Exception("Health monitor needs at least one supply");
+    }
+    for (auto* psu : supplies_) {
+        if (!psu) {
+            throw G30Exception("Health monitor supply list contains null");
+        }
+    }
+    if (config_.interval_ms <= 0 || config_.probeTimeout_ms <= 0) {
+        throw G30Exception("Heartbeat interval and timeout must be positive");
+    }
+    for (auto& h : health_) {
+        h.state = HealthState::UNKNOWN;
+    }
+}
+
+HealthMonitor::~HealthMonitor() {
+    stop();
+}
+
+void HealthMonitor::setStateCallback(std::function<void(size_t, HealthState, HealthState)> callback) {
+    if (running_) {
+        throw G30Exception("Cannot change the health callback while monitoring");
+    }
+    callback_ = callback;
+}
+
+void HealthMonitor::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+
+    threads_.reserve(supplies_.size());
+    for (size_t d = 0; d < supplies_.size(); ++d) {
+        threads_.emplace_back(&HealthMonitor::monitorLoop, this, d);
+    }
+}
+
+void HealthMonitor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        running_ = false;
+    }
+    stopCv_.notify_all();
+    for (auto& t : threads_) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    threads_.clear();
+}
+
+HealthState HealthMonitor::probe(size_t device) {
+    if (device >= supplies_.size()) {
+        throw G30Exception("Health device index out of range");
+    }
+
+    // Timed by the driver from write to reply, so waiting behind application
+    // traffic on the same supply does not count as link latency. No retries:
+    // every lost heartbeat must show up in the loss figures.
+    double rtt_ms = 0;
+    bool answered = true;
+    try {
+        supplies_[device]->sendQueries({config_.probeQuery}, config_.probeTimeout_ms, rtt_ms, 0);
+    } catch (const std::exception&) {
+        answered = false;
+    }
+
+    record(device, answered, rtt_ms);
+    return state(device);
+}
+
+HealthState HealthMonitor::state(size_t device) const {
+    if (device >= health_.size()) {
+        throw G30Exception("Health device index out of range");
+    }
+    std::lock_guard<std::mutex> lock(healthMutex_);
+    return health_[device].state;
+}
+
+RttStats HealthMonitor::stats(size_t device) const {
+    if (device >= health_.size()) {
+        throw G30Exception("Health device index out of range");
+    }
+    std::lock_guard<std::mutex> lock(healthMutex_);
+    return health_[device].stats;
+}
+
+std::vector<size_t> HealthMonitor::devicesIn(HealthState state) const {
+    std::vector<size_t> devices;
+    std::lock_guard<std::mutex> lock(healthMutex_);
+    for (size_t d = 0; d < health_.size(); ++d) {
+        if (health_[d].state == state) {
+            devices.push_back(d);
+        }
+    }
+    return devices;
+}
+
+void HealthMonitor::monitorLoop(size_t device) {
+    TDKLambdaG30* psu = supplies_[device];
+    const auto interval = std::chrono::milliseconds(config_.interval_ms);
+    std::chrono::steady_clock::time_point ownResponse;
+
+    // First heartbeat right away so every device leaves UNKNOWN quickly
+    probe(device);
+    ownResponse = psu->lastResponseTime();
+
+    auto next = std::chrono::steady_clock::now() + interval;
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(stopMutex_);
+            stopCv_.wait_until(lock, next, [this]() { return !running_; });
+        }
+        if (!running_) {
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        auto lastResponse = psu->lastResponseTime();
+        if (lastResponse > ownResponse && now - lastResponse < interval) {
+            // Application traffic proves the link; no heartbeat needed
+            record(device, true, -1.0);
+        } else {
+            probe(device);
+            ownResponse = psu->lastResponseTime();
+        }
+
+        next += interval;
+        if (next < now) {
+            next = now + interval;
+        }
+    }
+}
+
+HealthState HealthMonitor::classify(const RttStats& stats) const {
+    if (stats.consecutiveLosses >= config_.downAfterLosses) {
+        return HealthState::DOWN;
+    }
+    if (stats.probes == 0) {
+        return HealthState::UNKNOWN;
+    }
+    if (stats.ewma_ms > config_.degradedRtt_ms || stats.lossRate > config_.degradedLossRate) {
+        return HealthState::DEGRADED;
+    }
+    return HealthState::HEALTHY;
+}
+
+void HealthMonitor::record(size_t device, bool answered, double rtt_ms) {
+    HealthState previous;
+    HealthState current;
+    {
+        std::lock_guard<std::mutex> lock(healthMutex_);
+        DeviceHealth& h = health_[device];
+        RttStats& s = h.stats;
+
+        if (rtt_ms >= 0.0) {
+            // A heartbeat (negative RTT marks passive evidence of life)
+            ++s.probes;
+            if (answered) {
+                if (s.probes - s.losses == 1) {
+                    s.ewma_ms = rtt_ms;
+                    s.min_ms = rtt_ms;
+                } else {
+                    s.jitter_ms += (std::abs(rtt_ms - s.last_ms) - s.jitter_ms) / 16.0;
+                    s.ewma_ms += (rtt_ms - s.ewma_ms) / 8.0;
+                    s.min_ms = std::min(s.min_ms, rtt_ms);
+                }
+                s.last_ms = rtt_ms;
+                s.lossRate -= s.lossRate / 10.0;
+            } else {
+                ++s.losses;
+                s.lossRate += (1.0 - s.lossRate) / 10.0;
+            }
+        }
+        s.consecutiveLosses = answered ? 0 : s.consecutiveLosses + 1;
+
+        previous = h.state;
+        current = classify(s);
+        h.state = current;
+    }
+
+    if (current != previous && callback_) {
+        callback_(device, previous, current);
+    }
+}
+
+} // namespace TDKLambda
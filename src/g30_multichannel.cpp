@@ -0,0 +1,340 @@
+/**
+ * @file g30_multichannel.cpp
+ * @brief Implementation of the logical multi-channel supply
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_multichannel.h"
+#include <algorithm>
+#include <future>
+
+namespace TDKLambda {
+
+using PowerSupply::IPowerSupply;
+using PowerSupply::PowerSupplyCapabilities;
+using PowerSupply::PowerSupplyStatus;
+using PowerSupply::Vendor;
+
+namespace {
+
+/**
+ * Run task(0..count-1) with one thread per task; task 0 runs on the
+ * calling thread. Each task returns an empty string or a failure message.
+ * All tasks finish before the first failure is thrown.
+ */
+template <typename Task>
+void runConcurrently(size_t count, const Task& task) {
+    std::vector<std::future<std::string>> work;
+    work.reserve(count);
+    for (size_t i = 1; i < count; ++i) {
+        work.push_back(std::async(std::launch::async, [&task, i]() { return task(i); }));
+    }
+
+    std::string failure = count > 0 ? task(0) : std::string();
+    for (auto& w : work) {
+        std::string f = w.get();
+        if (failure.empty()) {
+            failure = f;
+        }
+    }
+    if (!failure.empty()) {
+        throw G30Exception(failure);
+    }
+}
+
+} // namespace
+
+MultiChannelSupply::MultiChannelSupply(const std::vector<IPowerSupply*>& supplies)
+    : units_(supplies) {
+    buildRoutes();
+}
+
+void MultiChannelSupply::buildRoutes() {
+    if (units_.empty()) {
+        throw G30Exception("Multi-channel supply needs at least one supply");
+    }
+    for (size_t u = 0; u < units_.size(); ++u) {
+        if (!units_[u]) {
+            throw G30Exception("Multi-channel supply list contains null");
+        }
+        int channels = units_[u]->getCapabilities().numberOfChannels;
+        if (channels < 1) {
+            throw G30Exception("Supply " + std::to_string(u) + " reports no channels");
+        }
+        for (int c = 1; c <= channels; ++c) {
+            routes_.push_back({u, c});
+        }
+    }
+}
+
+const MultiChannelSupply::Route& MultiChannelSupply::route(int channel) const {
+    if (channel < 1 || channel > channelCount()) {
+        throw G30Exception("Channel " + std::to_string(channel) + " out of range (1.." +
+                         std::to_string(channelCount()) + ")");
+    }
+    return routes_[static_cast<size_t>(channel - 1)];
+}
+
+IPowerSupply* MultiChannelSupply::supply(int channel) const {
+    return units_[route(channel).unit];
+}
+
+int MultiChannelSupply::unitChannel(int channel) const {
+    return route(channel).channel;
+}
+
+void MultiChannelSupply::forEachUnit(const std::function<void(size_t)>& fn) const {
+    runConcurrently(units_.size(), [&fn](size_t u) -> std::string {
+        try {
+            fn(u);
+        } catch (const std::exception& e) {
+            return "Supply " + std::to_string(u) + " failed: " + e.what();
+        }
+        return std::string();
+    });
+}
+
+void MultiChannelSupply::forEachChannel(const std::function<void(size_t)>& fn) const {
+    runConcurrently(units_.size(), [this, &fn](size_t u) -> std::string {
+        for (size_t i = 0; i < routes_.size(); ++i) {
+            if (routes_[i].unit != u) {
+                continue;
+            }
+            try {
+                fn(i);
+            } catch (const std::exception& e) {
+                return "Channel " + std::to_string(i + 1) + " failed: " + e.what();
+            }
+        }
+        return std::string();
+    });
+}
+
+std::string MultiChannelSupply::joinResponses(const std::function<std::string(IPowerSupply*)>& fn) const {
+    std::vector<std::string> responses(units_.size());
+    forEachUnit([this, &fn, &responses](size_t u) {
+        responses[u] = fn(units_[u]);
+    });
+
+    std::string joined;
+    for (size_t u = 0; u < responses.size(); ++u) {
+        if (u > 0) {
+            joined += ';';
+        }
+        joined += responses[u];
+    }
+    return joined;
+}
+
+// ==================== Connection and Whole-Instrument Control ====================
+
+void MultiChannelSupply::connect() {
+    forEachUnit([this](size_t u) { units_[u]->connect(); });
+}
+
+void MultiChannelSupply::disconnect() {
+    // Best effort: one failing unit must not leave the others connected
+    runConcurrently(units_.size(), [this](size_t u) -> std::string {
+        try {
+            units_[u]->disconnect();
+        } catch (const std::exception&) {
+        }
+        return std::string();
+    });
+}
+
+bool MultiChannelSupply::isConnected() const {
+    return std::all_of(units_.begin(), units_.end(),
+                       [](const IPowerSupply* psu) { return psu->isConnected(); });
+}
+
+void MultiChannelSupply::enableOutput(bool enable) {
+    forEachUnit([this, enable](size_t u) { units_[u]->enableOutput(enable); });
+}
+
+bool MultiChannelSupply::isOutputEnabled() const {
+    std::vector<char> enabled(units_.size(), 0);
+    forEachUnit([this, &enabled](size_t u) {
+        enabled[u] = units_[u]->isOutputEnabled() ? 1 : 0;
+    });
+    return std::all_of(enabled.begin(), enabled.end(), [](char e) { return e != 0; });
+}
+
+void MultiChannelSupply::reset() {
+    forEachUnit([this](size_t u) { units_[u]->reset(); });
+}
+
+void MultiChannelSupply::clearProtection() {
+    forEachUnit([this](size_t u) { units_[u]->clearProtection(); });
+}
+
+// ==================== Per-Channel Control ====================
+
+void MultiChannelSupply::setVoltage(double voltage, int channel) {
+    const Route& r = route(channel);
+    units_[r.unit]->setVoltage(voltage, r.channel);
+}
+
+double MultiChannelSupply::getVoltage(int channel) const {
+    const Route& r = route(channel);
+    return units_[r.unit]->getVoltage(r.channel);
+}
+
+double MultiChannelSupply::measureVoltage(int channel) const {
+    const Route& r = route(channel);
+    return units_[r.unit]->measureVoltage(r.channel);
+}
+
+void MultiChannelSupply::setCurrent(double current, int channel) {
+    const Route& r = route(channel);
+    units_[r.unit]->setCurrent(current, r.channel);
+}
+
+double MultiChannelSupply::getCurrent(int channel) const {
+    const Route& r = route(channel);
+    return units_[r.unit]->getCurrent(r.channel);
+}
+
+double MultiChannelSupply::measureCurrent(int channel) const {
+    const Route& r = route(channel);
+    return units_[r.unit]->measureCurrent(r.channel);
+}
+
+double MultiChannelSupply::measurePower(int channel) const {
+    const Route& r = route(channel);
+    return units_[r.unit]->measurePower(r.channel);
+}
+
+void MultiChannelSupply::setOverVoltageProtection(double voltage, int channel) {
+    const Route& r = route(channel);
+    units_[r.unit]->setOverVoltageProtection(voltage, r.channel);
+}
+
+PowerSupplyStatus MultiChannelSupply::getStatus(int channel) const {
+    const Route& r = route(channel);
+    return units_[r.unit]->getStatus(r.channel);
+}
+
+// ==================== Information ====================
+
+std::string MultiChannelSupply::getIdentification() const {
+    std::vector<std::string> ids(units_.size());
+    forEachUnit([this, &ids](size_t u) { ids[u] = units_[u]->getIdentification(); });
+
+    std::string joined;
+    for (size_t u = 0; u < ids.size(); ++u) {
+        if (u > 0) {
+            joined += "; ";
+        }
+        joined += ids[u];
+    }
+    return joined;
+}
+
+PowerSupplyCapabilities MultiChannelSupply::getCapabilities() const {
+    PowerSupplyCapabilities caps;
+    caps.numberOfChannels = channelCount();
+    caps.supportsRemoteSensing = true;
+    caps.supportsOVP = true;
+    caps.supportsOCP = true;
+    caps.supportsOPP = true;
+    caps.supportsSequencing = true;
+
+    for (const auto* psu : units_) {
+        PowerSupplyCapabilities unit = psu->getCapabilities();
+        caps.maxVoltage = std::max(caps.maxVoltage, unit.maxVoltage);
+        caps.maxCurrent = std::max(caps.maxCurrent, unit.maxCurrent);
+        caps.maxPower += unit.maxPower;
+        caps.supportsRemoteSensing = caps.supportsRemoteSensing && unit.supportsRemoteSensing;
+        caps.supportsOVP = caps.supportsOVP && unit.supportsOVP;
+        caps.supportsOCP = caps.supportsOCP && unit.supportsOCP;
+        caps.supportsOPP = caps.supportsOPP && unit.supportsOPP;
+        caps.supportsSequencing = caps.supportsSequencing && unit.supportsSequencing;
+    }
+    return caps;
+}
+
+Vendor MultiChannelSupply::getVendor() const {
+    Vendor vendor = units_.front()->getVendor();
+    for (const auto* psu : units_) {
+        if (psu->getVendor() != vendor) {
+            return Vendor::CUSTOM;
+        }
+    }
+    return vendor;
+}
+
+std::string MultiChannelSupply::getModel() const {
+    std::string first = units_.front()->getModel();
+    bool uniform = std::all_of(units_.begin(), units_.end(),
+                               [&first](const IPowerSupply* psu) { return psu->getModel() == first; });
+    if (uniform) {
+        return std::to_string(units_.size()) + "x" + first;
+    }
+
+    std::string model;
+    for (size_t u = 0; u < units_.size(); ++u) {
+        if (u > 0) {
+            model += '+';
+        }
+        model += units_[u]->getModel();
+    }
+    return model;
+}
+
+// ==================== Raw Access ====================
+
+std::string MultiChannelSupply::sendCommand(const std::string& command) {
+    return joinResponses([&command](IPowerSupply* psu) { return psu->sendCommand(command); });
+}
+
+std::string MultiChannelSupply::sendQuery(const std::string& query) const {
+    return joinResponses([&query](IPowerSupply* psu) { return psu->sendQuery(query); });
+}
+
+// ==================== Batch Operations ====================
+
+void MultiChannelSupply::setVoltages(const std::vector<double>& voltages) {
+    if (voltages.size() != routes_.size()) {
+        throw G30Exception("Voltage count does not match channel count");
+    }
+    forEachChannel([this, &voltages](size_t i) {
+        units_[routes_[i].unit]->setVoltage(voltages[i], routes_[i].channel);
+    });
+}
+
+void MultiChannelSupply::setCurrents(const std::vector<double>& currents) {
+    if (currents.size() != routes_.size()) {
+        throw G30Exception("Current count does not match channel count");
+    }
+    forEachChannel([this, &currents](size_t i) {
+        units_[routes_[i].unit]->setCurrent(currents[i], routes_[i].channel);
+    });
+}
+
+std::vector<double> MultiChannelSupply::measureVoltages() const {
+    std::vector<double> readings(routes_.size());
+    forEachChannel([this, &readings](size_t i) {
+        readings[i] = units_[routes_[i].unit]->measureVoltage(routes_[i].channel);
+    });
+    return readings;
+}
+
+std::vector<double> MultiChannelSupply::measureCurrents() const {
+    std::vector<double> readings(routes_.size());
+    forEachChannel([this, &readings](size_t i) {
+        readings[i] = units_[routes_[i].unit]->measureCurrent(routes_[i].channel);
+    });
+    return readings;
+}
+
+std::vector<PowerSupplyStatus> MultiChannelSupply::getStatuses() const {
+    std::vector<PowerSupplyStatus> statuses(routes_.size());
+    forEachChannel([this, &statuses](size_t i) {
+        statuses[i] = units_[routes_[i].unit]->getStatus(routes_[i].channel);
+    });
+    return statuses;
+}
+
+} // namespace TDKLambda
@@ -0,0 +1,128 @@
+/**
+ * @file g30_presets.cpp
+ * @brief Implementation of named setup-memory recipes
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_presets.h"
+#include <cmath>
+
+namespace TDKLambda {
+
+PresetBank::PresetBank(TDKLambdaG30& psu)
+    : psu_(psu) {
+}
+
+int PresetBank::store(const std::string& name, const DeviceConfig& config) {
+    auto it = entries_.find(name);
+    int slot = (it != entries_.end()) ? it->second.slot : freeSlot();
+
+    psu_.applyConfig(config);
+    psu_.saveSetup(slot);
+
+    Entry entry;
+    entry.slot = slot;
+    entry.expected = config;
+    entry.verified = true;
+    entries_[name] = entry;
+    return slot;
+}
+
+void PresetBank::assign(const std::string& name, int slot, const DeviceConfig& expected) {
+    if (slot < 1 || slot > psu_.getSetupSlots()) {
+        throw G30Exception("Setup slot " + std::to_string(slot) + " out of range 1.." +
+                         std::to_string(psu_.getSetupSlots()));
+    }
+    if (slotInUse(slot, name)) {
+        throw G30Exception("Setup slot " + std::to_string(slot) + " already holds another recipe");
+    }
+
+    Entry entry;
+    entry.slot = slot;
+    entry.expected = expected;
+    entry.verified = false;
+    entries_[name] = entry;
+}
+
+void PresetBank::recall(const std::string& name) {
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+        throw G30Exception("Unknown recipe: " + name);
+    }
+
+    Entry& entry = it->second;
+    if (entry.verified) {
+        psu_.recallSetup(entry.slot);
+        return;
+    }
+
+    // First recall of a slot we did not write ourselves. A slot can only be
+    // read back by recalling it, so keep the present settings to fall back to.
+    DeviceConfig previous = psu_.readConfig();
+    psu_.recallSetup(entry.slot);
+
+    DeviceConfig actual = psu_.readConfig();
+    auto differs = [](double a, double b) { return std::abs(a - b) >= 0.0005; };
+    if (differs(actual.voltage, entry.expected.voltage) ||
+        differs(actual.current, entry.expected.current) ||
+        differs(actual.overVoltageProtection, entry.expected.overVoltageProtection)) {
+        std::string message = "Recipe '" + name + "' does not match contents of setup slot " +
+                              std::to_string(entry.slot);
+
+        // Undo the recall with the output off (applyConfig switches it off first)
+        previous.outputEnabled = false;
+        try {
+            psu_.applyConfig(previous);
+        } catch (const std::exception& e) {
+            throw G30Exception(message + "; restoring the previous settings failed: " + e.what());
+        }
+        throw G30Exception(message + "; previous settings restored with the output off");
+    }
+    entry.verified = true;
+}
+
+void PresetBank::remove(const std::string& name) {
+    entries_.erase(name);
+}
+
+bool PresetBank::contains(const std::string& name) const {
+    return entries_.find(name) != entries_.end();
+}
+
+int PresetBank::slotOf(const std::string& name) const {
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+        throw G30Exception("Unknown recipe: " + name);
+    }
+    return it->second.slot;
+}
+
+std::vector<std::string> PresetBank::names() const {
+    std::vector<std::string> result;
+    result.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+int PresetBank::freeSlot() const {
+    for (int slot = 1; slot <= psu_.getSetupSlots(); ++slot) {
+        if (!slotInUse(slot, std::string())) {
+            return slot;
+        }
+    }
+    throw G30Exception("All " + std::to_string(psu_.getSetupSlots()) + " setup slots are in use");
+}
+
+bool PresetBank::slotInUse(int slot, const std::string& except) const {
+    for (const auto& entry : entries_) {
+        if (entry.second.slot == slot && entry.first != except) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace TDKLambda
@@ -0,0 +1,408 @@
+/**
+ * @file g30_sequencer.cpp
+ * @brief Implementation of the dependency-graph power sequencer
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_sequencer.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace TDKLambda {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+// ==================== PowerSequence ====================
+
+PowerSequence& PowerSequence::add(const SequenceStep& step) {
+    if (step.name.empty()) {
+        throw G30Exception("Sequence step needs a name");
+    }
+    for (const auto& s : steps_) {
+        if (s.name == step.name) {
+            throw G30Exception("Duplicate sequence step '" + step.name + "'");
+        }
+    }
+    if (step.delay_ms < 0 || step.timeout_ms < 0) {
+        throw G30Exception("Delay and timeout of step '" + step.name + "' must not be negative");
+    }
+    steps_.push_back(step);
+    return *this;
+}
+
+PowerSequence& PowerSequence::setVoltage(const std::string& name, size_t device, double voltage,
+                                         const std::vector<std::string>& after, int delay_ms) {
+    SequenceStep step;
+    step.name = name;
+    step.device = device;
+    step.after = after;
+    step.delay_ms = delay_ms;
+    step.action = SequenceAction::SET_VOLTAGE;
+    step.value = voltage;
+    return add(step);
+}
+
+PowerSequence& PowerSequence::setCurrent(const std::string& name, size_t device, double current,
+                                         const std::vector<std::string>& after, int delay_ms) {
+    SequenceStep step;
+    step.name = name;
+    step.device = device;
+    step.after = after;
+    step.delay_ms = delay_ms;
+    step.action = SequenceAction::SET_CURRENT;
+    step.value = current;
+    return add(step);
+}
+
+PowerSequence& PowerSequence::outputOn(const std::string& name, size_t device,
+                                       const std::vector<std::string>& after, int delay_ms) {
+    SequenceStep step;
+    step.name = name;
+    step.device = device;
+    step.after = after;
+    step.delay_ms = delay_ms;
+    step.action = SequenceAction::OUTPUT_ON;
+    return add(step);
+}
+
+PowerSequence& PowerSequence::outputOff(const std::string& name, size_t device,
+                                        const std::vector<std::string>& after, int delay_ms) {
+    SequenceStep step;
+    step.name = name;
+    step.device = device;
+    step.after = after;
+    step.delay_ms = delay_ms;
+    step.action = SequenceAction::OUTPUT_OFF;
+    return add(step);
+}
+
+PowerSequence& PowerSequence::delay(const std::string& name, int delay_ms,
+                                    const std::vector<std::string>& after) {
+    SequenceStep step;
+    step.name = name;
+    step.after = after;
+    step.delay_ms = delay_ms;
+    return add(step);
+}
+
+PowerSequence& PowerSequence::waitAbove(double threshold, int timeout_ms) {
+    if (steps_.empty()) {
+        throw G30Exception("No sequence step to attach a condition to");
+    }
+    steps_.back().condition = SequenceCondition::VOLTAGE_ABOVE;
+    steps_.back().threshold = threshold;
+    steps_.back().timeout_ms = timeout_ms;
+    return *this;
+}
+
+PowerSequence& PowerSequence::waitBelow(double threshold, int timeout_ms) {
+    if (steps_.empty()) {
+        throw G30Exception("No sequence step to attach a condition to");
+    }
+    steps_.back().condition = SequenceCondition::VOLTAGE_BELOW;
+    steps_.back().threshold = threshold;
+    steps_.back().timeout_ms = timeout_ms;
+    return *this;
+}
+
+std::vector<size_t> PowerSequence::validate() const {
+    std::map<std::string, size_t> index;
+    for (size_t i = 0; i < steps_.size(); ++i) {
+        index[steps_[i].name] = i;
+    }
+
+    std::vector<int> pending(steps_.size(), 0);
+    std::vector<std::vector<size_t>> dependents(steps_.size());
+    for (size_t i = 0; i < steps_.size(); ++i) {
+        for (const auto& dep : steps_[i].after) {
+            auto it = index.find(dep);
+            if (it == index.end()) {
+                throw G30Exception("Step '" + steps_[i].name + "' depends on unknown step '" + dep + "'");
+            }
+            dependents[it->second].push_back(i);
+            ++pending[i];
+        }
+    }
+
+    // Kahn's algorithm; anything left over is on a cycle
+    std::vector<size_t> order;
+    std::deque<size_t> ready;
+    for (size_t i = 0; i < steps_.size(); ++i) {
+        if (pending[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+    while (!ready.empty()) {
+        size_t i = ready.front();
+        ready.pop_front();
+        order.push_back(i);
+        for (size_t d : dependents[i]) {
+            if (--pending[d] == 0) {
+                ready.push_back(d);
+            }
+        }
+    }
+    if (order.size() != steps_.size()) {
+        for (size_t i = 0; i < steps_.size(); ++i) {
+            if (pending[i] > 0) {
+                throw G30Exception("Sequence has a dependency cycle through step '" + steps_[i].name + "'");
+            }
+        }
+    }
+    return order;
+}
+
+// ==================== PowerSequencer ====================
+
+const char* stepOutcomeName(StepOutcome outcome) {
+    switch (outcome) {
+        case StepOutcome::DONE:    return "done";
+        case StepOutcome::TIMEOUT: return "timeout";
+        case StepOutcome::FAILED:  return "failed";
+        case StepOutcome::SKIPPED: return "skipped";
+        default:                   return "pending";
+    }
+}
+
+PowerSequencer::PowerSequencer(const std::vector<TDKLambdaG30*>& supplies, const SequencerConfig& config)
+    : supplies_(supplies),
+      config_(config) {
+
+    if (supplies_.empty()) {
+        throw G30Exception("Power sequencer needs at least one supply");
+    }
+    for (auto* psu : supplies_) {
+        if (!psu) {
+            throw G30Exception("Power sequencer supply list contains null");
+        }
+    }
+    if (config_.pollInterval_ms <= 0) {
+        throw G30Exception("Poll interval must be positive");
+    }
+}
+
+SequenceTrace PowerSequencer::run(const PowerSequence& sequence) {
+    const std::vector<SequenceStep>& steps = sequence.steps();
+    std::vector<size_t> order = sequence.validate();
+
+    std::map<std::string, size_t> index;
+    std::set<size_t> devices;
+    for (size_t i = 0; i < steps.size(); ++i) {
+        index[steps[i].name] = i;
+        bool usesDevice = steps[i].action != SequenceAction::NONE ||
+                          steps[i].condition != SequenceCondition::NONE;
+        if (usesDevice) {
+            if (steps[i].device >= supplies_.size()) {
+                throw G30Exception("Step '" + steps[i].name + "' uses unknown device " +
+                                 std::to_string(steps[i].device));
+            }
+            devices.insert(steps[i].device);
+        }
+    }
+
+    SequenceTrace result;
+    result.steps.resize(steps.size());
+
+    // Specified timing: every action and condition completes instantly
+    for (size_t i : order) {
+        double start = 0.0;
+        for (const auto& dep : steps[i].after) {
+            start = std::max(start, result.steps[index[dep]].specStart_ms);
+        }
+        StepTrace& trace = result.steps[i];
+        trace.name = steps[i].name;
+        trace.device = steps[i].device;
+        trace.specStart_ms = start + steps[i].delay_ms;
+        result.specDuration_ms = std::max(result.specDuration_ms, trace.specStart_ms);
+    }
+
+    std::vector<int> pending(steps.size(), 0);
+    std::vector<std::vector<size_t>> dependents(steps.size());
+    for (size_t i = 0; i < steps.size(); ++i) {
+        for (const auto& dep : steps[i].after) {
+            dependents[index[dep]].push_back(i);
+            ++pending[i];
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable finishedCv;
+    std::deque<size_t> finished;
+    std::vector<std::future<void>> work;
+    std::vector<bool> launched(steps.size(), false);
+
+    // Each running step holds the clock; the hold of a finished step passes to
+    // this thread until its dependents are launched, so virtual time cannot
+    // jump past their start
+    IClock& clock = supplies_.front()->clock();
+    auto t0 = clock.now();
+
+    auto launch = [&](size_t i) {
+        launched[i] = true;
+        clock.hold();
+        work.push_back(std::async(std::launch::async, [&, i]() {
+            runStep(steps[i], result.steps[i], t0);
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.push_back(i);
+            finishedCv.notify_one();
+        }));
+    };
+
+    // Hold while launching the roots so the first of them cannot sleep past the rest
+    clock.hold();
+    for (size_t i = 0; i < steps.size(); ++i) {
+        if (pending[i] == 0) {
+            launch(i);
+        }
+    }
+    clock.release();
+
+    // Start dependents as their last dependency completes; stop launching on failure
+    bool aborted = false;
+    size_t running = work.size();
+    while (running > 0) {
+        size_t i;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finishedCv.wait(lock, [&finished]() { return !finished.empty(); });
+            i = finished.front();
+            finished.pop_front();
+        }
+        --running;
+
+        if (result.steps[i].outcome != StepOutcome::DONE) {
+            aborted = true;
+        } else if (!aborted) {
+            for (size_t d : dependents[i]) {
+                if (--pending[d] == 0) {
+                    launch(d);
+                    ++running;
+                }
+            }
+        }
+        clock.release();
+    }
+    for (auto& w : work) {
+        w.get();
+    }
+
+    result.duration_ms = elapsedMs(t0, clock.now());
+    result.completed = true;
+    for (size_t i = 0; i < steps.size(); ++i) {
+        StepTrace& trace = result.steps[i];
+        if (!launched[i]) {
+            trace.outcome = StepOutcome::SKIPPED;
+        } else {
+            result.maxLateness_ms = std::max(result.maxLateness_ms, trace.lateness_ms);
+        }
+        if (trace.outcome != StepOutcome::DONE) {
+            result.completed = false;
+        }
+    }
+
+    if (aborted && config_.disableOnAbort) {
+        std::vector<std::future<void>> off;
+        clock.hold();
+        for (size_t d : devices) {
+            TDKLambdaG30* psu = supplies_[d];
+            clock.hold();
+            off.push_back(std::async(std::launch::async, [psu, &clock]() {
+                ClockHold hold(clock, std::adopt_lock);
+                try {
+                    psu->enableOutput(false);
+                } catch (const std::exception&) {
+                    // Best effort; the trace already records the failure
+                }
+            }));
+        }
+        clock.release();
+        for (auto& f : off) {
+            f.get();
+        }
+    }
+
+    return result;
+}
+
+void PowerSequencer::runStep(const SequenceStep& step, StepTrace& trace, Clock::time_point t0) const {
+    IClock& clock = supplies_.front()->clock();
+    if (step.delay_ms > 0) {
+        clock.sleepFor(std::chrono::milliseconds(step.delay_ms));
+    }
+
+    auto start = clock.now();
+    trace.start_ms = elapsedMs(t0, start);
+    trace.lateness_ms = trace.start_ms - trace.specStart_ms;
+
+    try {
+        // Pure delay steps may leave device unset; run() validated the others
+        TDKLambdaG30* psu = step.device < supplies_.size() ? supplies_[step.device] : nullptr;
+        switch (step.action) {
+            case SequenceAction::SET_VOLTAGE: psu->setVoltage(step.value); break;
+            case SequenceAction::SET_CURRENT: psu->setCurrent(step.value); break;
+            case SequenceAction::OUTPUT_ON:   psu->enableOutput(true); break;
+            case SequenceAction::OUTPUT_OFF:  psu->enableOutput(false); break;
+            case SequenceAction::NONE:        break;
+        }
+        auto actionDone = clock.now();
+        trace.actionDone_ms = elapsedMs(t0, actionDone);
+
+        if (step.condition == SequenceCondition::NONE) {
+            trace.done_ms = trace.actionDone_ms;
+            trace.outcome = StepOutcome::DONE;
+            return;
+        }
+
+        const auto deadline = actionDone + std::chrono::milliseconds(step.timeout_ms);
+        const auto interval = std::chrono::milliseconds(config_.pollInterval_ms);
+        auto next = actionDone;
+        for (;;) {
+            // Pipelined query: no settling delay between polls
+            std::vector<std::string> r = psu->sendQueries({"MEAS:VOLT?"});
+            double voltage = std::stod(r[0]);
+            auto now = clock.now();
+            ++trace.polls;
+            trace.lastVoltage = voltage;
+
+            bool met = (step.condition == SequenceCondition::VOLTAGE_ABOVE) ? voltage >= step.threshold
+                                                                           : voltage <= step.threshold;
+            if (met) {
+                trace.done_ms = elapsedMs(t0, now);
+                trace.outcome = StepOutcome::DONE;
+                return;
+            }
+            if (now >= deadline) {
+                trace.done_ms = elapsedMs(t0, now);
+                trace.outcome = StepOutcome::TIMEOUT;
+                trace.error = "Voltage " + std::to_string(voltage) + "V did not cross " +
+                              std::to_string(step.threshold) + "V within " +
+                              std::to_string(step.timeout_ms) + " ms";
+                return;
+            }
+
+            next += interval;
+            clock.sleepUntil(std::min(next, deadline));
+        }
+    } catch (const std::exception& e) {
+        trace.done_ms = elapsedMs(t0, clock.now());
+        trace.outcome = StepOutcome::FAILED;
+        trace.error = e.what();
+    }
+}
+
+} // namespace TDKLambda
@@ -0,0 +1,665 @@
+/**
+ * @file g30_simulator.cpp
+ * @brief Implementation of the G30 simulator
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_simulator.h"
+#include "../include/g30_telemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Linux/POSIX includes
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace TDKLambda {
+
+namespace {
+
+std::string formatValue(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+    return buffer;
+}
+
+bool startsWith(const std::string& text, const char* prefix) {
+    return text.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+// Relative change below which a solver step counts as settled
+const double kSettledTolerance = 1e-9;
+
+bool changed(double before, double after) {
+    return std::abs(after - before) > kSettledTolerance * (1.0 + std::abs(before));
+}
+
+// splitmix64: spreads a small seed over all bits; xorshift seeded with 1
+// would start with a run of draws close to zero
+uint64_t scrambleSeed(uint64_t seed) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return z ? z : 1;
+}
+
+// Decay factor of the load's first-order dynamics over dt seconds
+double loadDecay(const LoadModel& load, double dt) {
+    switch (load.type) {
+        case LoadType::RC: return std::exp(-dt / (load.resistance_ohm * load.capacitance_F));
+        case LoadType::RL: return std::exp(-dt * load.resistance_ohm / load.inductance_H);
+        default:           return 0.0;
+    }
+}
+
+} // namespace
+
+// ==================== LoadModel ====================
+
+LoadModel LoadModel::open() {
+    return LoadModel();
+}
+
+LoadModel LoadModel::resistive(double ohms) {
+    LoadModel load;
+    load.type = LoadType::RESISTIVE;
+    load.resistance_ohm = ohms;
+    return load;
+}
+
+LoadModel LoadModel::constantCurrent(double amps) {
+    LoadModel load;
+    load.type = LoadType::CONSTANT_CURRENT;
+    load.current_A = amps;
+    return load;
+}
+
+LoadModel LoadModel::rc(double ohms, double farads) {
+    LoadModel load;
+    load.type = LoadType::RC;
+    load.resistance_ohm = ohms;
+    load.capacitance_F = farads;
+    return load;
+}
+
+LoadModel LoadModel::rl(double ohms, double henries) {
+    LoadModel load;
+    load.type = LoadType::RL;
+    load.resistance_ohm = ohms;
+    load.inductance_H = henries;
+    return load;
+}
+
+// ==================== SimulatedDevice ====================
+
+SimulatedDevice::SimulatedDevice(const SimulatorConfig& config)
+    : config_(&config),
+      messages_(0),
+      serial_(0),
+      started_(false),
+      settled_(true),
+      constantCurrent_(false),
+      reference_(0.0),
+      outputVoltage_(0.0),
+      outputCurrent_(0.0),
+      loadState_(0.0),
+      stepDecay_(0.0),
+      carry_(0.0),
+      noise_(scrambleSeed(config.noiseSeed)) {
+
+    if (config.solverStep_us <= 0) {
+        throw G30Exception("Solver step must be positive");
+    }
+    state_.overCurrentProtection = config.overCurrentProtection;
+    setLoad(config.load);
+}
+
+void SimulatedDevice::setLoad(const LoadModel& load) {
+    bool needsR = load.type == LoadType::RESISTIVE || load.type == LoadType::RC || load.type == LoadType::RL;
+    if ((needsR && !(load.resistance_ohm > 0)) ||
+        (load.type == LoadType::RC && !(load.capacitance_F > 0)) ||
+        (load.type == LoadType::RL && !(load.inductance_H > 0)) ||
+        (load.type == LoadType::CONSTANT_CURRENT && !(load.current_A >= 0))) {
+        throw G30Exception("Invalid simulated load");
+    }
+
+    // The capacitor keeps its charge; a new inductor starts from the present current
+    if (load.type == LoadType::RC && load_.type != LoadType::RC) {
+        loadState_ = outputVoltage_;
+    } else if (load.type == LoadType::RL && load_.type != LoadType::RL) {
+        loadState_ = outputCurrent_;
+    }
+    load_ = load;
+    stepDecay_ = loadDecay(load_, config_->solverStep_us * 1e-6);
+    settled_ = false;
+}
+
+void SimulatedDevice::setNoiseSeed(uint64_t seed) {
+    noise_ = scrambleSeed(seed);
+}
+
+SimulatedOutput SimulatedDevice::output() const {
+    SimulatedOutput out;
+    out.voltage = outputVoltage_;
+    out.current = outputCurrent_;
+    out.constantCurrent = constantCurrent_;
+    return out;
+}
+
+void SimulatedDevice::update(IClock::TimePoint now) {
+    if (!started_) {
+        started_ = true;
+        updated_ = now;
+    }
+    // Loads without state follow new setpoints at once; R, C and L take time
+    const bool dynamic = load_.type == LoadType::RC || load_.type == LoadType::RL;
+    if (now <= updated_) {
+        if (!settled_ && !dynamic) {
+            step(0.0);
+        }
+        return;
+    }
+    double elapsed = carry_ + std::chrono::duration<double>(now - updated_).count();
+    updated_ = now;
+    carry_ = 0.0;
+
+    // Fixed steps while the reference slews; with a constant reference the
+    // load equations are solved in closed form over the rest of the interval
+    const double h = config_->solverStep_us * 1e-6;
+    while (!settled_ && elapsed > 0) {
+        const double target = state_.outputEnabled ? state_.voltage : 0.0;
+        if (reference_ == target || config_->slewRate_V_per_s <= 0 || !dynamic) {
+            step(elapsed);
+            break;
+        }
+        if (elapsed < h) {
+            carry_ = elapsed;
+            break;
+        }
+        step(h);
+        elapsed -= h;
+    }
+}
+
+void SimulatedDevice::step(double dt) {
+    const double before[] = {reference_, outputVoltage_, outputCurrent_, loadState_};
+    const bool wasEnabled = state_.outputEnabled;
+
+    // Slew-limited reference; an output that is off neither sources nor regulates
+    const double target = state_.outputEnabled ? state_.voltage : 0.0;
+    const double limit = state_.outputEnabled ? state_.current : 0.0;
+    const double previous = reference_;
+    if (config_->slewRate_V_per_s > 0) {
+        double maxStep = config_->slewRate_V_per_s * dt;
+        reference_ += std::max(-maxStep, std::min(maxStep, target - reference_));
+    } else {
+        reference_ = target;
+    }
+    const double v = reference_;
+    const double r = load_.resistance_ohm;
+    const double decay = (dt == config_->solverStep_us * 1e-6) ? stepDecay_ : loadDecay(load_, dt);
+
+    // Current limiting at any time during the step (OCP)
+    bool limited = false;
+    switch (load_.type) {
+        case LoadType::OPEN:
+            outputVoltage_ = v;
+            outputCurrent_ = 0.0;
+            constantCurrent_ = false;
+            break;
+
+        case LoadType::RESISTIVE:
+            limited = v / r > limit;
+            outputCurrent_ = limited ? limit : v / r;
+            outputVoltage_ = limited ? limit * r : v;
+            constantCurrent_ = limited;
+            break;
+
+        case LoadType::CONSTANT_CURRENT:
+            // An electronic load in CC pulls the voltage down once the supply limits
+            limited = v > 0.0 && load_.current_A > limit;
+            outputVoltage_ = (v <= 0.0 || limited) ? 0.0 : v;
+            outputCurrent_ = (v <= 0.0) ? 0.0 : std::min(load_.current_A, limit);
+            constantCurrent_ = limited;
+            break;
+
+        case LoadType::RC: {
+            double& vc = loadState_;
+            const double ceiling = limit * r;   // Where charging at the limit would end
+            if (vc >= v) {
+                // The supply cannot sink current: C discharges through R down to v
+                vc = std::max(v, vc * decay);
+                outputCurrent_ = (vc <= v) ? v / r : 0.0;
+                constantCurrent_ = false;
+            } else if (v != previous) {
+                // Following a slewing reference takes C dv/dt on top of v / R
+                double required = v / r + load_.capacitance_F * (v - vc) / dt;
+                limited = required > limit;
+                vc = limited ? std::min(v, ceiling + (vc - ceiling) * decay) : v;
+                outputCurrent_ = limited ? limit : required;
+                constantCurrent_ = limited;
+            } else {
+                // Below a constant reference C charges at the limit until it reaches v
+                limited = true;
+                vc = std::min(v, ceiling + (vc - ceiling) * decay);
+                constantCurrent_ = vc < v;
+                outputCurrent_ = constantCurrent_ ? limit : v / r;
+            }
+            outputVoltage_ = vc;
+            break;
+        }
+
+        case LoadType::RL: {
+            double& il = loadState_;
+            double final_A = v / r;
+            il = final_A + (il - final_A) * decay;
+            limited = il > limit;
+            if (limited) {
+                il = limit;
+            }
+            outputCurrent_ = il;
+            outputVoltage_ = limited ? limit * r : v;
+            constantCurrent_ = limited;
+            break;
+        }
+    }
+
+    // Protection latches its STAT:QUES? bit and switches the output off
+    if (state_.outputEnabled && outputVoltage_ > state_.overVoltageProtection) {
+        state_.questionable |= STATUS_OVP;
+        state_.outputEnabled = false;
+    }
+    if (state_.outputEnabled && state_.overCurrentProtection && limited) {
+        state_.questionable |= STATUS_OCP;
+        state_.outputEnabled = false;
+    }
+
+    settled_ = state_.outputEnabled == wasEnabled &&
+               !changed(before[0], reference_) && !changed(before[1], outputVoltage_) &&
+               !changed(before[2], outputCurrent_) && !changed(before[3], loadState_);
+}
+
+double SimulatedDevice::measurement(double value, double rms) {
+    if (rms <= 0) {
+        return value;
+    }
+    // xorshift64 and Box-Muller: a few bytes of state per device
+    auto uniform = [this]() {
+        noise_ ^= noise_ << 13;
+        noise_ ^= noise_ >> 7;
+        noise_ ^= noise_ << 17;
+        return ((noise_ >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+    };
+    double u1 = uniform();
+    double u2 = uniform();
+    return value + rms * std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+}
+
+void SimulatedDevice::process(const std::string& line, std::string& reply) {
+    update(clock().now());
+
+    bool answered = false;
+    size_t begin = 0;
+
+    while (begin <= line.size()) {
+        size_t end = line.find(';', begin);
+        if (end == std::string::npos) {
+            end = line.size();
+        }
+
+        size_t first = line.find_first_not_of(" \t\r", begin);
+        size_t last = line.find_last_not_of(" \t\r", end == 0 ? 0 : end - 1);
+        if (first != std::string::npos && first < end && last >= first) {
+            std::string message = line.substr(first, last - first + 1);
+            bool isQuery = message.back() == '?';
+            std::string answer = execute(message);
+            if (!isQuery) {
+                settled_ = false;   // Setpoints may have changed
+            }
+            if (isQuery) {
+                if (answered) {
+                    reply += ';';
+                }
+                reply += answer;
+                answered = true;
+            }
+        }
+        begin = end + 1;
+    }
+
+    if (answered) {
+        reply += '\n';
+    }
+}
+
+void SimulatedDevice::reset() {
+    state_.voltage = 0.0;
+    state_.current = 0.0;
+    state_.overVoltageProtection = config_->maxVoltage * 1.1;
+    state_.outputEnabled = false;
+    state_.overCurrentProtection = config_->overCurrentProtection;
+}
+
+std::string SimulatedDevice::execute(const std::string& message) {
+    ++messages_;
+
+    if (message == "*IDN?") {
+        const std::string& idn = config_->identification;
+        size_t first = idn.find(',');
+        size_t second = (first == std::string::npos) ? first : idn.find(',', first + 1);
+        if (serial_ == 0 || second == std::string::npos) {
+            return idn;
+        }
+        size_t third = idn.find(',', second + 1);
+        char serial[16];
+        std::snprintf(serial, sizeof(serial), "SIM%06u", static_cast<unsigned>(serial_));
+        return idn.substr(0, second + 1) + serial + (third == std::string::npos ? "" : idn.substr(third));
+    }
+    if (message == "*RST") {
+        reset();
+        return "";
+    }
+    if (message == "*CLS") {
+        state_.questionable = 0;
+        errors_.clear();
+        return "";
+    }
+    if (startsWith(message, "*SAV ") || startsWith(message, "*RCL ")) {
+        int slot = std::atoi(message.c_str() + 5);
+        if (slot < 1 || slot > config_->setupSlots) {
+            pushError("-222,\"Data out of range\"");
+        } else if (message[1] == 'S') {
+            // Slots are allocated on first use; most simulated devices never save
+            slots_.resize(static_cast<size_t>(config_->setupSlots));
+            slots_[slot - 1] = state_;
+        } else {
+            uint32_t questionable = state_.questionable;
+            state_ = slots_.empty() ? SimulatedState() : slots_[slot - 1];
+            state_.questionable = questionable;
+        }
+        return "";
+    }
+
+    if (message == "VOLT?") {
+        return formatValue(state_.voltage);
+    }
+    if (message == "CURR?") {
+        return formatValue(state_.current);
+    }
+    if (message == "VOLT:PROT?") {
+        return formatValue(state_.overVoltageProtection);
+    }
+    if (message == "OUTP?") {
+        return state_.outputEnabled ? "1" : "0";
+    }
+    if (startsWith(message, "MEAS:")) {
+        update(clock().now());      // Setpoints of this line take effect
+    }
+    if (message == "MEAS:VOLT?") {
+        return formatValue(measurement(outputVoltage_, config_->voltageNoise_V));
+    }
+    if (message == "MEAS:CURR?") {
+        return formatValue(measurement(outputCurrent_, config_->currentNoise_A));
+    }
+    if (message == "CURR:PROT:STAT?") {
+        return state_.overCurrentProtection ? "1" : "0";
+    }
+    if (message == "STAT:QUES?") {
+        return std::to_string(state_.questionable);
+    }
+    if (message == "SYST:ERR?") {
+        if (errors_.empty()) {
+            return "0,\"No error\"";
+        }
+        std::string error = errors_.front();
+        errors_.erase(errors_.begin());
+        return error;
+    }
+
+    if (startsWith(message, "CURR:PROT:STAT ")) {
+        std::string argument = message.substr(15);
+        if (argument == "ON" || argument == "1") {
+            state_.overCurrentProtection = true;
+        } else if (argument == "OFF" || argument == "0") {
+            state_.overCurrentProtection = false;
+        } else {
+            pushError("-104,\"Data type error\"");
+        }
+        return "";
+    }
+    if (startsWith(message, "VOLT:PROT ")) {
+        setValue(message.substr(10), config_->maxVoltage * 1.1, state_.overVoltageProtection);
+        return "";
+    }
+    if (startsWith(message, "VOLT ")) {
+        setValue(message.substr(5), config_->maxVoltage, state_.voltage);
+        return "";
+    }
+    if (startsWith(message, "CURR ")) {
+        setValue(message.substr(5), config_->maxCurrent, state_.current);
+        return "";
+    }
+    if (message == "OUTP ON" || message == "OUTP 1") {
+        state_.outputEnabled = true;
+        return "";
+    }
+    if (message == "OUTP OFF" || message == "OUTP 0") {
+        state_.outputEnabled = false;
+        return "";
+    }
+
+    pushError("-100,\"Command error\"");
+    return message.back() == '?' ? "0" : "";
+}
+
+bool SimulatedDevice::setValue(const std::string& argument, double limit, double& target) {
+    char* end = nullptr;
+    double value = std::strtod(argument.c_str(), &end);
+    if (end == argument.c_str()) {
+        pushError("-104,\"Data type error\"");
+        return false;
+    }
+    if (value < 0.0 || value > limit) {
+        pushError("-222,\"Data out of range\"");
+        return false;
+    }
+    target = value;
+    return true;
+}
+
+void SimulatedDevice::pushError(const char* error) {
+    // Bounded like the instrument's error queue
+    if (errors_.size() < 16) {
+        errors_.push_back(error);
+    }
+}
+
+// ==================== G30Simulator ====================
+
+G30Simulator::G30Simulator(const SimulatorConfig& config)
+    : config_(config),
+      device_(config_),
+      listenFd_(-1),
+      wakeFd_(-1),
+      port_(config.port),
+      running_(false) {
+}
+
+G30Simulator::~G30Simulator() {
+    stop();
+}
+
+void G30Simulator::start() {
+    if (running_) {
+        return;
+    }
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        throw G30Exception("Failed to create simulator socket");
+    }
+    int one = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config_.port));
+    if (inet_pton(AF_INET, config_.bindAddress.c_str(), &addr.sin_addr) <= 0 ||
+        bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(listenFd_, 16) < 0) {
+        ::close(listenFd_);
+        listenFd_ = -1;
+        throw G30Exception("Failed to bind simulator to " + config_.bindAddress + ":" +
+                         std::to_string(config_.port) + ": " + std::strerror(errno));
+    }
+
+    socklen_t length = sizeof(addr);
+    getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &length);
+    port_ = ntohs(addr.sin_port);
+
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    running_ = true;
+    server_ = std::thread(&G30Simulator::serve, this);
+}
+
+void G30Simulator::stop() {
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    uint64_t one = 1;
+    if (::write(wakeFd_, &one, sizeof(one)) < 0) {
+        // Counter saturated: the server is already due to wake up
+    }
+    server_.join();
+
+    ::close(wakeFd_);
+    ::close(listenFd_);
+    wakeFd_ = -1;
+    listenFd_ = -1;
+}
+
+SimulatedState G30Simulator::state() const {
+    std::lock_guard<std::mutex> lock(deviceMutex_);
+    device_.update(clock().now());
+    return device_.state();
+}
+
+SimulatedOutput G30Simulator::output() const {
+    std::lock_guard<std::mutex> lock(deviceMutex_);
+    device_.update(clock().now());
+    return device_.output();
+}
+
+void G30Simulator::setLoad(const LoadModel& load) {
+    std::lock_guard<std::mutex> lock(deviceMutex_);
+    device_.update(clock().now());
+    device_.setLoad(load);
+}
+
+void G30Simulator::raiseStatus(uint32_t bits) {
+    std::lock_guard<std::mutex> lock(deviceMutex_);
+    device_.state().questionable |= bits;
+}
+
+uint64_t G30Simulator::messageCount() const {
+    std::lock_guard<std::mutex> lock(deviceMutex_);
+    return device_.messageCount();
+}
+
+void G30Simulator::serve() {
+    struct Client {
+        int fd;
+        std::string rx;
+    };
+    std::vector<Client> clients;
+    std::vector<pollfd> fds;
+    std::string reply;
+    char buffer[4096];
+
+    while (running_) {
+        fds.clear();
+        fds.push_back({wakeFd_, POLLIN, 0});
+        fds.push_back({listenFd_, POLLIN, 0});
+        for (const auto& client : clients) {
+            fds.push_back({client.fd, POLLIN, 0});
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            continue;
+        }
+        if (!running_) {
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                clients.push_back({fd, std::string()});
+            }
+        }
+
+        // Clients accepted above are polled from the next round on
+        size_t polled = fds.size() - 2;
+        for (size_t i = 0; i < polled; ++i) {
+            if (!(fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            Client& client = clients[i];
+            ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                ::close(client.fd);
+                client.fd = -1;
+                continue;
+            }
+            client.rx.append(buffer, static_cast<size_t>(n));
+
+            reply.clear();
+            size_t newline;
+            while ((newline = client.rx.find('\n')) != std::string::npos) {
+                std::lock_guard<std::mutex> lock(deviceMutex_);
+                device_.process(client.rx.substr(0, newline), reply);
+                client.rx.erase(0, newline + 1);
+            }
+
+            if (!reply.empty()) {
+                if (config_.responseDelay_us > 0) {
+                    clock().sleepFor(std::chrono::microseconds(config_.responseDelay_us));
+                }
+                size_t sent = 0;
+                while (sent < reply.size()) {
+                    ssize_t w = send(client.fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+                    if (w <= 0) {
+                        break;
+                    }
+                    sent += static_cast<size_t>(w);
+                }
+            }
+        }
+
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const Client& c) { return c.fd < 0; }),
+                      clients.end());
+    }
+
+    for (const auto& client : clients) {
+        ::close(client.fd);
+    }
+}
+
+} // namespace TDKLambda
@@ -0,0 +1,589 @@
+/**
+ * @file g30_simulator_farm.cpp
+ * @brief Implementation of the simulator farm
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_simulator_farm.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+// Linux/POSIX includes
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace TDKLambda {
+
+namespace {
+
+// Kind of descriptor in the upper half of epoll_event::data.u64
+enum : uint64_t { TAG_WAKE = 0, TAG_TIMER = 1, TAG_LISTEN = 2, TAG_CLIENT = 3 };
+
+// Descriptors the process needs besides the listen sockets
+const size_t kSpareDescriptors = 64;
+
+// Longest line a client may send; longer input closes the connection
+const size_t kMaxLine = 64 * 1024;
+
+uint64_t tag(uint64_t kind, uint64_t index) {
+    return (kind << 32) | index;
+}
+
+// splitmix64: spreads a small seed over all bits; xorshift seeded with 1
+// would start with a run of draws close to zero
+uint64_t scrambleSeed(uint64_t seed) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return z ? z : 1;
+}
+
+// CLOCK_MONOTONIC, the clock of the reply timer
+int64_t monotonicNow_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+} // namespace
+
+// ==================== LatencyProfile ====================
+
+LatencyProfile LatencyProfile::fixed(int us) {
+    LatencyProfile profile;
+    profile.base_us = us;
+    return profile;
+}
+
+LatencyProfile LatencyProfile::lan() {
+    LatencyProfile profile;
+    profile.base_us = 300;
+    profile.jitter_us = 200;
+    return profile;
+}
+
+LatencyProfile LatencyProfile::congested() {
+    LatencyProfile profile;
+    profile.base_us = 2000;
+    profile.jitter_us = 3000;
+    profile.spikeProbability = 0.01;
+    profile.spike_us = 50000;
+    return profile;
+}
+
+LatencyProfile LatencyProfile::flaky() {
+    LatencyProfile profile = lan();
+    profile.spikeProbability = 0.01;
+    profile.spike_us = 200000;
+    profile.dropProbability = 0.005;
+    return profile;
+}
+
+// ==================== SimulatorFarm ====================
+
+SimulatorFarm::SimulatorFarm(const SimulatorFarmConfig& config)
+    : config_(config),
+      random_(scrambleSeed(config.seed)),
+      sequence_(0),
+      armed_ns_(0),
+      epollFd_(-1),
+      wakeFd_(-1),
+      timerFd_(-1),
+      running_(false),
+      messages_(0),
+      replies_(0),
+      dropped_(0),
+      accepted_(0),
+      open_(0),
+      queued_(0) {
+
+    in_addr base;
+    if (config_.devices == 0 || config_.devices > 0xFFFFFFu) {
+        throw G30Exception("Simulator farm needs 1 to 16777215 devices");
+    }
+    if (inet_pton(AF_INET, config_.bindAddress.c_str(), &base) <= 0) {
+        throw G30Exception("Invalid simulator farm address: " + config_.bindAddress);
+    }
+    if (config_.basePort < 0 || config_.basePort > 65535 ||
+        (config_.basePort > 0 && !config_.distinctAddresses && config_.basePort + config_.devices - 1 > 65535)) {
+        throw G30Exception("Simulator farm ports out of range");
+    }
+    if (config_.latency.size() > 65535) {
+        throw G30Exception("Too many latency profiles");
+    }
+    for (const auto& profile : config_.latency) {
+        if (profile.base_us < 0 || profile.jitter_us < 0 || profile.spike_us < 0 ||
+            profile.spikeProbability < 0 || profile.spikeProbability > 1 ||
+            profile.dropProbability < 0 || profile.dropProbability > 1) {
+            throw G30Exception("Invalid latency profile");
+        }
+    }
+
+    devices_.reserve(config_.devices);
+    for (size_t i = 0; i < config_.devices; ++i) {
+        devices_.emplace_back(config_.device);
+        devices_.back().device.setNoiseSeed(config_.device.noiseSeed + i);
+        if (config_.uniqueSerials) {
+            devices_.back().device.setSerialNumber(static_cast<uint32_t>(i + 1));
+        }
+        if (!config_.latency.empty()) {
+            devices_.back().profile = static_cast<uint16_t>(i % config_.latency.size());
+        }
+    }
+}
+
+SimulatorFarm::~SimulatorFarm() {
+    stop();
+}
+
+void SimulatorFarm::start() {
+    if (running_) {
+        return;
+    }
+
+    // One descriptor per device; raise the soft limit as `ulimit -n` would
+    const rlim_t needed = static_cast<rlim_t>(devices_.size() + kSpareDescriptors);
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < needed) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+        if (limit.rlim_cur < needed) {
+            throw G30Exception("Simulator farm needs " + std::to_string(needed) +
+                             " file descriptors; the limit is " + std::to_string(limit.rlim_cur));
+        }
+    }
+
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epollFd_ < 0 || wakeFd_ < 0 || timerFd_ < 0) {
+        closeAll();
+        throw G30Exception("Failed to create simulator farm event loop: " + std::string(std::strerror(errno)));
+    }
+    epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = tag(TAG_WAKE, 0);
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+    ev.data.u64 = tag(TAG_TIMER, 0);
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, timerFd_, &ev);
+
+    for (size_t i = 0; i < devices_.size(); ++i) {
+        Endpoint& endpoint = devices_[i];
+        int requestedPort = config_.basePort == 0 ? 0
+                          : config_.distinctAddresses ? config_.basePort
+                          : config_.basePort + static_cast<int>(i);
+
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(requestedPort));
+        inet_pton(AF_INET, address(i).c_str(), &addr.sin_addr);
+
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        if (fd >= 0) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        }
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 64) < 0) {
+            std::string error = std::strerror(errno);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            closeAll();
+            throw G30Exception("Failed to bind simulated device " + std::to_string(i) + " to " +
+                             address(i) + ":" + std::to_string(requestedPort) + ": " + error);
+        }
+
+        socklen_t length = sizeof(addr);
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length);
+        endpoint.listenFd = fd;
+        endpoint.port = ntohs(addr.sin_port);
+        endpoint.busyUntil_ns = 0;
+
+        ev.data.u64 = tag(TAG_LISTEN, i);
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    running_ = true;
+    server_ = std::thread(&SimulatorFarm::serve, this);
+}
+
+void SimulatorFarm::stop() {
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    uint64_t one = 1;
+    if (::write(wakeFd_, &one, sizeof(one)) < 0) {
+        // Counter saturated: the loop is already due to wake up
+    }
+    server_.join();
+    closeAll();
+}
+
+void SimulatorFarm::closeAll() {
+    for (auto& endpoint : devices_) {
+        if (endpoint.listenFd >= 0) {
+            ::close(endpoint.listenFd);
+            endpoint.listenFd = -1;
+        }
+    }
+    for (size_t fd = 0; fd < connections_.size(); ++fd) {
+        if (connections_[fd].open) {
+            closeConnection(static_cast<int>(fd));
+        }
+    }
+    connections_.clear();
+    pending_ = decltype(pending_)();
+    queued_ = 0;
+    armed_ns_ = 0;
+
+    for (int* fd : {&epollFd_, &wakeFd_, &timerFd_}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+std::string SimulatorFarm::address(size_t device) const {
+    if (device >= devices_.size()) {
+        throw G30Exception("Simulator farm device index out of range");
+    }
+    if (!config_.distinctAddresses) {
+        return config_.bindAddress;
+    }
+    in_addr addr;
+    inet_pton(AF_INET, config_.bindAddress.c_str(), &addr);
+    addr.s_addr = htonl(ntohl(addr.s_addr) + static_cast<uint32_t>(device));
+    char text[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &addr, text, sizeof(text));
+    return text;
+}
+
+int SimulatorFarm::port(size_t device) const {
+    if (device >= devices_.size()) {
+        throw G30Exception("Simulator farm device index out of range");
+    }
+    return devices_[device].port;
+}
+
+G30Config SimulatorFarm::endpointConfig(size_t device, const G30Config& base) const {
+    G30Config config = base;
+    config.ipAddress = address(device);
+    config.tcpPort = port(device);
+    return config;
+}
+
+SimulatedState SimulatorFarm::state(size_t device) const {
+    if (device >= devices_.size()) {
+        throw G30Exception("Simulator farm device index out of range");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    devices_[device].device.update(clock().now());
+    return devices_[device].device.state();
+}
+
+SimulatedOutput SimulatorFarm::output(size_t device) const {
+    if (device >= devices_.size()) {
+        throw G30Exception("Simulator farm device index out of range");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    devices_[device].device.update(clock().now());
+    return devices_[device].device.output();
+}
+
+void SimulatorFarm::setLoad(size_t device, const LoadModel& load) {
+    if (device >= devices_.size()) {
+        throw G30Exception("Simulator farm device index out of range");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    devices_[device].device.update(clock().now());
+    devices_[device].device.setLoad(load);
+}
+
+void SimulatorFarm::raiseStatus(size_t device, uint32_t bits) {
+    if (device >= devices_.size()) {
+        throw G30Exception("Simulator farm device index out of range");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    devices_[device].device.state().questionable |= bits;
+}
+
+void SimulatorFarm::setLatencyProfile(size_t device, size_t profile) {
+    if (device >= devices_.size() || profile >= config_.latency.size()) {
+        throw G30Exception("Simulator farm device or latency profile index out of range");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    devices_[device].profile = static_cast<uint16_t>(profile);
+}
+
+SimulatorFarmStats SimulatorFarm::stats() const {
+    SimulatorFarmStats stats;
+    stats.messages = messages_;
+    stats.replies = replies_;
+    stats.dropped = dropped_;
+    stats.accepted = accepted_;
+    stats.connections = open_;
+    stats.pending = queued_;
+    return stats;
+}
+
+void SimulatorFarm::serve() {
+    epoll_event events[256];
+
+    while (running_) {
+        int n = epoll_wait(epollFd_, events, 256, -1);
+        if (n < 0) {
+            continue;
+        }
+        if (!running_) {
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            uint64_t kind = events[i].data.u64 >> 32;
+            uint32_t index = static_cast<uint32_t>(events[i].data.u64);
+            uint64_t counter;
+
+            switch (kind) {
+                case TAG_WAKE:
+                    if (::read(wakeFd_, &counter, sizeof(counter)) < 0) {
+                        // Already drained
+                    }
+                    break;
+                case TAG_TIMER:
+                    if (::read(timerFd_, &counter, sizeof(counter)) < 0) {
+                        // Rearmed before it was read
+                    }
+                    armed_ns_ = 0;
+                    break;
+                case TAG_LISTEN:
+                    acceptConnections(index);
+                    break;
+                default:
+                    if (events[i].events & EPOLLOUT) {
+                        flush(static_cast<int>(index));
+                    }
+                    if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                        receive(static_cast<int>(index));
+                    }
+                    break;
+            }
+        }
+
+        dispatchDue(monotonicNow_ns());
+        armTimer();
+    }
+}
+
+void SimulatorFarm::acceptConnections(size_t device) {
+    for (;;) {
+        int fd = accept4(devices_[device].listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;     // Backlog drained (or out of descriptors: retried on the next event)
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (static_cast<size_t>(fd) >= connections_.size()) {
+            connections_.resize(static_cast<size_t>(fd) + 1);
+        }
+        Connection& connection = connections_[fd];
+        connection.device = static_cast<uint32_t>(device);
+        ++connection.generation;
+        connection.open = true;
+
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u64 = tag(TAG_CLIENT, static_cast<uint64_t>(fd));
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+        ++accepted_;
+        ++open_;
+    }
+}
+
+void SimulatorFarm::receive(int fd) {
+    if (static_cast<size_t>(fd) >= connections_.size() || !connections_[fd].open) {
+        return;
+    }
+    Connection& connection = connections_[fd];
+
+    char buffer[4096];
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return;
+    }
+    if (n <= 0) {
+        closeConnection(fd);
+        return;
+    }
+    connection.rx.append(buffer, static_cast<size_t>(n));
+
+    Endpoint& endpoint = devices_[connection.device];
+    std::string reply;
+    size_t begin = 0;
+    size_t newline;
+    while (connection.open && (newline = connection.rx.find('\n', begin)) != std::string::npos) {
+        reply.clear();
+        size_t profile;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            endpoint.device.process(connection.rx.substr(begin, newline - begin), reply);
+            profile = endpoint.profile;
+        }
+        ++messages_;
+        begin = newline + 1;
+        if (reply.empty()) {
+            continue;
+        }
+
+        if (config_.latency.empty()) {
+            ++replies_;
+            transmit(fd, reply.data(), reply.size());
+            continue;
+        }
+
+        bool drop = false;
+        int64_t delay = latency_ns(config_.latency[profile], drop);
+        if (drop) {
+            ++dropped_;
+            continue;
+        }
+        // The device parses one message at a time: a reply waits for the previous one
+        int64_t due = std::max(monotonicNow_ns(), endpoint.busyUntil_ns) + delay;
+        endpoint.busyUntil_ns = due;
+        pending_.push(PendingReply{due, sequence_++, fd, connection.generation, reply});
+        ++queued_;
+    }
+
+    if (connection.open) {
+        connection.rx.erase(0, begin);
+        if (connection.rx.size() > kMaxLine) {
+            closeConnection(fd);
+        }
+    }
+}
+
+void SimulatorFarm::transmit(int fd, const char* data, size_t length) {
+    Connection& connection = connections_[fd];
+    if (!connection.tx.empty()) {
+        connection.tx.append(data, length);
+        return;
+    }
+
+    ssize_t sent = ::send(fd, data, length, MSG_NOSIGNAL);
+    if (sent < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            closeConnection(fd);
+            return;
+        }
+        sent = 0;
+    }
+    if (static_cast<size_t>(sent) < length) {
+        // Socket buffer full: keep the rest until the client reads
+        connection.tx.assign(data + sent, length - static_cast<size_t>(sent));
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLOUT;
+        ev.data.u64 = tag(TAG_CLIENT, static_cast<uint64_t>(fd));
+        epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
+    }
+}
+
+void SimulatorFarm::flush(int fd) {
+    if (static_cast<size_t>(fd) >= connections_.size() || !connections_[fd].open) {
+        return;
+    }
+    Connection& connection = connections_[fd];
+    while (!connection.tx.empty()) {
+        ssize_t sent = ::send(fd, connection.tx.data(), connection.tx.size(), MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                closeConnection(fd);
+            }
+            return;
+        }
+        connection.tx.erase(0, static_cast<size_t>(sent));
+    }
+    epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u64 = tag(TAG_CLIENT, static_cast<uint64_t>(fd));
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void SimulatorFarm::closeConnection(int fd) {
+    Connection& connection = connections_[fd];
+    ::close(fd);
+    connection.open = false;
+    // Release the buffers; an idle farm holds no per-connection memory
+    std::string().swap(connection.rx);
+    std::string().swap(connection.tx);
+    --open_;
+}
+
+void SimulatorFarm::dispatchDue(int64_t now_ns) {
+    while (!pending_.empty() && pending_.top().due_ns <= now_ns) {
+        PendingReply reply = pending_.top();
+        pending_.pop();
+        --queued_;
+
+        // Skip replies for connections closed (and descriptors reused) meanwhile
+        Connection& connection = connections_[reply.fd];
+        if (connection.open && connection.generation == reply.generation) {
+            ++replies_;
+            transmit(reply.fd, reply.text.data(), reply.text.size());
+        }
+    }
+}
+
+void SimulatorFarm::armTimer() {
+    int64_t due = pending_.empty() ? 0 : pending_.top().due_ns;
+    if (due == armed_ns_) {
+        return;
+    }
+    // An absolute expiry in the past fires at once; zero disarms the timer
+    itimerspec spec;
+    std::memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = static_cast<time_t>(due / 1000000000);
+    spec.it_value.tv_nsec = static_cast<long>(due % 1000000000);
+    timerfd_settime(timerFd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+    armed_ns_ = due;
+}
+
+int64_t SimulatorFarm::latency_ns(const LatencyProfile& profile, bool& drop) {
+    drop = profile.dropProbability > 0 && uniform() < profile.dropProbability;
+    double us = profile.base_us;
+    if (profile.jitter_us > 0) {
+        us += uniform() * profile.jitter_us;
+    }
+    if (profile.spikeProbability > 0 && uniform() < profile.spikeProbability) {
+        us += profile.spike_us;
+    }
+    return static_cast<int64_t>(us * 1000.0);
+}
+
+double SimulatorFarm::uniform() {
+    random_ ^= random_ << 13;
+    random_ ^= random_ >> 7;
+    random_ ^= random_ << 17;
+    return (random_ >> 11) * (1.0 / 9007199254740992.0);
+}
+
+} // namespace TDKLambda
@@ -0,0 +1,317 @@
+/**
+ * @file g30_sweep.cpp
+ * @brief Implementation of the V/I characterization sweep engine
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_sweep.h"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <sstream>
+#include <thread>
+
+namespace TDKLambda {
+
+namespace {
+
+std::string formatSetpoint(const char* header, double value) {
+    std::ostringstream oss;
+    oss.precision(3);
+    oss << std::fixed << header << " " << value;
+    return oss.str();
+}
+
+double parseReading(const std::string& response) {
+    try {
+        return std::stod(response);
+    } catch (const std::exception&) {
+        throw G30Exception("Failed to parse numeric response: '" + response + "'");
+    }
+}
+
+} // namespace
+
+// ==================== SweepAxis / SweepPlan ====================
+
+std::vector<double> SweepAxis::values() const {
+    if (points < 1) {
+        throw G30Exception("Sweep axis needs at least one point");
+    }
+
+    std::vector<double> result;
+    result.reserve(points);
+
+    if (points == 1) {
+        result.push_back(start);
+        return result;
+    }
+
+    if (spacing == SweepSpacing::LOGARITHMIC) {
+        if (start <= 0 || stop <= 0) {
+            throw G30Exception("Logarithmic sweep axis needs positive start and stop");
+        }
+        double logStart = std::log10(start);
+        double logStep = (std::log10(stop) - logStart) / (points - 1);
+        for (int i = 0; i < points; ++i) {
+            result.push_back(std::pow(10.0, logStart + logStep * i));
+        }
+    } else {
+        double step = (stop - start) / (points - 1);
+        for (int i = 0; i < points; ++i) {
+            result.push_back(start + step * i);
+        }
+    }
+
+    // Land exactly on the requested end point
+    result.back() = stop;
+    return result;
+}
+
+SweepPlan SweepPlan::grid(const SweepAxis& voltage, const SweepAxis& current) {
+    SweepPlan plan;
+    std::vector<double> volts = voltage.values();
+    std::vector<double> amps = current.values();
+    plan.points_.reserve(volts.size() * amps.size());
+    for (double i : amps) {
+        for (double v : volts) {
+            plan.points_.emplace_back(v, i);
+        }
+    }
+    return plan;
+}
+
+SweepPlan SweepPlan::fromPoints(const std::vector<SweepPoint>& points) {
+    SweepPlan plan;
+    plan.points_ = points;
+    return plan;
+}
+
+SweepPlan& SweepPlan::refine(const AdaptiveRefinement& refinement) {
+    refinement_ = refinement;
+    refinement_.enabled = true;
+    return *this;
+}
+
+// ==================== SweepTable ====================
+
+SweepTable::SweepTable(SweepTable&& other) noexcept
+    : device(std::move(other.device)),
+      setVoltage(std::move(other.setVoltage)),
+      setCurrent(std::move(other.setCurrent)),
+      measVoltage(std::move(other.measVoltage)),
+      measCurrent(std::move(other.measCurrent)),
+      time_ms(std::move(other.time_ms)) {
+}
+
+SweepTable& SweepTable::operator=(SweepTable&& other) noexcept {
+    if (this != &other) {
+        device = std::move(other.device);
+        setVoltage = std::move(other.setVoltage);
+        setCurrent = std::move(other.setCurrent);
+        measVoltage = std::move(other.measVoltage);
+        measCurrent = std::move(other.measCurrent);
+        time_ms = std::move(other.time_ms);
+    }
+    return *this;
+}
+
+void SweepTable::append(const SweepRow& row) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    device.push_back(row.device);
+    setVoltage.push_back(row.setVoltage);
+    setCurrent.push_back(row.setCurrent);
+    measVoltage.push_back(row.measVoltage);
+    measCurrent.push_back(row.measCurrent);
+    time_ms.push_back(row.time_ms);
+}
+
+void SweepTable::reserve(size_t rows) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    device.reserve(rows);
+    setVoltage.reserve(rows);
+    setCurrent.reserve(rows);
+    measVoltage.reserve(rows);
+    measCurrent.reserve(rows);
+    time_ms.reserve(rows);
+}
+
+// ==================== SweepEngine ====================
+
+SweepEngine::SweepEngine(const std::vector<TDKLambdaG30*>& supplies, const SweepConfig& config)
+    : supplies_(supplies),
+      config_(config) {
+
+    if (supplies_.empty()) {
+        throw G30Exception("Sweep engine needs at least one supply");
+    }
+    for (auto* psu : supplies_) {
+        if (!psu) {
+            throw G30Exception("Sweep engine supply list contains null");
+        }
+    }
+    if (config_.settle_ms < 0) {
+        throw G30Exception("Settle time cannot be negative");
+    }
+}
+
+void SweepEngine::setRowCallback(std::function<void(const SweepRow&)> callback) {
+    rowCallback_ = callback;
+}
+
+SweepTable SweepEngine::run(const SweepPlan& plan) {
+    if (plan.size() == 0) {
+        throw G30Exception("Sweep plan is empty");
+    }
+
+    for (size_t d = 0; d < supplies_.size(); ++d) {
+        for (const auto& p : plan.points()) {
+            if (p.voltage < 0 || p.voltage > supplies_[d]->getMaxVoltage() ||
+                p.current < 0 || p.current > supplies_[d]->getMaxCurrent()) {
+                throw G30Exception("Sweep point (" + std::to_string(p.voltage) + "V, " +
+                                 std::to_string(p.current) + "A) out of range for supply " +
+                                 std::to_string(d));
+            }
+        }
+    }
+
+    SweepTable table;
+    table.reserve(plan.size() * supplies_.size());
+    // Workers hold the clock, so a virtual clock keeps their settle times exact;
+    // so does this thread until all of them are running
+    IClock& clock = supplies_.front()->clock();
+    clock.hold();
+    auto t0 = clock.now();
+
+    std::vector<std::future<void>> workers;
+    workers.reserve(supplies_.size());
+    for (size_t d = 0; d < supplies_.size(); ++d) {
+        clock.hold();
+        workers.push_back(std::async(std::launch::async, [this, d, &plan, &table, t0, &clock]() {
+            ClockHold hold(clock, std::adopt_lock);
+            std::vector<SweepRow> rows = runDevice(d, plan.points(), table, t0);
+
+            const AdaptiveRefinement& refinement = plan.refinement();
+            if (!refinement.enabled) {
+                return;
+            }
+
+            for (int depth = 0; depth < refinement.maxDepth; ++depth) {
+                // Midpoints between neighbours whose response changed too much
+                std::vector<SweepPoint> extra;
+                std::vector<size_t> insertAfter;
+                for (size_t k = 0; k + 1 < rows.size(); ++k) {
+                    // Only refine along one axis; grid row wrap-arounds are not neighbours
+                    if (rows[k + 1].setVoltage != rows[k].setVoltage &&
+                        rows[k + 1].setCurrent != rows[k].setCurrent) {
+                        continue;
+                    }
+                    if (std::abs(rows[k + 1].measVoltage - rows[k].measVoltage) > refinement.maxVoltageStep ||
+                        std::abs(rows[k + 1].measCurrent - rows[k].measCurrent) > refinement.maxCurrentStep) {
+                        extra.emplace_back((rows[k].setVoltage + rows[k + 1].setVoltage) / 2,
+                                           (rows[k].setCurrent + rows[k + 1].setCurrent) / 2);
+                        insertAfter.push_back(k);
+                    }
+                }
+                if (extra.empty()) {
+                    break;
+                }
+
+                std::vector<SweepRow> added = runDevice(d, extra, table, t0);
+
+                std::vector<SweepRow> merged;
+                merged.reserve(rows.size() + added.size());
+                size_t next = 0;
+                for (size_t k = 0; k < rows.size(); ++k) {
+                    merged.push_back(rows[k]);
+                    if (next < insertAfter.size() && insertAfter[next] == k) {
+                        merged.push_back(added[next++]);
+                    }
+                }
+                rows.swap(merged);
+            }
+        }));
+    }
+    clock.release();
+
+    std::string failure;
+    for (size_t d = 0; d < workers.size(); ++d) {
+        try {
+            workers[d].get();
+        } catch (const std::exception& e) {
+            if (failure.empty()) {
+                failure = "Sweep failed on supply " + std::to_string(d) + ": " + e.what();
+            }
+        }
+    }
+    if (!failure.empty()) {
+        throw G30Exception(failure);
+    }
+
+    return table;
+}
+
+std::vector<SweepRow> SweepEngine::runDevice(size_t index, const std::vector<SweepPoint>& points,
+                                             SweepTable& table,
+                                             std::chrono::steady_clock::time_point t0) const {
+    TDKLambdaG30* psu = supplies_[index];
+    IClock& clock = supplies_.front()->clock();     // Timebase of t0
+    const std::vector<std::string> measureQueries = {"MEAS:VOLT?", "MEAS:CURR?"};
+
+    std::vector<SweepRow> rows;
+    rows.reserve(points.size());
+
+    psu->sendBatch({formatSetpoint("VOLT", points[0].voltage),
+                    formatSetpoint("CURR", points[0].current)});
+    if (config_.enableOutput) {
+        psu->enableOutput(true);
+    }
+
+    try {
+        for (size_t k = 0; k < points.size(); ++k) {
+            clock.sleepFor(std::chrono::milliseconds(config_.settle_ms));
+
+            std::vector<std::string> readings = psu->sendQueries(measureQueries);
+            auto now = clock.now();
+
+            // Next point's setpoints go out right behind the measurement
+            if (k + 1 < points.size()) {
+                psu->sendBatch({formatSetpoint("VOLT", points[k + 1].voltage),
+                                formatSetpoint("CURR", points[k + 1].current)});
+            }
+
+            SweepRow row;
+            row.device = index;
+            row.setVoltage = points[k].voltage;
+            row.setCurrent = points[k].current;
+            row.measVoltage = parseReading(readings[0]);
+            row.measCurrent = parseReading(readings[1]);
+            row.time_ms = std::chrono::duration<double, std::milli>(now - t0).count();
+
+            table.append(row);
+            if (rowCallback_) {
+                rowCallback_(row);
+            }
+            rows.push_back(row);
+        }
+    } catch (...) {
+        // Never leave a failed sweep powering the DUT
+        if (config_.enableOutput) {
+            try {
+                psu->enableOutput(false);
+            } catch (const std::exception&) {
+                // Report the original failure
+            }
+        }
+        throw;
+    }
+
+    if (config_.enableOutput) {
+        psu->enableOutput(false);
+    }
+
+    return rows;
+}
+
+} // namespace TDKLambda
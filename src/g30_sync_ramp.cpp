@@ -0,0 +1,198 @@
+/**
+ * @file g30_sync_ramp.cpp
+ * @brief Implementation of lock-step synchronized ramps
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_sync_ramp.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace TDKLambda {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+std::string formatSetpoint(double voltage) {
+    std::ostringstream oss;
+    oss.precision(3);
+    oss << std::fixed << "VOLT " << voltage;
+    return oss.str();
+}
+
+double parseReading(const std::string& response) {
+    try {
+        return std::stod(response);
+    } catch (const std::exception&) {
+        throw G30Exception("Invalid measurement response: '" + response + "'");
+    }
+}
+
+} // namespace
+
+SynchronizedRamp::SynchronizedRamp(const std::vector<TDKLambdaG30*>& supplies,
+                                   const SyncRampConfig& config)
+    : supplies_(supplies),
+      config_(config) {
+
+    if (supplies_.empty()) {
+        throw G30Exception("Synchronized ramp needs at least one supply");
+    }
+    for (auto* psu : supplies_) {
+        if (!psu) {
+            throw G30Exception("Synchronized ramp supply list contains null");
+        }
+    }
+    if (config_.stepInterval_ms <= 0) {
+        throw G30Exception("Step interval must be positive");
+    }
+}
+
+SyncRampResult SynchronizedRamp::rampVoltage(const std::vector<double>& targets, double rampRate) {
+    if (targets.size() != supplies_.size()) {
+        throw G30Exception("Target count does not match supply count");
+    }
+    if (rampRate <= 0) {
+        throw G30Exception("Ramp rate must be positive");
+    }
+
+    const size_t n = supplies_.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (targets[i] < 0 || targets[i] > supplies_[i]->getMaxVoltage()) {
+            throw G30Exception("Target " + std::to_string(targets[i]) +
+                             "V out of range for supply " + std::to_string(i));
+        }
+    }
+
+    // Workers hold the clock, so a virtual clock keeps them in lock step. This
+    // thread holds it too while launching them: a worker that starts sleeping
+    // first must not let virtual time pass before the others are running.
+    IClock& clock = supplies_.front()->clock();
+
+    // Read start points concurrently
+    std::vector<std::future<double>> startReads;
+    clock.hold();
+    for (auto* psu : supplies_) {
+        clock.hold();
+        startReads.push_back(std::async(std::launch::async, [psu, &clock]() {
+            ClockHold hold(clock, std::adopt_lock);
+            return psu->getVoltage();
+        }));
+    }
+    clock.release();
+    std::vector<double> start(n);
+    for (size_t i = 0; i < n; ++i) {
+        start[i] = startReads[i].get();
+    }
+
+    // The rail with the largest excursion determines the step count
+    double maxDelta = 0;
+    for (size_t i = 0; i < n; ++i) {
+        maxDelta = std::max(maxDelta, std::abs(targets[i] - start[i]));
+    }
+    double duration_s = maxDelta / rampRate;
+    int steps = std::max(1, static_cast<int>(std::ceil(duration_s * 1000.0 / config_.stepInterval_ms)));
+
+    SyncRampResult result;
+    result.steps.resize(steps);
+    for (int s = 0; s < steps; ++s) {
+        SyncRampStep& step = result.steps[s];
+        step.index = s;
+        step.setpoints.resize(n);
+        double fraction = static_cast<double>(s + 1) / steps;
+        for (size_t i = 0; i < n; ++i) {
+            step.setpoints[i] = (s + 1 == steps) ? targets[i]
+                                                 : start[i] + (targets[i] - start[i]) * fraction;
+        }
+        if (config_.measureTracking) {
+            step.measured.resize(n);
+        }
+    }
+
+    // One worker per supply walks all steps on the shared timebase: step s
+    // is due at t0 + s * interval. The setpoint is a single write and the
+    // readback one pipelined query, so a step costs one round trip instead
+    // of the driver's settling delays; a step that still overruns shows up
+    // as lateness of the next one.
+    std::vector<std::vector<Clock::time_point>> dispatched(steps, std::vector<Clock::time_point>(n));
+    std::atomic<bool> aborted(false);
+    std::mutex failureMutex;
+    std::string failure;
+    const std::vector<std::string> readback = {"MEAS:VOLT?"};
+
+    std::vector<std::future<void>> workers;
+    workers.reserve(n);
+    clock.hold();
+    auto t0 = clock.now();
+    for (size_t i = 0; i < n; ++i) {
+        clock.hold();
+        workers.push_back(std::async(std::launch::async, [&, i]() {
+            ClockHold hold(clock, std::adopt_lock);
+            TDKLambdaG30* psu = supplies_[i];
+            int s = 0;
+            try {
+                for (; s < steps && !aborted; ++s) {
+                    clock.sleepUntil(t0 + std::chrono::milliseconds(
+                        static_cast<long long>(s) * config_.stepInterval_ms));
+                    dispatched[s][i] = clock.now();
+                    psu->sendBatch({formatSetpoint(result.steps[s].setpoints[i])});
+                    if (config_.measureTracking) {
+                        result.steps[s].measured[i] = parseReading(psu->sendQueries(readback)[0]);
+                    }
+                }
+            } catch (const std::exception& e) {
+                aborted = true;
+                std::lock_guard<std::mutex> lock(failureMutex);
+                if (failure.empty()) {
+                    failure = "Supply " + std::to_string(i) + " failed at step " +
+                              std::to_string(s) + ": " + e.what();
+                }
+            }
+        }));
+    }
+    clock.release();
+    for (auto& worker : workers) {
+        worker.get();
+    }
+    if (!failure.empty()) {
+        throw G30Exception(failure);
+    }
+
+    for (int s = 0; s < steps; ++s) {
+        SyncRampStep& step = result.steps[s];
+        const std::vector<Clock::time_point>& stamps = dispatched[s];
+        auto first = *std::min_element(stamps.begin(), stamps.end());
+        auto last = *std::max_element(stamps.begin(), stamps.end());
+        step.skew_ms = elapsedMs(first, last);
+        step.lateness_ms = elapsedMs(t0 + std::chrono::milliseconds(
+            static_cast<long long>(s) * config_.stepInterval_ms), last);
+
+        if (config_.measureTracking) {
+            for (size_t i = 0; i < n; ++i) {
+                step.trackingError = std::max(step.trackingError,
+                                              std::abs(step.measured[i] - step.setpoints[i]));
+            }
+        }
+
+        result.maxSkew_ms = std::max(result.maxSkew_ms, step.skew_ms);
+        result.maxLateness_ms = std::max(result.maxLateness_ms, step.lateness_ms);
+        result.maxTrackingError = std::max(result.maxTrackingError, step.trackingError);
+    }
+
+    result.duration_ms = elapsedMs(t0, clock.now());
+    return result;
+}
+
+} // namespace TDKLambda
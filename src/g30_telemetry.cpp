@@ -0,0 +1,128 @@
+/**
+ * @file g30_telemetry.cpp
+ * @brief Implementation of the telemetry sampler
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_telemetry.h"
+#include <chrono>
+
+namespace TDKLambda {
+
+TelemetrySampler::TelemetrySampler(const std::vector<TDKLambdaG30*>& supplies,
+                                   const TelemetryConfig& config)
+    : supplies_(supplies),
+      config_(config),
+      running_(false),
+      errors_(0),
+      latest_(supplies.size()) {
+
+    if (supplies_.empty()) {
+        throw G30Exception("Telemetry sampler needs at least one supply");
+    }
+    for (auto* psu : supplies_) {
+        if (!psu) {
+            throw G30Exception("Telemetry sampler supply list contains null");
+        }
+    }
+    if (config_.period_ms <= 0) {
+        throw G30Exception("Sampling period must be positive");
+    }
+    for (size_t d = 0; d < latest_.size(); ++d) {
+        latest_[d].device = static_cast<uint32_t>(d);
+    }
+}
+
+TelemetrySampler::~TelemetrySampler() {
+    stop();
+}
+
+void TelemetrySampler::addSink(std::shared_ptr<ITelemetrySink> sink) {
+    if (running_) {
+        throw G30Exception("Cannot add telemetry sinks while sampling");
+    }
+    if (sink) {
+        sinks_.push_back(std::move(sink));
+    }
+}
+
+void TelemetrySampler::start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+
+    threads_.reserve(supplies_.size());
+    for (size_t d = 0; d < supplies_.size(); ++d) {
+        threads_.emplace_back(&TelemetrySampler::sampleLoop, this, d);
+    }
+}
+
+void TelemetrySampler::stop() {
+    running_ = false;
+    for (auto& t : threads_) {
+        if (t.joinable()) {
+            t.join();
+        }
+    }
+    threads_.clear();
+}
+
+TelemetrySample TelemetrySampler::latest(size_t device) const {
+    if (device >= latest_.size()) {
+        throw G30Exception("Telemetry device index out of range");
+    }
+    std::lock_guard<std::mutex> lock(latestMutex_);
+    return latest_[device];
+}
+
+void TelemetrySampler::sampleLoop(size_t device) {
+    TDKLambdaG30* psu = supplies_[device];
+    const std::vector<std::string> queries = config_.readStatus
+        ? std::vector<std::string>{"MEAS:VOLT?", "MEAS:CURR?", "STAT:QUES?", "OUTP?"}
+        : std::vector<std::string>{"MEAS:VOLT?", "MEAS:CURR?"};
+
+    uint64_t sequence = 0;
+    auto next = std::chrono::steady_clock::now();
+
+    while (running_) {
+        TelemetrySample sample;
+        sample.device = static_cast<uint32_t>(device);
+        sample.sequence = sequence++;
+
+        try {
+            std::vector<std::string> r = psu->sendQueries(queries);
+            sample.voltage = std::stod(r[0]);
+            sample.current = std::stod(r[1]);
+            sample.power = sample.voltage * sample.current;
+            if (config_.readStatus) {
+                sample.status = static_cast<uint32_t>(std::stod(r[2]));
+                sample.outputEnabled = (r[3] == "1" || r[3] == "ON");
+            }
+            sample.valid = true;
+        } catch (const std::exception&) {
+            ++errors_;
+        }
+
+        sample.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        {
+            std::lock_guard<std::mutex> lock(latestMutex_);
+            latest_[device] = sample;
+        }
+        for (auto& sink : sinks_) {
+            sink->onSample(sample);
+        }
+
+        next += std::chrono::milliseconds(config_.period_ms);
+        auto now = std::chrono::steady_clock::now();
+        if (next < now) {
+            // Fell behind (slow device); restart the schedule instead of bursting
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+} // namespace TDKLambda
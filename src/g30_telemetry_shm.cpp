@@ -0,0 +1,245 @@
+/**
+ * @file g30_telemetry_shm.cpp
+ * @brief Implementation of shared-memory telemetry publication
+ * @version 1.0.0
+ * @date 2025-11-24
+ */
+
+#include "../include/g30_telemetry_shm.h"
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+// Linux/POSIX includes
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TDKLambda {
+
+#if ATOMIC_LLONG_LOCK_FREE != 2 || ATOMIC_INT_LOCK_FREE != 2
+#error "Shared-memory telemetry requires lock-free 32/64-bit atomics"
+#endif
+
+namespace {
+
+uint64_t toBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Check whether an existing segment was left by a publisher that has exited
+ */
+bool isAbandonedSegment(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return errno == ENOENT;
+    }
+
+    struct stat st;
+    bool abandoned = false;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(TelemetryShm::Header)) {
+        void* base = mmap(nullptr, sizeof(TelemetryShm::Header), PROT_READ, MAP_SHARED, fd, 0);
+        if (base != MAP_FAILED) {
+            const TelemetryShm::Header* header = static_cast<const TelemetryShm::Header*>(base);
+            pid_t pid = static_cast<pid_t>(header->publisherPid);
+            // Only our own layout with a recorded owner that no longer exists
+            abandoned = header->magic == TelemetryShm::kMagic && pid > 0 &&
+                        ::kill(pid, 0) < 0 && errno == ESRCH;
+            munmap(base, sizeof(TelemetryShm::Header));
+        }
+    }
+    ::close(fd);
+    return abandoned;
+}
+
+} // namespace
+
+// ==================== Publisher ====================
+
+TelemetryShmPublisher::TelemetryShmPublisher(const std::string& name, size_t slotCount, bool unlinkOnClose)
+    : name_(name),
+      unlinkOnClose_(unlinkOnClose),
+      mappedSize_(sizeof(TelemetryShm::Header) + slotCount * sizeof(TelemetryShm::Slot)),
+      header_(nullptr),
+      slots_(nullptr) {
+
+    if (slotCount == 0) {
+        throw G30Exception("Telemetry segment needs at least one slot");
+    }
+
+    // Always a fresh segment, so readers never see a stale layout. A name
+    // still in use by a live publisher (or another program) is left alone.
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        if (!isAbandonedSegment(name_)) {
+            throw G30Exception("Shared memory " + name_ + " is in use by another publisher");
+        }
+        shm_unlink(name_.c_str());
+        fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0) {
+        throw G30Exception("Failed to create shared memory " + name_ + ": " + std::strerror(errno));
+    }
+    if (ftruncate(fd, static_cast<off_t>(mappedSize_)) < 0) {
+        ::close(fd);
+        shm_unlink(name_.c_str());
+        throw G30Exception("Failed to size shared memory " + name_);
+    }
+
+    void* base = mmap(nullptr, mappedSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name_.c_str());
+        throw G30Exception("Failed to map shared memory " + name_);
+    }
+
+    // ftruncate zero-fills, so every slot starts with seq == 0 (never published)
+    header_ = static_cast<TelemetryShm::Header*>(base);
+    slots_ = reinterpret_cast<TelemetryShm::Slot*>(header_ + 1);
+    for (size_t i = 0; i < slotCount; ++i) {
+        slots_[i].device = static_cast<uint32_t>(i);
+    }
+    header_->slotCount = static_cast<uint32_t>(slotCount);
+    header_->slotSize = sizeof(TelemetryShm::Slot);
+    header_->version = TelemetryShm::kVersion;
+    header_->publisherPid = static_cast<uint32_t>(::getpid());
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = TelemetryShm::kMagic;
+}
+
+TelemetryShmPublisher::~TelemetryShmPublisher() {
+    if (header_) {
+        munmap(header_, mappedSize_);
+    }
+    if (unlinkOnClose_) {
+        shm_unlink(name_.c_str());
+    }
+}
+
+void TelemetryShmPublisher::onSample(const TelemetrySample& sample) {
+    if (sample.device >= header_->slotCount) {
+        return;
+    }
+
+    TelemetryShm::Slot& slot = slots_[sample.device];
+    uint32_t seq = slot.seq.load(std::memory_order_relaxed);
+
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.sequence.store(sample.sequence, std::memory_order_relaxed);
+    slot.timestamp_ns.store(static_cast<uint64_t>(sample.timestamp_ns), std::memory_order_relaxed);
+    slot.voltageBits.store(toBits(sample.voltage), std::memory_order_relaxed);
+    slot.currentBits.store(toBits(sample.current), std::memory_order_relaxed);
+    slot.powerBits.store(toBits(sample.power), std::memory_order_relaxed);
+    slot.statusWord.store(static_cast<uint64_t>(sample.status) |
+                          (static_cast<uint64_t>(sample.outputEnabled) << 32) |
+                          (static_cast<uint64_t>(sample.valid) << 33),
+                          std::memory_order_relaxed);
+
+    slot.seq.store(seq + 2, std::memory_order_release);
+    header_->publishCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ==================== Reader ====================
+
+TelemetryShmReader::TelemetryShmReader(const std::string& name)
+    : mappedSize_(0),
+      slotCount_(0),
+      header_(nullptr),
+      slots_(nullptr) {
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw G30Exception("Failed to open shared memory " + name + ": " + std::strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(TelemetryShm::Header)) {
+        ::close(fd);
+        throw G30Exception("Shared memory " + name + " is too small");
+    }
+
+    mappedSize_ = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, mappedSize_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw G30Exception("Failed to map shared memory " + name);
+    }
+
+    header_ = static_cast<const TelemetryShm::Header*>(base);
+    if (header_->magic != TelemetryShm::kMagic || header_->version != TelemetryShm::kVersion ||
+        header_->slotSize != sizeof(TelemetryShm::Slot) ||
+        mappedSize_ < sizeof(TelemetryShm::Header) + header_->slotCount * sizeof(TelemetryShm::Slot)) {
+        munmap(const_cast<TelemetryShm::Header*>(header_), mappedSize_);
+        throw G30Exception("Shared memory " + name + " has an unknown telemetry layout");
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    slotCount_ = header_->slotCount;
+    slots_ = reinterpret_cast<const TelemetryShm::Slot*>(header_ + 1);
+}
+
+TelemetryShmReader::~TelemetryShmReader() {
+    if (header_) {
+        munmap(const_cast<TelemetryShm::Header*>(header_), mappedSize_);
+    }
+}
+
+bool TelemetryShmReader::read(size_t device, TelemetrySample& sample) const {
+    if (device >= slotCount_) {
+        return false;
+    }
+
+    const TelemetryShm::Slot& slot = slots_[device];
+    for (int attempt = 0; attempt < TelemetryShm::kMaxReadRetries; ++attempt) {
+        uint32_t before = slot.seq.load(std::memory_order_acquire);
+        if (before == 0) {
+            return false;
+        }
+        if (before & 1) {
+            std::this_thread::yield();     // Writer in progress (it may be preempted)
+            continue;
+        }
+
+        TelemetrySample copy;
+        copy.device = slot.device;
+        copy.sequence = slot.sequence.load(std::memory_order_relaxed);
+        copy.timestamp_ns = static_cast<int64_t>(slot.timestamp_ns.load(std::memory_order_relaxed));
+        copy.voltage = fromBits(slot.voltageBits.load(std::memory_order_relaxed));
+        copy.current = fromBits(slot.currentBits.load(std::memory_order_relaxed));
+        copy.power = fromBits(slot.powerBits.load(std::memory_order_relaxed));
+        uint64_t word = slot.statusWord.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != before) {
+            continue;   // Torn read, retry
+        }
+
+        copy.status = static_cast<uint32_t>(word & 0xFFFFFFFFu);
+        copy.outputEnabled = ((word >> 32) & 1) != 0;
+        copy.valid = ((word >> 33) & 1) != 0;
+        sample = copy;
+        return true;
+    }
+
+    // Writer stalled or died inside an update
+    return false;
+}
+
+uint64_t TelemetryShmReader::publishCount() const {
+    return header_->publishCount.load(std::memory_order_relaxed);
+}
+
+} // namespace TDKLambda
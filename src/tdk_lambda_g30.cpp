@@ -8,17 +8,22 @@
 #include "../include/tdk_lambda_g30.h"
 #include <sstream>
 #include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <mutex>
+#include <random>
 
 // Linux/POSIX includes
 #include <fcntl.h>
 #include <unistd.h>
 #include <cstring>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <errno.h>
@@ -31,7 +36,7 @@ namespace TDKLambda {
 /**
  * @brief TCP/IP port implementation for Ethernet communication
  */
-class TcpPort : public ICommunication {
+class TcpPort : public ICommunicationV2 {
 public:
     TcpPort(const G30Config& config)
         : config_(config), isOpen_(false), sockfd_(-1) {
@@ -63,6 +68,11 @@ public:
         setsockopt(sockfd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
         setsockopt(sockfd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
 
+        // Every write() is one gathered sendmsg(), so Nagle only adds latency:
+        // a query sent right after a setpoint would wait for the delayed ACK
+        int one = 1;
+        setsockopt(sockfd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
         // Setup server address
         struct sockaddr_in serverAddr;
         memset(&serverAddr, 0, sizeof(serverAddr));
@@ -85,60 +95,95 @@ public:
         isOpen_ = true;
     }
 
-    size_t write(const std::string& data) override {
+    size_t write(const ConstBuffer* buffers, size_t count) override {
         if (!isOpen_) {
             throw G30Exception("TCP port is not open");
         }
 
-        ssize_t result = send(sockfd_, data.c_str(), data.length(), 0);
-        if (result < 0) {
-            throw G30Exception("Failed to send data over TCP");
+        iov_.clear();
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (buffers[i].size > 0) {
+                iov_.push_back({const_cast<char*>(buffers[i].data), buffers[i].size});
+                total += buffers[i].size;
+            }
+        }
+
+        // One sendmsg() per IOV_MAX fragments; MSG_MORE corks all but the
+        // last so the kernel still coalesces them into full segments
+        const size_t maxFragments = 1024;
+        size_t first = 0;
+        size_t written = 0;
+        while (first < iov_.size()) {
+            size_t fragments = std::min(iov_.size() - first, maxFragments);
+            struct msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov_[first];
+            msg.msg_iovlen = fragments;
+            int flags = MSG_NOSIGNAL | (first + fragments < iov_.size() ? MSG_MORE : 0);
+
+            ssize_t sent = sendmsg(sockfd_, &msg, flags);
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    throw G30Exception("Timeout sending data over TCP (" + std::to_string(written) +
+                                     " of " + std::to_string(total) + " bytes sent)");
+                }
+                throw G30Exception("Failed to send data over TCP");
+            }
+            written += static_cast<size_t>(sent);
+
+            // Short write: skip the fragments sent completely, trim the partial one
+            size_t remaining = static_cast<size_t>(sent);
+            while (first < iov_.size() && remaining >= iov_[first].iov_len) {
+                remaining -= iov_[first].iov_len;
+                ++first;
+            }
+            if (remaining > 0) {
+                iov_[first].iov_base = static_cast<char*>(iov_[first].iov_base) + remaining;
+                iov_[first].iov_len -= remaining;
+            }
         }
 
-        return static_cast<size_t>(result);
+        return written;
     }
 
-    std::string read(int timeout_ms = 1000) override {
+    size_t read(char* buffer, size_t capacity, int timeout_ms) override {
         if (!isOpen_) {
             throw G30Exception("TCP port is not open");
         }
 
-        std::string result;
-        char buffer[256];
-        auto start = std::chrono::steady_clock::now();
+        if (!rxBuffer_.empty()) {
+            return rxBuffer_.take(buffer, capacity);
+        }
+        if (!waitReadable(timeout_ms)) {
+            return 0;
+        }
+        return receive(buffer, capacity);
+    }
 
-        while (true) {
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
+    bool readLine(int timeout_ms, ConstBuffer& line) override {
+        if (!isOpen_) {
+            throw G30Exception("TCP port is not open");
+        }
 
-            if (elapsed >= timeout_ms) {
-                break;
-            }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
 
-            // Use poll to check for data
-            struct pollfd pfd;
-            pfd.fd = sockfd_;
-            pfd.events = POLLIN;
-
-            int pollResult = poll(&pfd, 1, 10); // 10ms timeout
-            if (pollResult > 0 && (pfd.revents & POLLIN)) {
-                ssize_t bytesRead = recv(sockfd_, buffer, sizeof(buffer) - 1, 0);
-                if (bytesRead > 0) {
-                    buffer[bytesRead] = '\0';
-                    result += buffer;
-                    if (result.find('\n') != std::string::npos) {
-                        break;
-                    }
-                } else if (bytesRead == 0) {
-                    // Connection closed
-                    throw G30Exception("TCP connection closed by remote host");
-                }
+        while (!rxBuffer_.nextLine(line)) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0 || !waitReadable(static_cast<int>(remaining))) {
+                line = rxBuffer_.takeAll();
+                return false;
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            const size_t chunk = 4096;
+            rxBuffer_.commit(receive(rxBuffer_.prepare(chunk), chunk));
         }
 
-        return result;
+        return true;
     }
 
     bool isOpen() const override {
@@ -154,6 +199,7 @@ public:
             ::close(sockfd_);
             sockfd_ = -1;
         }
+        rxBuffer_.clear();
         isOpen_ = false;
     }
 
@@ -161,8 +207,196 @@ private:
     G30Config config_;
     bool isOpen_;
     int sockfd_;
+    std::vector<struct iovec> iov_;
+    LineBuffer rxBuffer_;
+
+    bool waitReadable(int timeout_ms) {
+        struct pollfd pfd;
+        pfd.fd = sockfd_;
+        pfd.events = POLLIN;
+
+        int pollResult;
+        do {
+            pollResult = poll(&pfd, 1, timeout_ms);
+        } while (pollResult < 0 && errno == EINTR);
+
+        return pollResult > 0;
+    }
+
+    size_t receive(char* buffer, size_t capacity) {
+        ssize_t bytesRead = recv(sockfd_, buffer, capacity, 0);
+        if (bytesRead == 0) {
+            throw G30Exception("TCP connection closed by remote host");
+        }
+        if (bytesRead < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return 0;
+            }
+            throw G30Exception("Failed to receive data over TCP");
+        }
+        return static_cast<size_t>(bytesRead);
+    }
 };
 
+// ==================== LineBuffer ====================
+
+LineBuffer::LineBuffer()
+    : begin_(0),
+      end_(0),
+      scanned_(0) {
+}
+
+char* LineBuffer::prepare(size_t bytes) {
+    if (begin_ > 0) {
+        // Reclaim consumed space; views handed out earlier are invalid from here on
+        std::memmove(data_.data(), data_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if (data_.size() < end_ + bytes) {
+        data_.resize(end_ + bytes);
+    }
+    return data_.data() + end_;
+}
+
+void LineBuffer::commit(size_t bytes) {
+    end_ += bytes;
+}
+
+bool LineBuffer::nextLine(ConstBuffer& line) {
+    const char* first = data_.data() + begin_;
+    const void* newline = std::memchr(first + scanned_, '\n', end_ - begin_ - scanned_);
+    if (!newline) {
+        scanned_ = end_ - begin_;
+        return false;
+    }
+
+    size_t length = static_cast<size_t>(static_cast<const char*>(newline) - first);
+    line = ConstBuffer(first, length);
+    begin_ += length + 1;
+    scanned_ = 0;
+    return true;
+}
+
+size_t LineBuffer::take(char* buffer, size_t capacity) {
+    size_t n = std::min(capacity, end_ - begin_);
+    std::memcpy(buffer, data_.data() + begin_, n);
+    begin_ += n;
+    scanned_ = 0;
+    return n;
+}
+
+ConstBuffer LineBuffer::takeAll() {
+    ConstBuffer all(data_.data() + begin_, end_ - begin_);
+    begin_ = end_;
+    scanned_ = 0;
+    return all;
+}
+
+void LineBuffer::clear() {
+    begin_ = 0;
+    end_ = 0;
+    scanned_ = 0;
+}
+
+// ==================== CommunicationAdapter ====================
+
+CommunicationAdapter::CommunicationAdapter(std::unique_ptr<ICommunication> port)
+    : port_(std::move(port)) {
+}
+
+size_t CommunicationAdapter::write(const ConstBuffer* buffers, size_t count) {
+    message_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        message_.append(buffers[i].data, buffers[i].size);
+    }
+
+    // Version 1 ports may accept less than the whole message
+    size_t written = 0;
+    while (written < message_.size()) {
+        size_t n = port_->write(written == 0 ? message_ : message_.substr(written));
+        if (n == 0) {
+            throw G30Exception("Communication port accepted no data");
+        }
+        written += n;
+    }
+    return written;
+}
+
+size_t CommunicationAdapter::read(char* buffer, size_t capacity, int timeout_ms) {
+    if (rx_.empty()) {
+        std::string data = port_->read(timeout_ms);
+        std::memcpy(rx_.prepare(data.size()), data.data(), data.size());
+        rx_.commit(data.size());
+    }
+    return rx_.take(buffer, capacity);
+}
+
+bool CommunicationAdapter::readLine(int timeout_ms, ConstBuffer& line) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    while (!rx_.nextLine(line)) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) {
+            line = rx_.takeAll();
+            return false;
+        }
+
+        std::string data = port_->read(static_cast<int>(remaining));
+        std::memcpy(rx_.prepare(data.size()), data.data(), data.size());
+        rx_.commit(data.size());
+    }
+
+    return true;
+}
+
+bool CommunicationAdapter::isOpen() const {
+    return port_->isOpen();
+}
+
+void CommunicationAdapter::close() {
+    port_->close();
+    rx_.clear();
+}
+
+
+
+// ==================== Retry Helpers ====================
+
+namespace {
+
+/**
+ * @brief Check whether repeating a message cannot change device state
+ *
+ * Every part of a compound message must be a query. SYST:ERR? is excluded
+ * because reading it removes the entry from the error queue.
+ */
+bool isIdempotentQuery(const std::string& message) {
+    size_t begin = 0;
+    while (begin < message.size()) {
+        size_t end = message.find(';', begin);
+        if (end == std::string::npos) {
+            end = message.size();
+        }
+        std::string part;
+        for (size_t i = begin; i < end; ++i) {
+            char c = message[i];
+            if (!std::isspace(static_cast<unsigned char>(c))) {
+                part += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+        }
+        if (part.empty() || part.back() != '?' ||
+            (part.compare(0, 4, "SYST") == 0 && part.find(":ERR") != std::string::npos)) {
+            return false;
+        }
+        begin = end + 1;
+    }
+    return true;
+}
+
+} // namespace
+
 // ==================== TDKLambdaG30 Implementation ====================
 
 TDKLambdaG30::TDKLambdaG30(const G30Config& config)
@@ -171,20 +405,34 @@ TDKLambdaG30::TDKLambdaG30(const G30Config& config)
       outputEnabled_(false),
       maxVoltage_(30.0),
       maxCurrent_(56.0),
-      errorHandler_(nullptr) {
+      errorHandler_(nullptr),
+      staleReplies_(0),
+      lastResponse_ns_(0),
+      circuit_(CircuitState::CLOSED),
+      consecutiveFailures_(0),
+      snapshotValid_(false) {
 
     // Create TCP/IP communication port
     commPort_ = std::make_unique<TcpPort>(config_);
 }
 
 TDKLambdaG30::TDKLambdaG30(std::unique_ptr<ICommunication> commPort, const G30Config& config)
+    : TDKLambdaG30(std::unique_ptr<ICommunicationV2>(new CommunicationAdapter(std::move(commPort))), config) {
+}
+
+TDKLambdaG30::TDKLambdaG30(std::unique_ptr<ICommunicationV2> commPort, const G30Config& config)
     : commPort_(std::move(commPort)),
       config_(config),
       connected_(false),
       outputEnabled_(false),
       maxVoltage_(30.0),
       maxCurrent_(56.0),
-      errorHandler_(nullptr) {
+      errorHandler_(nullptr),
+      staleReplies_(0),
+      lastResponse_ns_(0),
+      circuit_(CircuitState::CLOSED),
+      consecutiveFailures_(0),
+      snapshotValid_(false) {
 }
 
 TDKLambdaG30::~TDKLambdaG30() {
@@ -205,7 +453,15 @@ TDKLambdaG30::TDKLambdaG30(TDKLambdaG30&& other) noexcept
       outputEnabled_(other.outputEnabled_),
       maxVoltage_(other.maxVoltage_),
       maxCurrent_(other.maxCurrent_),
-      errorHandler_(std::move(other.errorHandler_)) {
+      errorHandler_(std::move(other.errorHandler_)),
+      staleReplies_(other.staleReplies_),
+      lastResponse_ns_(other.lastResponse_ns_.load()),
+      rtt_(other.rtt_),
+      circuit_(other.circuit_),
+      consecutiveFailures_(other.consecutiveFailures_),
+      circuitOpened_(other.circuitOpened_),
+      snapshot_(other.snapshot_),
+      snapshotValid_(other.snapshotValid_) {
     other.connected_ = false;
 }
 
@@ -218,6 +474,14 @@ TDKLambdaG30& TDKLambdaG30::operator=(TDKLambdaG30&& other) noexcept {
         maxVoltage_ = other.maxVoltage_;
         maxCurrent_ = other.maxCurrent_;
         errorHandler_ = std::move(other.errorHandler_);
+        staleReplies_ = other.staleReplies_;
+        lastResponse_ns_ = other.lastResponse_ns_.load();
+        rtt_ = other.rtt_;
+        circuit_ = other.circuit_;
+        consecutiveFailures_ = other.consecutiveFailures_;
+        circuitOpened_ = other.circuitOpened_;
+        snapshot_ = other.snapshot_;
+        snapshotValid_ = other.snapshotValid_;
         other.connected_ = false;
     }
     return *this;
@@ -235,7 +499,7 @@ void TDKLambdaG30::connect() {
             tcpPort->open();
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        clock().sleepFor(std::chrono::milliseconds(100));
 
         std::string id = getIdentification();
         if (id.empty()) {
@@ -244,8 +508,10 @@ void TDKLambdaG30::connect() {
 
         connected_ = true;
 
-        reset();
-        clearProtection();
+        if (config_.resetOnConnect) {
+            reset();
+            clearProtection();
+        }
 
     } catch (const std::exception& e) {
         disconnect();
@@ -257,6 +523,13 @@ void TDKLambdaG30::disconnect() {
     if (commPort_) {
         commPort_->close();
     }
+    staleReplies_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(linkMutex_);
+        circuit_ = CircuitState::CLOSED;
+        consecutiveFailures_ = 0;
+    }
+    invalidateSnapshot();
     connected_ = false;
 }
 
@@ -270,9 +543,9 @@ void TDKLambdaG30::enableOutput(bool enable) {
     }
 
     std::string command = enable ? "OUTP ON\n" : "OUTP OFF\n";
-    commPort_->write(command);
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    outputEnabled_ = enable;
+    transmit(command);
+    clock().sleepFor(std::chrono::milliseconds(50));
+    storeOutputState(enable);
 }
 
 bool TDKLambdaG30::isOutputEnabled() const {
@@ -281,7 +554,9 @@ bool TDKLambdaG30::isOutputEnabled() const {
     }
 
     std::string response = sendQuery("OUTP?");
-    return (trim(response) == "1" || trim(response) == "ON");
+    bool enabled = (trim(response) == "1" || trim(response) == "ON");
+    storeOutputState(enabled);
+    return enabled;
 }
 
 void TDKLambdaG30::reset() {
@@ -289,9 +564,11 @@ void TDKLambdaG30::reset() {
         throw G30Exception("Not connected to device");
     }
 
-    commPort_->write("*RST\n");
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    transmit("*RST\n");
+    clock().sleepFor(std::chrono::milliseconds(500));
+    std::lock_guard<std::mutex> lock(stateMutex_);
     outputEnabled_ = false;
+    snapshotValid_ = false;
 }
 
 void TDKLambdaG30::setVoltage(double voltage, int channel) {
@@ -308,8 +585,10 @@ void TDKLambdaG30::setVoltage(double voltage, int channel) {
     oss.precision(3);
     oss << std::fixed << "VOLT " << voltage << "\n";
 
-    commPort_->write(oss.str());
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    transmit(oss.str());
+    clock().sleepFor(std::chrono::milliseconds(50));
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    snapshot_.voltage = voltage;
 }
 
 double TDKLambdaG30::getVoltage(int channel) const {
@@ -351,7 +630,7 @@ void TDKLambdaG30::setVoltageWithRamp(double voltage, double rampRate) {
     for (int i = 0; i < static_cast<int>(steps); ++i) {
         currentVoltage += stepVoltage;
         setVoltage(currentVoltage);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        clock().sleepFor(std::chrono::milliseconds(100));
     }
 
     setVoltage(voltage);
@@ -371,8 +650,10 @@ void TDKLambdaG30::setCurrent(double current, int channel) {
     oss.precision(3);
     oss << std::fixed << "CURR " << current << "\n";
 
-    commPort_->write(oss.str());
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    transmit(oss.str());
+    clock().sleepFor(std::chrono::milliseconds(50));
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    snapshot_.current = current;
 }
 
 double TDKLambdaG30::getCurrent(int channel) const {
@@ -414,7 +695,7 @@ void TDKLambdaG30::setCurrentWithRamp(double current, double rampRate) {
     for (int i = 0; i < static_cast<int>(steps); ++i) {
         currentCurrent += stepCurrent;
         setCurrent(currentCurrent);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        clock().sleepFor(std::chrono::milliseconds(100));
     }
 
     setCurrent(current);
@@ -433,6 +714,87 @@ double TDKLambdaG30::measurePower(int channel) const {
     return voltage * current;
 }
 
+AveragedMeasurement TDKLambdaG30::measureAveraged(MeasureMetric metric, int n, double outlierThreshold) const {
+    if (n < 1) {
+        throw G30Exception("Sample count must be at least 1");
+    }
+    if (outlierThreshold < 0) {
+        throw G30Exception("Outlier threshold must not be negative");
+    }
+    if (!isConnected()) {
+        throw G30Exception("Not connected to device");
+    }
+
+    std::vector<std::string> queries;
+    if (metric == MeasureMetric::POWER) {
+        // Voltage and current of one slot are read back to back
+        queries.reserve(2 * static_cast<size_t>(n));
+        for (int i = 0; i < n; ++i) {
+            queries.push_back("MEAS:VOLT?");
+            queries.push_back("MEAS:CURR?");
+        }
+    } else {
+        queries.assign(static_cast<size_t>(n),
+                       metric == MeasureMetric::VOLTAGE ? "MEAS:VOLT?" : "MEAS:CURR?");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::chrono::steady_clock::time_point> arrivals;
+    arrivals.reserve(queries.size());
+    std::vector<std::string> responses = queryPipelined(queries, 0, &arrivals);
+
+    std::vector<double> values(static_cast<size_t>(n));
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = (metric == MeasureMetric::POWER)
+            ? parseNumericResponse(responses[2 * i]) * parseNumericResponse(responses[2 * i + 1])
+            : parseNumericResponse(responses[i]);
+    }
+
+    AveragedMeasurement result;
+    result.spread_ms = std::chrono::duration<double, std::milli>(arrivals.back() - arrivals.front()).count();
+    result.duration_ms = std::chrono::duration<double, std::milli>(arrivals.back() - start).count();
+
+    // Median and MAD are robust against the outliers they are used to find
+    std::vector<double> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    size_t mid = sorted.size() / 2;
+    result.median = (sorted.size() % 2) ? sorted[mid] : 0.5 * (sorted[mid - 1] + sorted[mid]);
+
+    std::vector<double> deviations(sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        deviations[i] = std::abs(sorted[i] - result.median);
+    }
+    std::sort(deviations.begin(), deviations.end());
+    double mad = (deviations.size() % 2) ? deviations[mid] : 0.5 * (deviations[mid - 1] + deviations[mid]);
+
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    bool first = true;
+    for (double v : values) {
+        if (outlierThreshold > 0 && mad > 0 &&
+            0.6745 * std::abs(v - result.median) / mad > outlierThreshold) {
+            ++result.rejected;
+            continue;
+        }
+        if (first) {
+            result.min = result.max = v;
+            first = false;
+        }
+        result.min = std::min(result.min, v);
+        result.max = std::max(result.max, v);
+        sum += v;
+        sumSquares += v * v;
+        ++result.samples;
+    }
+
+    result.mean = sum / result.samples;
+    if (result.samples > 1) {
+        double variance = (sumSquares - sum * result.mean) / (result.samples - 1);
+        result.stddev = std::sqrt(std::max(0.0, variance));
+    }
+    return result;
+}
+
 void TDKLambdaG30::setOverVoltageProtection(double voltage, int channel) {
     // G30 is single-channel, ignore channel parameter
     (void)channel;
@@ -445,8 +807,10 @@ void TDKLambdaG30::setOverVoltageProtection(double voltage, int channel) {
     oss.precision(3);
     oss << std::fixed << "VOLT:PROT " << voltage << "\n";
 
-    commPort_->write(oss.str());
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    transmit(oss.str());
+    clock().sleepFor(std::chrono::milliseconds(50));
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    snapshot_.overVoltageProtection = voltage;
 }
 
 double TDKLambdaG30::getOverVoltageProtection() const {
@@ -463,8 +827,9 @@ void TDKLambdaG30::clearProtection() {
         throw G30Exception("Not connected to device");
     }
 
-    commPort_->write("*CLS\n");
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    transmit("*CLS\n");
+    clock().sleepFor(std::chrono::milliseconds(100));
+    invalidateSnapshot();
 }
 
 std::string TDKLambdaG30::getIdentification() const {
@@ -534,6 +899,134 @@ std::string TDKLambdaG30::getModel() const {
     return "G30";
 }
 
+DeviceConfig TDKLambdaG30::readConfig() const {
+    if (!isConnected()) {
+        throw G30Exception("Not connected to device");
+    }
+
+    std::string response = sendQuery("VOLT?;CURR?;VOLT:PROT?;OUTP?");
+
+    std::vector<std::string> fields;
+    std::istringstream iss(response);
+    std::string field;
+    while (std::getline(iss, field, ';')) {
+        fields.push_back(trim(field));
+    }
+    if (fields.size() != 4) {
+        throw G30Exception("Unexpected configuration response: '" + response + "'");
+    }
+
+    DeviceConfig config;
+    config.voltage = parseNumericResponse(fields[0]);
+    config.current = parseNumericResponse(fields[1]);
+    config.overVoltageProtection = parseNumericResponse(fields[2]);
+    config.outputEnabled = (fields[3] == "1" || fields[3] == "ON");
+
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    snapshot_ = config;
+    snapshotValid_ = true;
+    outputEnabled_ = config.outputEnabled;
+    return config;
+}
+
+int TDKLambdaG30::applyConfig(const DeviceConfig& target) {
+    validateVoltage(target.voltage);
+    validateCurrent(target.current);
+    if (target.voltage > target.overVoltageProtection) {
+        throw G30Exception("Voltage " + std::to_string(target.voltage) +
+                         "V exceeds OVP level of " +
+                         std::to_string(target.overVoltageProtection) + "V");
+    }
+
+    if (!isConnected()) {
+        throw G30Exception("Not connected to device");
+    }
+
+    DeviceConfig snapshot;
+    bool valid;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        snapshot = snapshot_;
+        valid = snapshotValid_;
+    }
+    if (!valid) {
+        snapshot = readConfig();
+    } else if (target.outputEnabled && snapshot.outputEnabled) {
+        // A protection trip switches the output off without the snapshot
+        // noticing; one pipelined round trip, without sendQuery()'s settling delay
+        std::string response = trim(sendQueries({"OUTP?"})[0]);
+        snapshot.outputEnabled = (response == "1" || response == "ON");
+        storeOutputState(snapshot.outputEnabled);
+    }
+
+    // Values are sent with 3 decimals, anything finer is not a change
+    auto differs = [](double a, double b) { return std::abs(a - b) >= 0.0005; };
+    auto format = [](const char* header, double value) {
+        std::ostringstream oss;
+        oss.precision(3);
+        oss << std::fixed << header << " " << value;
+        return oss.str();
+    };
+
+    bool voltageChanged = differs(target.voltage, snapshot.voltage);
+    bool currentChanged = differs(target.current, snapshot.current);
+    bool ovpChanged = differs(target.overVoltageProtection, snapshot.overVoltageProtection);
+    bool outputChanged = target.outputEnabled != snapshot.outputEnabled;
+
+    std::vector<std::string> commands;
+
+    if (outputChanged && !target.outputEnabled) {
+        commands.push_back("OUTP OFF");
+    }
+    // Raise OVP before raising the voltage, lower it only after the voltage
+    bool ovpFirst = ovpChanged && target.overVoltageProtection > snapshot.overVoltageProtection;
+    if (ovpFirst) {
+        commands.push_back(format("VOLT:PROT", target.overVoltageProtection));
+    }
+    if (voltageChanged) {
+        commands.push_back(format("VOLT", target.voltage));
+    }
+    if (ovpChanged && !ovpFirst) {
+        commands.push_back(format("VOLT:PROT", target.overVoltageProtection));
+    }
+    if (currentChanged) {
+        commands.push_back(format("CURR", target.current));
+    }
+    if (outputChanged && target.outputEnabled) {
+        commands.push_back("OUTP ON");
+    }
+
+    sendBatch(commands);
+
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    snapshot_ = target;
+    snapshotValid_ = true;
+    outputEnabled_ = target.outputEnabled;
+    return static_cast<int>(commands.size());
+}
+
+void TDKLambdaG30::saveSetup(int slot) {
+    validateSetupSlot(slot);
+
+    if (!isConnected()) {
+        throw G30Exception("Not connected to device");
+    }
+
+    transmit("*SAV " + std::to_string(slot) + "\n");
+    clock().sleepFor(std::chrono::milliseconds(50));
+}
+
+void TDKLambdaG30::recallSetup(int slot) {
+    validateSetupSlot(slot);
+
+    if (!isConnected()) {
+        throw G30Exception("Not connected to device");
+    }
+
+    transmit("*RCL " + std::to_string(slot) + "\n");
+    invalidateSnapshot();
+}
+
 void TDKLambdaG30::setMaxVoltage(double maxVoltage) {
     if (maxVoltage <= 0) {
         throw G30Exception("Maximum voltage must be positive");
@@ -553,13 +1046,9 @@ std::string TDKLambdaG30::sendCommand(const std::string& command) {
         throw G30Exception("Not connected to device");
     }
 
-    std::string cmd = command;
-    if (cmd.back() != '\n') {
-        cmd += '\n';
-    }
-
-    commPort_->write(cmd);
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    transmit(command);
+    clock().sleepFor(std::chrono::milliseconds(50));
+    invalidateSnapshot();
 
     return "OK";
 }
@@ -569,16 +1058,161 @@ std::string TDKLambdaG30::sendQuery(const std::string& query) const {
         throw G30Exception("Not connected to device");
     }
 
-    std::string cmd = query;
-    if (cmd.back() != '\n') {
-        cmd += '\n';
+    int attempts = 1 + (isIdempotentQuery(query) ? std::max(0, config_.queryRetries) : 0);
+
+    std::lock_guard<std::mutex> lock(ioMutex_);
+    for (int attempt = 1; ; ++attempt) {
+        std::string response;
+        bool answered;
+        // No RTT sample: the settling delay hides when the reply arrived
+        try {
+            writeMessage(query);
+            clock().sleepFor(std::chrono::milliseconds(50));
+            answered = readResponseLine(responseTimeout(), response);
+        } catch (const G30Exception&) {
+            recordOutcome(false);
+            throw;
+        }
+
+        if (answered) {
+            recordOutcome(true);
+            return response;
+        }
+
+        staleReplies_ = 1;
+        recordTimeout();
+        recordOutcome(false);
+        if (attempt >= attempts || circuitState() != CircuitState::CLOSED) {
+            throw G30Exception("Timeout waiting for response to '" + query + "'");
+        }
+        retryBackoff(attempt);
+    }
+}
+
+void TDKLambdaG30::sendBatch(const std::vector<std::string>& commands) {
+    if (!isConnected()) {
+        throw G30Exception("Not connected to device");
+    }
+    if (commands.empty()) {
+        return;
+    }
+
+    // Raw commands may change any setting behind the snapshot
+    invalidateSnapshot();
+    std::lock_guard<std::mutex> lock(ioMutex_);
+    writeMessages(commands);
+}
+
+void TDKLambdaG30::sendBatch(const ConstBuffer* fragments, size_t count) {
+    if (!isConnected()) {
+        throw G30Exception("Not connected to device");
+    }
+    if (count == 0) {
+        return;
+    }
+
+    invalidateSnapshot();
+    std::lock_guard<std::mutex> lock(ioMutex_);
+    prepareWrite();
+    commPort_->write(fragments, count);
+}
+
+std::vector<std::string> TDKLambdaG30::sendQueries(const std::vector<std::string>& queries,
+                                                  int timeout_ms) const {
+    if (!isConnected()) {
+        throw G30Exception("Not connected to device");
+    }
+    if (queries.empty()) {
+        return std::vector<std::string>();
+    }
+    return queryPipelined(queries, timeout_ms, nullptr);
+}
+
+std::vector<std::string> TDKLambdaG30::sendQueries(const std::vector<std::string>& queries,
+                                                  int timeout_ms, double& rtt_ms, int retries) const {
+    if (!isConnected()) {
+        throw G30Exception("Not connected to device");
+    }
+    if (queries.empty()) {
+        rtt_ms = 0;
+        return std::vector<std::string>();
+    }
+    return queryPipelined(queries, timeout_ms, nullptr, &rtt_ms, retries);
+}
+
+std::vector<std::string> TDKLambdaG30::queryPipelined(
+        const std::vector<std::string>& queries, int timeout_ms,
+        std::vector<std::chrono::steady_clock::time_point>* arrivals, double* rtt_ms,
+        int retries) const {
+    std::vector<std::string> responses;
+
+    bool idempotent = std::all_of(queries.begin(), queries.end(), isIdempotentQuery);
+    int attempts = 1 + (idempotent ? std::max(0, retries < 0 ? config_.queryRetries : retries) : 0);
+    responses.reserve(queries.size());
+
+    std::lock_guard<std::mutex> lock(ioMutex_);
+    for (int attempt = 1; ; ++attempt) {
+        int timeout = timeout_ms > 0 ? timeout_ms : responseTimeout();
+        size_t missing = 0;
+
+        try {
+            auto start = std::chrono::steady_clock::now();
+            writeMessages(queries, timeout);
+
+            for (size_t i = 0; i < queries.size(); ++i) {
+                std::string line;
+                if (!readResponseLine(timeout, line)) {
+                    missing = queries.size() - i;
+                    break;
+                }
+                auto arrival = std::chrono::steady_clock::now();
+                if (i == 0) {
+                    double rtt = std::chrono::duration<double, std::milli>(arrival - start).count();
+                    recordRtt(rtt);
+                    if (rtt_ms) {
+                        *rtt_ms = rtt;
+                    }
+                }
+                if (arrivals) {
+                    arrivals->push_back(arrival);
+                }
+                responses.push_back(std::move(line));
+            }
+        } catch (const G30Exception&) {
+            recordOutcome(false);
+            throw;
+        }
+
+        if (missing == 0) {
+            recordOutcome(true);
+            return responses;
+        }
+
+        staleReplies_ = missing;
+        recordTimeout();
+        recordOutcome(false);
+        if (attempt >= attempts || circuitState() != CircuitState::CLOSED) {
+            throw G30Exception("Timeout waiting for response " +
+                             std::to_string(queries.size() - missing + 1) +
+                             " of " + std::to_string(queries.size()));
+        }
+        responses.clear();
+        if (arrivals) {
+            arrivals->clear();
+        }
+        retryBackoff(attempt);
     }
+}
 
-    commPort_->write(cmd);
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+void TDKLambdaG30::invalidateSnapshot() const {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    snapshotValid_ = false;
+}
 
-    std::string response = commPort_->read(config_.timeout_ms);
-    return trim(response);
+void TDKLambdaG30::storeOutputState(bool enabled) const {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    outputEnabled_ = enabled;
+    snapshot_.outputEnabled = enabled;
 }
 
 void TDKLambdaG30::setErrorHandler(std::function<void(const std::string&)> handler) {
@@ -605,6 +1239,13 @@ void TDKLambdaG30::validateCurrent(double current) const {
     }
 }
 
+void TDKLambdaG30::validateSetupSlot(int slot) const {
+    if (slot < 1 || slot > config_.setupSlots) {
+        throw G30Exception("Setup slot " + std::to_string(slot) + " out of range 1.." +
+                         std::to_string(config_.setupSlots));
+    }
+}
+
 double TDKLambdaG30::parseNumericResponse(const std::string& response) const {
     try {
         std::string cleaned = trim(response);
@@ -614,6 +1255,198 @@ double TDKLambdaG30::parseNumericResponse(const std::string& response) const {
     }
 }
 
+void TDKLambdaG30::transmit(const std::string& data) const {
+    std::lock_guard<std::mutex> lock(ioMutex_);
+    writeMessage(data);
+}
+
+void TDKLambdaG30::prepareWrite(int timeout_ms) const {
+    checkCircuit(timeout_ms);
+    discardStaleInput(timeout_ms);
+}
+
+void TDKLambdaG30::writeMessage(const std::string& message, int timeout_ms) const {
+    prepareWrite(timeout_ms);
+    static const char newline = '\n';
+    ConstBuffer buffers[2] = {ConstBuffer(message), ConstBuffer(&newline, 1)};
+    bool terminated = !message.empty() && message.back() == '\n';
+    commPort_->write(buffers, terminated ? 1 : 2);
+}
+
+void TDKLambdaG30::writeMessages(const std::vector<std::string>& messages, int timeout_ms) const {
+    prepareWrite(timeout_ms);
+    static const char newline = '\n';
+    txBuffers_.clear();
+    for (const auto& message : messages) {
+        txBuffers_.emplace_back(message);
+        if (message.empty() || message.back() != '\n') {
+            txBuffers_.emplace_back(&newline, 1);
+        }
+    }
+    commPort_->write(txBuffers_.data(), txBuffers_.size());
+}
+
+void TDKLambdaG30::discardStaleInput(int timeout_ms) const {
+    // Replies to timed-out queries may still arrive; consume them first so
+    // they cannot be taken as answers to the next query. The query has
+    // already waited its full timeout, so only a short grace period is given.
+    if (staleReplies_ == 0) {
+        return;
+    }
+    int wait = std::min(std::max(0, config_.staleDrain_ms),
+                        timeout_ms > 0 ? timeout_ms : responseTimeout());
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait);
+    while (staleReplies_ > 0) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        ConstBuffer view;
+        if (!commPort_->readLine(static_cast<int>(std::max<int64_t>(0, remaining)), view)) {
+            break;      // Lost for good
+        }
+        --staleReplies_;
+    }
+    staleReplies_ = 0;
+}
+
+std::chrono::steady_clock::time_point TDKLambdaG30::lastResponseTime() const {
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(lastResponse_ns_.load()));
+}
+
+RttEstimate TDKLambdaG30::rttEstimate() const {
+    std::lock_guard<std::mutex> lock(linkMutex_);
+    RttEstimate estimate = rtt_;
+    if (!config_.adaptiveTimeout || estimate.samples == 0) {
+        estimate.timeout_ms = config_.timeout_ms;
+    }
+    return estimate;
+}
+
+int TDKLambdaG30::responseTimeout() const {
+    if (!config_.adaptiveTimeout) {
+        return config_.timeout_ms;
+    }
+    std::lock_guard<std::mutex> lock(linkMutex_);
+    return rtt_.samples > 0 ? rtt_.timeout_ms : config_.timeout_ms;
+}
+
+void TDKLambdaG30::recordRtt(double rtt_ms) const {
+    std::lock_guard<std::mutex> lock(linkMutex_);
+
+    // RFC 6298: alpha = 1/8, beta = 1/4, first sample sets rttvar = R/2
+    if (rtt_.samples == 0) {
+        rtt_.srtt_ms = rtt_ms;
+        rtt_.rttvar_ms = rtt_ms / 2.0;
+    } else {
+        rtt_.rttvar_ms += (std::abs(rtt_.srtt_ms - rtt_ms) - rtt_.rttvar_ms) / 4.0;
+        rtt_.srtt_ms += (rtt_ms - rtt_.srtt_ms) / 8.0;
+    }
+    ++rtt_.samples;
+
+    // At least 1 ms of variance term: the clock granularity G of RFC 6298
+    double timeout = rtt_.srtt_ms + std::max(1.0, config_.rttVarianceFactor * rtt_.rttvar_ms);
+    rtt_.timeout_ms = static_cast<int>(std::ceil(timeout));
+    rtt_.timeout_ms = std::max(config_.minTimeout_ms, std::min(config_.maxTimeout_ms, rtt_.timeout_ms));
+}
+
+void TDKLambdaG30::recordTimeout() const {
+    std::lock_guard<std::mutex> lock(linkMutex_);
+    ++rtt_.timeouts;
+    if (rtt_.samples > 0) {
+        rtt_.timeout_ms = std::min(config_.maxTimeout_ms, rtt_.timeout_ms * 2);
+    }
+}
+
+CircuitState TDKLambdaG30::circuitState() const {
+    std::lock_guard<std::mutex> lock(linkMutex_);
+    return circuit_;
+}
+
+void TDKLambdaG30::checkCircuit(int timeout_ms) const {
+    if (config_.breakerThreshold <= 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(linkMutex_);
+        if (circuit_ == CircuitState::CLOSED) {
+            return;
+        }
+        auto reopen = circuitOpened_ + std::chrono::milliseconds(config_.breakerOpen_ms);
+        if (clock().now() < reopen) {
+            throw G30Exception("Circuit open: " + config_.ipAddress + " is not responding");
+        }
+        circuit_ = CircuitState::HALF_OPEN;
+    }
+
+    // One cheap probe decides whether the real transaction may go ahead
+    discardStaleInput(timeout_ms);
+    static const char probe[] = "OUTP?\n";
+    ConstBuffer buffer(probe, sizeof(probe) - 1);
+    ConstBuffer reply;
+    bool answered = false;
+    try {
+        commPort_->write(&buffer, 1);
+        answered = commPort_->readLine(timeout_ms > 0 ? timeout_ms : responseTimeout(), reply);
+    } catch (const G30Exception&) {
+        // Treated like a lost reply
+    }
+
+    std::lock_guard<std::mutex> lock(linkMutex_);
+    if (answered) {
+        circuit_ = CircuitState::CLOSED;
+        consecutiveFailures_ = 0;
+        return;
+    }
+    staleReplies_ = 1;
+    circuit_ = CircuitState::OPEN;
+    circuitOpened_ = clock().now();
+    throw G30Exception("Circuit open: " + config_.ipAddress + " did not answer the probe");
+}
+
+void TDKLambdaG30::recordOutcome(bool success) const {
+    std::lock_guard<std::mutex> lock(linkMutex_);
+    if (success) {
+        consecutiveFailures_ = 0;
+        return;
+    }
+    ++consecutiveFailures_;
+    if (config_.breakerThreshold > 0 && circuit_ == CircuitState::CLOSED &&
+        consecutiveFailures_ >= config_.breakerThreshold) {
+        circuit_ = CircuitState::OPEN;
+        circuitOpened_ = clock().now();
+    }
+}
+
+void TDKLambdaG30::retryBackoff(int attempt) const {
+    // Jitter keeps many callers of one recovering device from retrying in lockstep
+    static thread_local std::minstd_rand random(std::random_device{}());
+    std::uniform_real_distribution<double> jitter(0.5, 1.5);
+
+    double delay_ms = config_.retryBackoff_ms * std::pow(2.0, attempt - 1) * jitter(random);
+    clock().sleepFor(std::chrono::microseconds(static_cast<int64_t>(delay_ms * 1000.0)));
+}
+
+bool TDKLambdaG30::readResponseLine(int timeout_ms, std::string& line) const {
+    ConstBuffer view;
+    bool complete = commPort_->readLine(timeout_ms, view);
+    if (complete) {
+        lastResponse_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Trim on the view so only the payload is copied out
+    const char* first = view.data;
+    const char* last = view.data + view.size;
+    while (first < last && std::isspace(static_cast<unsigned char>(*first))) {
+        ++first;
+    }
+    while (last > first && std::isspace(static_cast<unsigned char>(last[-1]))) {
+        --last;
+    }
+    line.assign(first, static_cast<size_t>(last - first));
+    return complete;
+}
+
 std::string TDKLambdaG30::trim(const std::string& str) const {
     size_t first = str.find_first_not_of(" \t\n\r");
     if (first == std::string::npos) {
@@ -0,0 +1,210 @@
+/**
+ * @file test_retry_breaker.cpp
+ * @brief Regression test of query retries, stale-reply draining and the circuit breaker
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * Runs against a SimulatorFarm device whose latency profile can be switched
+ * between "drop every reply" and "answer at once". Checks the number of
+ * attempts that reach the device, the time a lost query costs and the
+ * CLOSED -> OPEN -> HALF_OPEN -> CLOSED transitions of the breaker. Times
+ * are real, so only generous bounds are asserted.
+ */
+
+#include "../include/g30_simulator_farm.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using namespace TDKLambda;
+
+namespace {
+
+int failures = 0;
+
+const size_t kHealthy = 0;
+const size_t kDropping = 1;
+const int kTimeout_ms = 100;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+void checkRange(double actual, double low, double high, const char* what) {
+    // poll() rounds to whole milliseconds, so allow a little below the bound
+    if (actual < low - 2 || actual >= high) {
+        std::fprintf(stderr, "FAILED: %s: %.1f (expected %.1f .. %.1f)\n", what, actual, low, high);
+        ++failures;
+    }
+}
+
+double sinceMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Run one query transaction and report whether it threw
+ */
+bool queryFails(TDKLambdaG30& psu, const std::string& query, double& elapsed_ms) {
+    auto start = std::chrono::steady_clock::now();
+    bool failed = false;
+    try {
+        psu.sendQueries({query});
+    } catch (const G30Exception&) {
+        failed = true;
+    }
+    elapsed_ms = sinceMs(start);
+    return failed;
+}
+
+/**
+ * @brief Messages the farm has processed since the last call
+ */
+class MessageCounter {
+public:
+    explicit MessageCounter(const SimulatorFarm& farm) : farm_(farm), last_(farm.stats().messages) {}
+
+    uint64_t delta() {
+        // Processing is asynchronous: let the loop thread catch up first
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        uint64_t now = farm_.stats().messages;
+        uint64_t count = now - last_;
+        last_ = now;
+        return count;
+    }
+
+private:
+    const SimulatorFarm& farm_;
+    uint64_t last_;
+};
+
+} // namespace
+
+int main() {
+    try {
+        LatencyProfile dropping;
+        dropping.dropProbability = 1.0;
+
+        SimulatorFarmConfig farmConfig;
+        farmConfig.devices = 1;
+        farmConfig.latency = {LatencyProfile(), dropping};
+        SimulatorFarm farm(farmConfig);
+        farm.start();
+        MessageCounter messages(farm);
+        double elapsed = 0;
+
+        // ==================== Defaults: no retries, no breaker ====================
+
+        G30Config base;
+        base.resetOnConnect = false;
+        base.timeout_ms = kTimeout_ms;
+        {
+            TDKLambdaG30 psu(farm.endpointConfig(0, base));
+            psu.connect();
+            messages.delta();
+
+            farm.setLatencyProfile(0, kDropping);
+            check(queryFails(psu, "MEAS:VOLT?", elapsed), "lost query throws");
+            check(messages.delta() == 1, "lost query is sent once by default");
+            checkRange(elapsed, kTimeout_ms, kTimeout_ms + 80, "lost query costs one timeout");
+            for (int i = 0; i < 10; ++i) {
+                queryFails(psu, "MEAS:VOLT?", elapsed);
+            }
+            check(psu.circuitState() == CircuitState::CLOSED, "breaker is off by default");
+
+            farm.setLatencyProfile(0, kHealthy);
+            messages.delta();
+            check(!queryFails(psu, "MEAS:VOLT?", elapsed), "query succeeds after recovery");
+            psu.disconnect();
+        }
+
+        // ==================== Retries ====================
+
+        G30Config retrying = base;
+        retrying.queryRetries = 2;
+        retrying.retryBackoff_ms = 10;
+        {
+            TDKLambdaG30 psu(farm.endpointConfig(0, retrying));
+            psu.connect();
+            messages.delta();
+
+            farm.setLatencyProfile(0, kDropping);
+            check(queryFails(psu, "MEAS:VOLT?", elapsed), "query throws after its retries");
+            check(messages.delta() == 3, "idempotent query is sent 1 + queryRetries times");
+
+            // 3 timeouts, 5..15 + 10..30 ms backoff, 2 stale drains of staleDrain_ms;
+            // waiting the full timeout for each stale reply would add 200 ms
+            checkRange(elapsed, 3 * kTimeout_ms,
+                       3 * kTimeout_ms + 45 + 2 * retrying.staleDrain_ms + 80, "retries cost one timeout each");
+
+            check(queryFails(psu, "SYST:ERR?", elapsed), "error queue query throws");
+            check(messages.delta() == 1, "SYST:ERR? is never retried");
+
+            farm.setLatencyProfile(0, kHealthy);
+            check(!queryFails(psu, "MEAS:VOLT?", elapsed), "retrying query succeeds after recovery");
+            psu.disconnect();
+        }
+
+        // ==================== Circuit breaker ====================
+
+        G30Config breaking = base;
+        breaking.breakerThreshold = 2;
+        breaking.breakerOpen_ms = 300;
+        {
+            TDKLambdaG30 psu(farm.endpointConfig(0, breaking));
+            psu.connect();
+            messages.delta();
+
+            farm.setLatencyProfile(0, kDropping);
+            queryFails(psu, "MEAS:VOLT?", elapsed);
+            check(psu.circuitState() == CircuitState::CLOSED, "one failure keeps the circuit closed");
+            queryFails(psu, "MEAS:VOLT?", elapsed);
+            check(psu.circuitState() == CircuitState::OPEN, "breakerThreshold failures open the circuit");
+            messages.delta();
+
+            check(queryFails(psu, "MEAS:VOLT?", elapsed), "open circuit throws");
+            check(elapsed < 10, "open circuit fails fast");
+            check(messages.delta() == 0, "open circuit sends nothing");
+
+            // After breakerOpen_ms one probe goes out; watch it from another thread
+            std::this_thread::sleep_for(std::chrono::milliseconds(breaking.breakerOpen_ms));
+            std::atomic<bool> probing(true);
+            std::atomic<bool> sawHalfOpen(false);
+            std::thread watcher([&]() {
+                while (probing) {
+                    if (psu.circuitState() == CircuitState::HALF_OPEN) {
+                        sawHalfOpen = true;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+            check(queryFails(psu, "MEAS:VOLT?", elapsed), "unanswered probe throws");
+            probing = false;
+            watcher.join();
+            check(sawHalfOpen, "circuit is half-open during the probe");
+            check(messages.delta() == 1, "only the probe is sent");
+            check(psu.circuitState() == CircuitState::OPEN, "unanswered probe reopens the circuit");
+
+            farm.setLatencyProfile(0, kHealthy);
+            std::this_thread::sleep_for(std::chrono::milliseconds(breaking.breakerOpen_ms));
+            check(!queryFails(psu, "MEAS:VOLT?", elapsed), "answered probe lets the query through");
+            check(messages.delta() == 2, "probe and query are sent");
+            check(psu.circuitState() == CircuitState::CLOSED, "answered probe closes the circuit");
+            psu.disconnect();
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "FAILED: %s\n", e.what());
+        ++failures;
+    }
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("retries and breaker: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,460 @@
+/**
+ * @file g30bench.cpp
+ * @brief g30bench - per-operation latency, allocation and syscall accounting
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * Runs each driver API operation repeatedly against the built-in simulator
+ * (or a real supply with --device) and reports, per operation:
+ *   - latency (mean, p50, p99)
+ *   - heap allocations and bytes allocated, counted by replacing the global
+ *     operator new
+ *   - system calls issued by the calling thread, counted by interposing the
+ *     libc socket, I/O, poll and sleep wrappers
+ *
+ * Only the benchmarking thread is counted; the simulator runs on its own
+ * thread and does not disturb the figures.
+ *
+ * With --check FILE the counts are compared against a baseline written by
+ * --save FILE, and the program exits with status 2 if any allocation,
+ * byte or syscall count grew by more than the tolerance.
+ *
+ * A real supply is connected without *RST and only read from: the
+ * operations that change setpoints or switch the output on run against it
+ * only with --allow-writes.
+ *
+ * Usage:
+ *   g30bench [--iterations N] [--device IP[:PORT]] [--allow-writes]
+ *            [--save FILE] [--check FILE] [--tolerance PCT]
+ */
+
+#include "../include/g30_simulator.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+
+// Linux/POSIX includes
+#include <dlfcn.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace TDKLambda;
+
+// ==================== Accounting Hooks ====================
+
+namespace {
+
+enum Syscall {
+    SC_SOCKET, SC_CONNECT, SC_SETSOCKOPT, SC_CLOSE,
+    SC_SEND, SC_SENDMSG, SC_WRITE, SC_WRITEV,
+    SC_RECV, SC_READ, SC_POLL, SC_NANOSLEEP,
+    SC_COUNT
+};
+
+const char* const kSyscallNames[SC_COUNT] = {
+    "socket", "connect", "setsockopt", "close",
+    "send", "sendmsg", "write", "writev",
+    "recv", "read", "poll", "nanosleep"
+};
+
+/**
+ * @brief Per-thread counters (trivially destructible, safe inside operator new)
+ */
+struct Counters {
+    bool enabled;
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t syscalls[SC_COUNT];
+};
+
+thread_local Counters counters;
+
+inline void countSyscall(Syscall call) {
+    if (counters.enabled) {
+        ++counters.syscalls[call];
+    }
+}
+
+void* countedAlloc(size_t size) {
+    if (counters.enabled) {
+        ++counters.allocations;
+        counters.bytes += size;
+    }
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+template <typename Fn>
+Fn realFunction(const char* name) {
+    void* symbol = dlsym(RTLD_NEXT, name);
+    if (!symbol) {
+        std::fprintf(stderr, "g30bench: cannot resolve %s\n", name);
+        std::abort();
+    }
+    return reinterpret_cast<Fn>(symbol);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    void* p = countedAlloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+// Interposed libc wrappers: calls from the driver (and libstdc++) land here
+extern "C" {
+
+int socket(int domain, int type, int protocol) {
+    static auto real = realFunction<int (*)(int, int, int)>("socket");
+    countSyscall(SC_SOCKET);
+    return real(domain, type, protocol);
+}
+
+int connect(int fd, const struct sockaddr* addr, socklen_t length) {
+    static auto real = realFunction<int (*)(int, const struct sockaddr*, socklen_t)>("connect");
+    countSyscall(SC_CONNECT);
+    return real(fd, addr, length);
+}
+
+int setsockopt(int fd, int level, int name, const void* value, socklen_t length) {
+    static auto real = realFunction<int (*)(int, int, int, const void*, socklen_t)>("setsockopt");
+    countSyscall(SC_SETSOCKOPT);
+    return real(fd, level, name, value, length);
+}
+
+int close(int fd) {
+    static auto real = realFunction<int (*)(int)>("close");
+    countSyscall(SC_CLOSE);
+    return real(fd);
+}
+
+ssize_t send(int fd, const void* data, size_t length, int flags) {
+    static auto real = realFunction<ssize_t (*)(int, const void*, size_t, int)>("send");
+    countSyscall(SC_SEND);
+    return real(fd, data, length, flags);
+}
+
+ssize_t sendmsg(int fd, const struct msghdr* message, int flags) {
+    static auto real = realFunction<ssize_t (*)(int, const struct msghdr*, int)>("sendmsg");
+    countSyscall(SC_SENDMSG);
+    return real(fd, message, flags);
+}
+
+ssize_t write(int fd, const void* data, size_t length) {
+    static auto real = realFunction<ssize_t (*)(int, const void*, size_t)>("write");
+    countSyscall(SC_WRITE);
+    return real(fd, data, length);
+}
+
+ssize_t writev(int fd, const struct iovec* iov, int count) {
+    static auto real = realFunction<ssize_t (*)(int, const struct iovec*, int)>("writev");
+    countSyscall(SC_WRITEV);
+    return real(fd, iov, count);
+}
+
+ssize_t recv(int fd, void* buffer, size_t length, int flags) {
+    static auto real = realFunction<ssize_t (*)(int, void*, size_t, int)>("recv");
+    countSyscall(SC_RECV);
+    return real(fd, buffer, length, flags);
+}
+
+ssize_t read(int fd, void* buffer, size_t length) {
+    static auto real = realFunction<ssize_t (*)(int, void*, size_t)>("read");
+    countSyscall(SC_READ);
+    return real(fd, buffer, length);
+}
+
+int poll(struct pollfd* fds, nfds_t count, int timeout) {
+    static auto real = realFunction<int (*)(struct pollfd*, nfds_t, int)>("poll");
+    countSyscall(SC_POLL);
+    return real(fds, count, timeout);
+}
+
+int nanosleep(const struct timespec* request, struct timespec* remaining) {
+    static auto real = realFunction<int (*)(const struct timespec*, struct timespec*)>("nanosleep");
+    countSyscall(SC_NANOSLEEP);
+    return real(request, remaining);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec* request, struct timespec* remaining) {
+    static auto real = realFunction<int (*)(clockid_t, int, const struct timespec*, struct timespec*)>("clock_nanosleep");
+    countSyscall(SC_NANOSLEEP);
+    return real(clock, flags, request, remaining);
+}
+
+} // extern "C"
+
+// ==================== Benchmark ====================
+
+namespace {
+
+struct Operation {
+    std::string name;
+    bool writes;                ///< Changes setpoints or output state
+    std::function<void()> run;
+};
+
+struct Result {
+    std::string name;
+    double mean_us;
+    double p50_us;
+    double p99_us;
+    double allocations;         ///< Per operation
+    double bytes;               ///< Per operation
+    double syscalls;            ///< Per operation
+    std::string breakdown;      ///< Syscalls per operation by kind
+};
+
+Result measure(const Operation& op, int iterations) {
+    std::vector<double> latencies;
+    latencies.reserve(static_cast<size_t>(iterations));
+
+    // Warm-up: first-call costs (lazy symbol binding, buffer growth) are not steady state
+    op.run();
+
+    Counters total = Counters();
+    for (int i = 0; i < iterations; ++i) {
+        counters = Counters();
+        counters.enabled = true;
+        auto start = std::chrono::steady_clock::now();
+        op.run();
+        auto end = std::chrono::steady_clock::now();
+        counters.enabled = false;
+
+        latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        total.allocations += counters.allocations;
+        total.bytes += counters.bytes;
+        for (int k = 0; k < SC_COUNT; ++k) {
+            total.syscalls[k] += counters.syscalls[k];
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    double n = static_cast<double>(iterations);
+
+    Result r;
+    r.name = op.name;
+    r.mean_us = 0.0;
+    for (double l : latencies) {
+        r.mean_us += l / n;
+    }
+    r.p50_us = latencies[latencies.size() / 2];
+    r.p99_us = latencies[std::min(latencies.size() - 1, static_cast<size_t>(n * 0.99))];
+    r.allocations = static_cast<double>(total.allocations) / n;
+    r.bytes = static_cast<double>(total.bytes) / n;
+    r.syscalls = 0.0;
+
+    std::ostringstream breakdown;
+    breakdown.precision(1);
+    breakdown << std::fixed;
+    for (int k = 0; k < SC_COUNT; ++k) {
+        if (total.syscalls[k] > 0) {
+            double perOp = static_cast<double>(total.syscalls[k]) / n;
+            r.syscalls += perOp;
+            breakdown << (breakdown.tellp() > 0 ? " " : "") << kSyscallNames[k] << ":" << perOp;
+        }
+    }
+    r.breakdown = breakdown.str();
+    return r;
+}
+
+std::map<std::string, Result> loadBaseline(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw G30Exception("Cannot read baseline " + path);
+    }
+    std::map<std::string, Result> baseline;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream iss(line);
+        Result r;
+        if (iss >> r.name >> r.allocations >> r.bytes >> r.syscalls) {
+            baseline[r.name] = r;
+        }
+    }
+    return baseline;
+}
+
+void saveBaseline(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream file(path);
+    if (!file) {
+        throw G30Exception("Cannot write baseline " + path);
+    }
+    file << "# operation allocations/op bytes/op syscalls/op\n";
+    for (const auto& r : results) {
+        file << r.name << " " << r.allocations << " " << r.bytes << " " << r.syscalls << "\n";
+    }
+}
+
+bool exceeds(double value, double baseline, double tolerance) {
+    // Half a unit of slack keeps integral counts from failing on rounding
+    return value > baseline * (1.0 + tolerance) + 0.5;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = 20;
+    double tolerance = 0.10;
+    std::string device;
+    bool allowWrites = false;
+    std::string savePath;
+    std::string checkPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--device" && i + 1 < argc) {
+            device = argv[++i];
+        } else if (arg == "--allow-writes") {
+            allowWrites = true;
+        } else if (arg == "--save" && i + 1 < argc) {
+            savePath = argv[++i];
+        } else if (arg == "--check" && i + 1 < argc) {
+            checkPath = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = std::atof(argv[++i]) / 100.0;
+        } else {
+            std::cerr << "Usage: g30bench [--iterations N] [--device IP[:PORT]] [--allow-writes]\n"
+                      << "                [--save FILE] [--check FILE] [--tolerance PCT]\n";
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    try {
+        G30Simulator simulator;
+        G30Config config;
+        if (device.empty()) {
+            simulator.start();
+            config.ipAddress = "127.0.0.1";
+            config.tcpPort = simulator.port();
+            allowWrites = true;
+        } else {
+            // Keep the supply's present settings
+            config.resetOnConnect = false;
+            size_t colon = device.find(':');
+            config.ipAddress = device.substr(0, colon);
+            if (colon != std::string::npos) {
+                config.tcpPort = std::atoi(device.c_str() + colon + 1);
+            }
+        }
+
+        TDKLambdaG30 psu(config);
+        psu.connect();
+        if (allowWrites) {
+            psu.setCurrent(1.0);
+            psu.enableOutput(true);
+        }
+
+        DeviceConfig unchanged = psu.readConfig();
+        DeviceConfig toggled = unchanged;
+        bool flip = false;
+
+        std::vector<Operation> operations = {
+            {"setVoltage",      true,  [&]() { psu.setVoltage(5.0); }},
+            {"getVoltage",      false, [&]() { psu.getVoltage(); }},
+            {"measureVoltage",  false, [&]() { psu.measureVoltage(); }},
+            {"measureCurrent",  false, [&]() { psu.measureCurrent(); }},
+            {"getStatus",       false, [&]() { psu.getStatus(); }},
+            {"sendQueries/2",   false, [&]() { psu.sendQueries({"MEAS:VOLT?", "MEAS:CURR?"}); }},
+            {"sendBatch/2",     true,  [&]() { psu.sendBatch({"VOLT 5.000", "CURR 1.000"}); }},
+            {"readConfig",      false, [&]() { psu.readConfig(); }},
+            {"applyConfig/nop", true,  [&]() { psu.applyConfig(unchanged); }},
+            {"applyConfig/1",   true,  [&]() {
+                flip = !flip;
+                toggled.voltage = flip ? 5.5 : 5.0;
+                psu.applyConfig(toggled);
+            }},
+            {"measureAvg/16",   false, [&]() { psu.measureAveraged(MeasureMetric::VOLTAGE, 16); }},
+        };
+
+        std::printf("%-16s %10s %10s %10s %9s %9s %9s  %s\n",
+                    "operation", "mean_us", "p50_us", "p99_us", "allocs", "bytes", "syscalls", "breakdown");
+
+        std::vector<Result> results;
+        for (const auto& op : operations) {
+            if (op.writes && !allowWrites) {
+                std::printf("%-16s skipped (needs --allow-writes)\n", op.name.c_str());
+                continue;
+            }
+            Result r = measure(op, iterations);
+            std::printf("%-16s %10.0f %10.0f %10.0f %9.1f %9.0f %9.1f  %s\n",
+                        r.name.c_str(), r.mean_us, r.p50_us, r.p99_us,
+                        r.allocations, r.bytes, r.syscalls, r.breakdown.c_str());
+            results.push_back(r);
+        }
+
+        if (allowWrites) {
+            psu.enableOutput(false);
+        }
+        // Disconnect explicitly: the destructor would switch the output off
+        psu.disconnect();
+
+        if (!savePath.empty()) {
+            saveBaseline(savePath, results);
+        }
+
+        if (!checkPath.empty()) {
+            std::map<std::string, Result> baseline = loadBaseline(checkPath);
+            int regressions = 0;
+            for (const auto& r : results) {
+                auto it = baseline.find(r.name);
+                if (it == baseline.end()) {
+                    continue;
+                }
+                const Result& b = it->second;
+                if (exceeds(r.allocations, b.allocations, tolerance) ||
+                    exceeds(r.bytes, b.bytes, tolerance) ||
+                    exceeds(r.syscalls, b.syscalls, tolerance)) {
+                    std::printf("REGRESSION %s: allocs %.1f (baseline %.1f), bytes %.0f (%.0f), syscalls %.1f (%.1f)\n",
+                                r.name.c_str(), r.allocations, b.allocations, r.bytes, b.bytes,
+                                r.syscalls, b.syscalls);
+                    ++regressions;
+                }
+            }
+            if (regressions > 0) {
+                return 2;
+            }
+            std::printf("No regressions against %s\n", checkPath.c_str());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "g30bench: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
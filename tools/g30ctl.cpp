@@ -0,0 +1,365 @@
+/**
+ * @file g30ctl.cpp
+ * @brief g30ctl - command-line control of TDK Lambda G30 supplies
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * One-shot:
+ *   g30ctl [OPTIONS] DEVICE COMMAND [ARG]
+ *
+ * Bulk (one "DEVICE COMMAND [ARG]" per line on stdin, '#' starts a comment):
+ *   g30ctl [OPTIONS] --bulk < script.txt
+ *
+ * DEVICE is IP[:PORT] when talking to supplies directly, or a device name
+ * or index when --daemon is given. In bulk mode every device gets one
+ * connection that is reused for all its lines, and devices run
+ * concurrently. Results are printed in input order as "DEVICE<TAB>RESULT".
+ *
+ * Options:
+ *   --daemon PATH   Go through a g30d daemon instead of direct connections
+ *   --reset         Send *RST and *CLS when connecting directly (default: keep settings)
+ *   --timeout MS    Direct connection timeout (default: 1000)
+ *
+ * Commands:
+ *   idn | volt [V] | curr [A] | ovp [V] | meas-volt | meas-curr | meas-power
+ *   out [on|off] | status | error | save SLOT | recall SLOT | raw SCPI...
+ *
+ * volt, curr and ovp values above the supply's ratings are rejected before
+ * anything is sent.
+ */
+
+#include "../include/g30_daemon.h"
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+using namespace TDKLambda;
+
+namespace {
+
+struct Options {
+    std::string daemonSocket;
+    bool reset = false;
+    int timeout_ms = 1000;
+};
+
+struct Line {
+    std::string device;
+    std::string command;
+    std::string argument;
+    std::string result;
+    bool failed = false;
+};
+
+/**
+ * @brief SCPI translation of one g30ctl command
+ */
+struct Scpi {
+    std::vector<std::string> messages;  ///< Queries, or commands if !isQuery
+    bool isQuery;
+    bool computePower;                  ///< Multiply the two replies (meas-power)
+};
+
+/**
+ * @brief Format a setpoint command, rejecting values outside 0..limit
+ *
+ * Batched commands bypass the driver's setters, so the range check they
+ * make against the supply's ratings is repeated here.
+ */
+std::string formatValue(const char* header, const std::string& argument, double limit, const char* unit) {
+    char* end = nullptr;
+    double value = std::strtod(argument.c_str(), &end);
+    if (argument.empty() || *end != '\0' || value < 0) {
+        throw G30Exception("Invalid value '" + argument + "'");
+    }
+    if (value > limit) {
+        throw G30Exception("Value " + argument + unit + " exceeds maximum limit of " +
+                           std::to_string(limit) + unit);
+    }
+    std::ostringstream oss;
+    oss.precision(3);
+    oss << std::fixed << header << " " << value;
+    return oss.str();
+}
+
+Scpi translate(const Line& line, const TDKLambdaG30& ratings) {
+    const std::string& cmd = line.command;
+    const std::string& arg = line.argument;
+    Scpi s;
+    s.isQuery = true;
+    s.computePower = false;
+
+    if (cmd == "idn") {
+        s.messages = {"*IDN?"};
+    } else if (cmd == "volt") {
+        s.isQuery = arg.empty();
+        s.messages = {arg.empty() ? "VOLT?" : formatValue("VOLT", arg, ratings.getMaxVoltage(), "V")};
+    } else if (cmd == "curr") {
+        s.isQuery = arg.empty();
+        s.messages = {arg.empty() ? "CURR?" : formatValue("CURR", arg, ratings.getMaxCurrent(), "A")};
+    } else if (cmd == "ovp") {
+        s.isQuery = arg.empty();
+        s.messages = {arg.empty() ? "VOLT:PROT?" : formatValue("VOLT:PROT", arg, ratings.getMaxVoltage(), "V")};
+    } else if (cmd == "meas-volt") {
+        s.messages = {"MEAS:VOLT?"};
+    } else if (cmd == "meas-curr") {
+        s.messages = {"MEAS:CURR?"};
+    } else if (cmd == "meas-power") {
+        s.messages = {"MEAS:VOLT?", "MEAS:CURR?"};
+        s.computePower = true;
+    } else if (cmd == "out") {
+        if (arg.empty()) {
+            s.messages = {"OUTP?"};
+        } else if (arg == "on" || arg == "off") {
+            s.isQuery = false;
+            s.messages = {arg == "on" ? "OUTP ON" : "OUTP OFF"};
+        } else {
+            throw G30Exception("out expects on or off");
+        }
+    } else if (cmd == "status") {
+        s.messages = {"STAT:QUES?"};
+    } else if (cmd == "error") {
+        s.messages = {"SYST:ERR?"};
+    } else if (cmd == "save" || cmd == "recall") {
+        if (arg.empty()) {
+            throw G30Exception(cmd + " expects a slot number");
+        }
+        s.isQuery = false;
+        s.messages = {(cmd == "save" ? "*SAV " : "*RCL ") + arg};
+    } else if (cmd == "raw") {
+        if (arg.empty()) {
+            throw G30Exception("raw expects an SCPI string");
+        }
+        s.isQuery = arg.find('?') != std::string::npos;
+        s.messages = {arg};
+    } else {
+        throw G30Exception("Unknown command '" + cmd + "'");
+    }
+    return s;
+}
+
+std::string finish(const Scpi& scpi, const std::vector<std::string>& replies) {
+    if (!scpi.isQuery) {
+        return "OK";
+    }
+    if (scpi.computePower) {
+        std::ostringstream oss;
+        oss.precision(3);
+        oss << std::fixed << std::stod(replies[0]) * std::stod(replies[1]);
+        return oss.str();
+    }
+    return replies[0];
+}
+
+/**
+ * @brief Run all lines of one device over one direct connection
+ */
+void runDirect(const std::string& device, std::vector<Line*>& lines, const Options& options) {
+    G30Config config;
+    size_t colon = device.find(':');
+    config.ipAddress = device.substr(0, colon);
+    if (colon != std::string::npos) {
+        config.tcpPort = std::atoi(device.c_str() + colon + 1);
+    }
+    config.timeout_ms = options.timeout_ms;
+    config.resetOnConnect = options.reset;
+
+    TDKLambdaG30 psu(config);
+    try {
+        psu.connect();
+    } catch (const std::exception& e) {
+        for (Line* line : lines) {
+            line->failed = true;
+            line->result = e.what();
+        }
+        return;
+    }
+
+    for (Line* line : lines) {
+        try {
+            Scpi scpi = translate(*line, psu);
+            if (scpi.isQuery) {
+                line->result = finish(scpi, psu.sendQueries(scpi.messages));
+            } else {
+                psu.sendBatch(scpi.messages);
+                line->result = finish(scpi, {});
+            }
+        } catch (const std::exception& e) {
+            line->failed = true;
+            line->result = e.what();
+        }
+    }
+
+    // Leave the output as the script set it (the destructor would switch it off)
+    psu.disconnect();
+}
+
+/**
+ * @brief Run all lines of one device over one daemon session
+ */
+void runDaemon(const std::string& device, std::vector<Line*>& lines, const Options& options) {
+    try {
+        G30DaemonClient client(options.daemonSocket);
+
+        uint16_t index = 0;
+        std::vector<std::string> names = client.listDevices();
+        size_t k = 0;
+        while (k < names.size() && names[k] != device) {
+            ++k;
+        }
+        if (k < names.size()) {
+            index = static_cast<uint16_t>(k);
+        } else {
+            char* end = nullptr;
+            long n = std::strtol(device.c_str(), &end, 10);
+            if (device.empty() || *end != '\0' || n < 0 || n >= static_cast<long>(names.size())) {
+                throw G30Exception("Daemon has no device '" + device + "'");
+            }
+            index = static_cast<uint16_t>(n);
+        }
+
+        // The daemon does not report ratings; check against the driver's defaults
+        const TDKLambdaG30 ratings{G30Config()};
+
+        for (Line* line : lines) {
+            try {
+                Scpi scpi = translate(*line, ratings);
+                std::vector<std::string> replies;
+                for (const auto& message : scpi.messages) {
+                    if (scpi.isQuery) {
+                        replies.push_back(client.query(index, message));
+                    } else {
+                        client.command(index, message);
+                    }
+                }
+                line->result = finish(scpi, replies);
+            } catch (const std::exception& e) {
+                line->failed = true;
+                line->result = e.what();
+            }
+        }
+    } catch (const std::exception& e) {
+        for (Line* line : lines) {
+            if (line->result.empty()) {
+                line->failed = true;
+                line->result = e.what();
+            }
+        }
+    }
+}
+
+bool parseLine(const std::string& text, Line& line) {
+    std::istringstream iss(text);
+    if (!(iss >> line.device) || line.device[0] == '#') {
+        return false;
+    }
+    if (!(iss >> line.command)) {
+        line.failed = true;
+        line.result = "Missing command";
+        return true;
+    }
+    std::getline(iss >> std::ws, line.argument);
+    while (!line.argument.empty() && (line.argument.back() == ' ' || line.argument.back() == '\r')) {
+        line.argument.pop_back();
+    }
+    return true;
+}
+
+void printUsage() {
+    std::cerr << "Usage: g30ctl [--daemon PATH] [--reset] [--timeout MS] DEVICE COMMAND [ARG]\n"
+              << "       g30ctl [--daemon PATH] [--reset] [--timeout MS] --bulk < script\n"
+              << "Commands: idn, volt [V], curr [A], ovp [V], meas-volt, meas-curr, meas-power,\n"
+              << "          out [on|off], status, error, save SLOT, recall SLOT, raw SCPI...\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    bool bulk = false;
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--daemon" && i + 1 < argc) {
+            options.daemonSocket = argv[++i];
+        } else if (arg == "--reset") {
+            options.reset = true;
+        } else if (arg == "--timeout" && i + 1 < argc) {
+            options.timeout_ms = std::atoi(argv[++i]);
+        } else if (arg == "--bulk") {
+            bulk = true;
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    std::vector<Line> lines;
+    if (bulk) {
+        std::string text;
+        while (std::getline(std::cin, text)) {
+            Line line;
+            if (parseLine(text, line)) {
+                lines.push_back(line);
+            }
+        }
+    } else {
+        if (positional.size() < 2) {
+            printUsage();
+            return 1;
+        }
+        Line line;
+        line.device = positional[0];
+        line.command = positional[1];
+        for (size_t i = 2; i < positional.size(); ++i) {
+            line.argument += (i > 2 ? " " : "") + positional[i];
+        }
+        lines.push_back(line);
+    }
+
+    // One worker per device, lines of a device keep their order
+    std::map<std::string, std::vector<Line*>> byDevice;
+    for (auto& line : lines) {
+        if (!line.failed) {
+            byDevice[line.device].push_back(&line);
+        }
+    }
+
+    std::vector<std::future<void>> workers;
+    for (auto& entry : byDevice) {
+        const std::string& device = entry.first;
+        std::vector<Line*>& deviceLines = entry.second;
+        workers.push_back(std::async(std::launch::async, [&options, &device, &deviceLines]() {
+            if (options.daemonSocket.empty()) {
+                runDirect(device, deviceLines, options);
+            } else {
+                runDaemon(device, deviceLines, options);
+            }
+        }));
+    }
+    for (auto& worker : workers) {
+        worker.get();
+    }
+
+    int status = 0;
+    for (const auto& line : lines) {
+        if (line.failed) {
+            status = 1;
+            if (bulk) {
+                std::cout << line.device << "\tERROR: " << line.result << "\n";
+            } else {
+                std::cerr << "g30ctl: " << line.result << "\n";
+            }
+        } else if (bulk) {
+            std::cout << line.device << "\t" << line.result << "\n";
+        } else {
+            std::cout << line.result << "\n";
+        }
+    }
+    return status;
+}
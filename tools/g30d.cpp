@@ -0,0 +1,94 @@
+/**
+ * @file g30d.cpp
+ * @brief g30d - daemon sharing TDK Lambda G30 connections between local programs
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * Usage:
+ *   g30d [--socket PATH] [--batch N] NAME=IP[:PORT] [NAME=IP[:PORT] ...]
+ *
+ * Runs until SIGINT or SIGTERM. Supplies are neither reset on start nor
+ * switched off on exit.
+ */
+
+#include "../include/g30_daemon.h"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <pthread.h>
+
+using namespace TDKLambda;
+
+static void printUsage() {
+    std::cerr << "Usage: g30d [--socket PATH] [--batch N] NAME=IP[:PORT] [NAME=IP[:PORT] ...]\n";
+}
+
+int main(int argc, char* argv[]) {
+    DaemonConfig daemonConfig;
+    std::vector<std::pair<std::string, G30Config>> devices;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            daemonConfig.socketPath = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            daemonConfig.maxBatch = std::atoi(argv[++i]);
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage();
+            return 0;
+        } else {
+            size_t eq = arg.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                printUsage();
+                return 1;
+            }
+            G30Config config;
+            config.resetOnConnect = false;
+            std::string address = arg.substr(eq + 1);
+            size_t colon = address.find(':');
+            config.ipAddress = address.substr(0, colon);
+            if (colon != std::string::npos) {
+                config.tcpPort = std::atoi(address.c_str() + colon + 1);
+            }
+            devices.emplace_back(arg.substr(0, eq), config);
+        }
+    }
+
+    if (devices.empty() || daemonConfig.maxBatch <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    // Block termination signals in all threads; main waits for them below
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        G30Daemon daemon(daemonConfig);
+        for (const auto& device : devices) {
+            daemon.addDevice(device.first, device.second);
+        }
+
+        daemon.start();
+        std::cout << "g30d: serving " << devices.size() << " device(s) on "
+                  << daemonConfig.socketPath << std::endl;
+
+        int received = 0;
+        sigwait(&signals, &received);
+
+        DaemonStats s = daemon.stats();
+        daemon.stop();
+        std::cout << "g30d: stopped (requests " << s.requests
+                  << ", cache hits " << s.cacheHits
+                  << ", merged " << s.mergedQueries
+                  << ", device round trips " << s.deviceRoundTrips << ")" << std::endl;
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "g30d: " << e.what() << std::endl;
+        return 1;
+    }
+}
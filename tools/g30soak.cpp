@@ -0,0 +1,786 @@
+/**
+ * @file g30soak.cpp
+ * @brief g30soak - long-running soak test with resource tracking and baseline comparison
+ * @version 1.0.0
+ * @date 2025-11-24
+ *
+ * Runs a weighted mix of driver operations (setpoints, telemetry reads,
+ * status reads and ramps) from several worker threads against a simulator
+ * farm (or real supplies with --device) for a fixed time, and tracks:
+ *   - latency percentiles per operation, overall and per report interval
+ *   - error rates per operation and by kind (timeout, circuit open, ...)
+ *   - resident memory and open file descriptors of the process over time,
+ *     reduced to a growth rate after the first (warm-up) interval
+ *
+ * Latencies go into fixed-size log-linear histograms, so the harness itself
+ * does not grow however long it runs. With the simulator, memory and
+ * descriptors include the simulator's; with --device only the driver's.
+ *
+ * With --check FILE the results are compared against a baseline written by
+ * --save FILE, and the program exits with status 2 if a latency percentile
+ * or the throughput moved by more than the tolerance, the error rate rose
+ * by more than --error-slack points, memory grew faster than --rss-slack
+ * KB/h beyond the baseline, or descriptors leaked. --max-error-pct fails a
+ * run with too many errors without any baseline.
+ *
+ * Against real supplies the outputs are not switched on or off and the
+ * supplies are never reset, also on reconnects; setpoints stay within
+ * --voltage.
+ *
+ * Usage:
+ *   g30soak [--duration S] [--interval S] [--devices N] [--device IP[:PORT][,...]]
+ *           [--workers N] [--rate OPS] [--mix set=W,telemetry=W,status=W,ramp=W]
+ *           [--latency fixed:US|lan|congested|flaky] [--voltage MIN:MAX] [--seed N]
+ *           [--csv FILE] [--save FILE] [--check FILE] [--tolerance PCT]
+ *           [--error-slack PCT] [--rss-slack KB] [--max-error-pct PCT]
+ *
+ * Runs until the duration has passed, SIGINT or SIGTERM; the report is
+ * printed in every case.
+ */
+
+#include "../include/g30_simulator_farm.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+// Linux/POSIX includes
+#include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+
+using namespace TDKLambda;
+
+namespace {
+
+enum Operation { OP_SET, OP_TELEMETRY, OP_STATUS, OP_RAMP, OP_COUNT };
+
+const char* const kOperationNames[OP_COUNT] = {"set", "telemetry", "status", "ramp"};
+
+// Latency percentiles may also move by this much in absolute terms (timer noise)
+const double kLatencySlack_us = 500.0;
+
+// Memory growth below this after warm-up is allocator noise, whatever its rate;
+// it keeps short runs from extrapolating a few pages into a leak
+const double kRssNoise_kb = 1024.0;
+
+/**
+ * @brief Log-linear latency histogram in microseconds (fixed memory, ~3% resolution)
+ *
+ * Values below 32 us have their own bucket; above that every power of two
+ * is split into 32 buckets, up to 2^36 us.
+ */
+class Histogram {
+public:
+    Histogram() { clear(); }
+
+    void clear() {
+        std::fill(buckets_, buckets_ + kBuckets, 0);
+        count_ = 0;
+        max_ = 0.0;
+    }
+
+    void record(double us) {
+        uint64_t v = static_cast<uint64_t>(std::max(0.0, std::min(us, 68719476735.0)));
+        ++buckets_[index(v)];
+        ++count_;
+        max_ = std::max(max_, us);
+    }
+
+    void merge(const Histogram& other) {
+        for (int i = 0; i < kBuckets; ++i) {
+            buckets_[i] += other.buckets_[i];
+        }
+        count_ += other.count_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t count() const { return count_; }
+    double max() const { return max_; }
+
+    /**
+     * @brief Value below which pct percent of the samples lie (bucket midpoint)
+     */
+    double percentile(double pct) const {
+        if (count_ == 0) {
+            return 0.0;
+        }
+        uint64_t rank = static_cast<uint64_t>(std::ceil(pct / 100.0 * static_cast<double>(count_)));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            seen += buckets_[i];
+            if (seen >= rank) {
+                return std::min(midpoint(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static const int kSub = 32;
+    static const int kBuckets = kSub * 33;
+
+    uint64_t buckets_[kBuckets];
+    uint64_t count_;
+    double max_;
+
+    static int index(uint64_t v) {
+        if (v < kSub) {
+            return static_cast<int>(v);
+        }
+        int octave = 63 - __builtin_clzll(v);
+        int shift = octave - 5;
+        return kSub * (shift + 1) + static_cast<int>((v >> shift) - kSub);
+    }
+
+    static double midpoint(int i) {
+        if (i < kSub) {
+            return i;
+        }
+        int shift = i / kSub - 1;
+        double low = static_cast<double>(static_cast<uint64_t>(kSub + i % kSub) << shift);
+        return low + static_cast<double>(1ull << shift) / 2.0;
+    }
+};
+
+struct OperationStats {
+    Histogram total;
+    Histogram window;
+    uint64_t errors;
+    uint64_t windowErrors;
+
+    OperationStats() : errors(0), windowErrors(0) {}
+};
+
+/**
+ * @brief Results shared by the workers
+ */
+struct SoakStats {
+    std::mutex mutex;
+    OperationStats operations[OP_COUNT];
+    std::map<std::string, uint64_t> errorKinds;
+    uint64_t reconnects;
+
+    SoakStats() : reconnects(0) {}
+
+    void record(Operation op, double us, const char* error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        OperationStats& s = operations[op];
+        s.total.record(us);
+        s.window.record(us);
+        if (error) {
+            ++s.errors;
+            ++s.windowErrors;
+            ++errorKinds[error];
+        }
+    }
+};
+
+struct ResourceSample {
+    double elapsed_s;
+    long rss_kb;
+    long fds;
+};
+
+struct Options {
+    double duration_s;
+    double interval_s;
+    size_t devices;
+    std::vector<std::string> endpoints;
+    size_t workers;
+    double rate;
+    double mix[OP_COUNT];
+    LatencyProfile latency;
+    double minVoltage;
+    double maxVoltage;
+    uint64_t seed;
+    std::string csvPath;
+    std::string savePath;
+    std::string checkPath;
+    double tolerance;
+    double errorSlack;
+    double rssSlack;
+    double maxErrorPct;
+
+    Options()
+        : duration_s(60.0),
+          interval_s(10.0),
+          devices(4),
+          workers(0),
+          rate(0.0),
+          mix{40.0, 40.0, 15.0, 5.0},
+          latency(LatencyProfile::lan()),
+          minVoltage(1.0),
+          maxVoltage(5.0),
+          seed(1),
+          tolerance(0.20),
+          errorSlack(0.1),
+          rssSlack(4096.0),
+          maxErrorPct(-1.0) {}
+};
+
+// Coarse error classes, so the summary stays short after hours of running
+const char* classifyError(const std::string& message) {
+    if (message.find("Timeout") != std::string::npos || message.find("timed out") != std::string::npos) {
+        return "timeout";
+    }
+    if (message.find("Circuit open") != std::string::npos) {
+        return "circuit open";
+    }
+    if (message.find("Not connected") != std::string::npos) {
+        return "not connected";
+    }
+    return "other";
+}
+
+long readRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return std::atol(line.c_str() + 6);
+        }
+    }
+    return 0;
+}
+
+long countOpenFds() {
+    DIR* dir = opendir("/proc/self/fd");
+    if (!dir) {
+        return 0;
+    }
+    long count = 0;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            ++count;
+        }
+    }
+    closedir(dir);
+    return count - 1;   // The directory stream itself
+}
+
+ResourceSample sampleResources(double elapsed_s) {
+    ResourceSample sample;
+    sample.elapsed_s = elapsed_s;
+    sample.rss_kb = readRssKb();
+    sample.fds = countOpenFds();
+    return sample;
+}
+
+/**
+ * @brief Least-squares RSS slope in KB/h, from the end of the warm-up interval on
+ */
+double rssGrowthPerHour(const std::vector<ResourceSample>& samples) {
+    size_t first = samples.size() > 2 ? 1 : 0;
+    double n = static_cast<double>(samples.size() - first);
+    if (n < 2) {
+        return 0.0;
+    }
+    double st = 0, sr = 0, stt = 0, str = 0;
+    for (size_t i = first; i < samples.size(); ++i) {
+        double t = samples[i].elapsed_s / 3600.0;
+        double r = static_cast<double>(samples[i].rss_kb);
+        st += t;
+        sr += r;
+        stt += t * t;
+        str += t * r;
+    }
+    double denominator = n * stt - st * st;
+    return denominator > 0 ? (n * str - st * sr) / denominator : 0.0;
+}
+
+/**
+ * @brief Run fn(i) for i in [0, count) on up to 64 threads
+ *
+ * connect() settles for 100 ms per device, which would take minutes for a
+ * large fleet one at a time.
+ */
+template <typename Fn>
+void forEachDevice(size_t count, Fn fn) {
+    const size_t threads = std::min<size_t>(count, 64);
+    std::vector<std::future<void>> running;
+    for (size_t t = 0; t < threads; ++t) {
+        running.push_back(std::async(std::launch::async, [&fn, t, threads, count]() {
+            for (size_t i = t; i < count; i += threads) {
+                fn(i);
+            }
+        }));
+    }
+    for (auto& f : running) {
+        f.get();
+    }
+}
+
+void runWorker(size_t id, std::vector<TDKLambdaG30*> devices, const Options& options,
+               SoakStats& stats, const std::atomic<bool>& stop) {
+    std::mt19937_64 rng(options.seed * 1000003 + id);
+    std::discrete_distribution<int> pick(options.mix, options.mix + OP_COUNT);
+    std::uniform_real_distribution<double> voltage(options.minVoltage, options.maxVoltage);
+    std::uniform_int_distribution<size_t> device(0, devices.size() - 1);
+
+    // Open-loop pacing: each worker takes its share of --rate
+    const bool paced = options.rate > 0;
+    const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(paced ? static_cast<double>(options.workers) / options.rate : 0.0));
+    auto next = std::chrono::steady_clock::now();
+
+    while (!stop) {
+        if (paced) {
+            next += period;
+            auto now = std::chrono::steady_clock::now();
+            if (next < now - std::chrono::seconds(1)) {
+                next = now;     // Far behind: do not burst to catch up
+            }
+            std::this_thread::sleep_until(next);
+        }
+
+        TDKLambdaG30& psu = *devices[device(rng)];
+        Operation op = static_cast<Operation>(pick(rng));
+        const char* error = nullptr;
+
+        auto start = std::chrono::steady_clock::now();
+        try {
+            switch (op) {
+                case OP_SET:       psu.setVoltage(voltage(rng)); break;
+                case OP_TELEMETRY: psu.sendQueries({"MEAS:VOLT?", "MEAS:CURR?"}); break;
+                case OP_STATUS:    psu.getStatus(); break;
+                default:           psu.setVoltageWithRamp(voltage(rng), options.maxVoltage - options.minVoltage); break;
+            }
+        } catch (const std::exception& e) {
+            error = classifyError(e.what());
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        stats.record(op, us, error);
+
+        if (error && !psu.isConnected()) {
+            try {
+                psu.connect();
+                std::lock_guard<std::mutex> lock(stats.mutex);
+                ++stats.reconnects;
+            } catch (const std::exception&) {
+                // Retried after the next failure
+            }
+        }
+    }
+}
+
+bool parseMix(const std::string& text, double mix[OP_COUNT]) {
+    std::fill(mix, mix + OP_COUNT, 0.0);
+    std::istringstream iss(text);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        size_t eq = item.find('=');
+        const char* const* name = std::find(kOperationNames, kOperationNames + OP_COUNT, item.substr(0, eq));
+        if (eq == std::string::npos || name == kOperationNames + OP_COUNT) {
+            return false;
+        }
+        mix[name - kOperationNames] = std::max(0.0, std::atof(item.c_str() + eq + 1));
+    }
+    return std::any_of(mix, mix + OP_COUNT, [](double w) { return w > 0; });
+}
+
+bool parseLatency(const std::string& text, LatencyProfile& profile) {
+    if (text == "lan") {
+        profile = LatencyProfile::lan();
+    } else if (text == "congested") {
+        profile = LatencyProfile::congested();
+    } else if (text == "flaky") {
+        profile = LatencyProfile::flaky();
+    } else if (text.compare(0, 6, "fixed:") == 0) {
+        profile = LatencyProfile::fixed(std::atoi(text.c_str() + 6));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::map<std::string, double> loadBaseline(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw G30Exception("Cannot read baseline " + path);
+    }
+    std::map<std::string, double> baseline;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream iss(line);
+        std::string key;
+        double value;
+        if (iss >> key >> value) {
+            baseline[key] = value;
+        }
+    }
+    return baseline;
+}
+
+void saveBaseline(const std::string& path, const std::map<std::string, double>& metrics,
+                  const std::string& description) {
+    std::ofstream file(path);
+    if (!file) {
+        throw G30Exception("Cannot write baseline " + path);
+    }
+    file.precision(1);
+    file << std::fixed;
+    file << "# g30soak baseline: " << description << "\n";
+    file << "# metric value\n";
+    for (const auto& m : metrics) {
+        file << m.first << " " << m.second << "\n";
+    }
+}
+
+bool endsWith(const std::string& text, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+/**
+ * @brief Compare one metric with its baseline value
+ * @param growth_kb Memory growth of this run after warm-up (gates the growth rate)
+ * @return Description of the allowed range if the value is outside it, else empty
+ */
+std::string regression(const std::string& key, double value, double base, double growth_kb,
+                       const Options& options) {
+    std::ostringstream limit;
+    limit.precision(1);
+    limit << std::fixed;
+    if (endsWith(key, "_us")) {
+        double allowed = base * (1.0 + options.tolerance) + kLatencySlack_us;
+        if (value > allowed) {
+            limit << "<= " << allowed;
+        }
+    } else if (endsWith(key, "error_pct")) {
+        double allowed = base + options.errorSlack;
+        if (value > allowed + 1e-9) {
+            limit << "<= " << allowed;
+        }
+    } else if (key == "throughput_ops_s") {
+        double allowed = base * (1.0 - options.tolerance);
+        if (value < allowed) {
+            limit << ">= " << allowed;
+        }
+    } else if (key == "rss_growth_kb_per_h") {
+        double allowed = std::max(base, 0.0) + options.rssSlack;
+        if (value > allowed && growth_kb > kRssNoise_kb) {
+            limit << "<= " << allowed;
+        }
+    } else if (key == "fd_growth") {
+        if (value > std::max(base, 0.0)) {
+            limit << "<= " << std::max(base, 0.0);
+        }
+    }
+    return limit.str();
+}
+
+void printUsage() {
+    std::cerr << "Usage: g30soak [--duration S] [--interval S] [--devices N] [--device IP[:PORT][,...]]\n"
+              << "               [--workers N] [--rate OPS] [--mix set=W,telemetry=W,status=W,ramp=W]\n"
+              << "               [--latency fixed:US|lan|congested|flaky] [--voltage MIN:MAX] [--seed N]\n"
+              << "               [--csv FILE] [--save FILE] [--check FILE] [--tolerance PCT]\n"
+              << "               [--error-slack PCT] [--rss-slack KB] [--max-error-pct PCT]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool ok = true;
+        if (arg == "--duration" && i + 1 < argc) {
+            options.duration_s = std::atof(argv[++i]);
+        } else if (arg == "--interval" && i + 1 < argc) {
+            options.interval_s = std::atof(argv[++i]);
+        } else if (arg == "--devices" && i + 1 < argc) {
+            options.devices = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--device" && i + 1 < argc) {
+            std::istringstream iss(argv[++i]);
+            std::string endpoint;
+            while (std::getline(iss, endpoint, ',')) {
+                options.endpoints.push_back(endpoint);
+            }
+        } else if (arg == "--workers" && i + 1 < argc) {
+            options.workers = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--rate" && i + 1 < argc) {
+            options.rate = std::atof(argv[++i]);
+        } else if (arg == "--mix" && i + 1 < argc) {
+            ok = parseMix(argv[++i], options.mix);
+        } else if (arg == "--latency" && i + 1 < argc) {
+            ok = parseLatency(argv[++i], options.latency);
+        } else if (arg == "--voltage" && i + 1 < argc) {
+            ok = std::sscanf(argv[++i], "%lf:%lf", &options.minVoltage, &options.maxVoltage) == 2 &&
+                 options.minVoltage >= 0 && options.maxVoltage > options.minVoltage;
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--csv" && i + 1 < argc) {
+            options.csvPath = argv[++i];
+        } else if (arg == "--save" && i + 1 < argc) {
+            options.savePath = argv[++i];
+        } else if (arg == "--check" && i + 1 < argc) {
+            options.checkPath = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            options.tolerance = std::atof(argv[++i]) / 100.0;
+        } else if (arg == "--error-slack" && i + 1 < argc) {
+            options.errorSlack = std::atof(argv[++i]);
+        } else if (arg == "--rss-slack" && i + 1 < argc) {
+            options.rssSlack = std::atof(argv[++i]);
+        } else if (arg == "--max-error-pct" && i + 1 < argc) {
+            options.maxErrorPct = std::atof(argv[++i]);
+        } else {
+            printUsage();
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+        if (!ok) {
+            std::cerr << "g30soak: invalid value for " << arg << "\n";
+            return 1;
+        }
+    }
+    if (options.duration_s <= 0 || options.interval_s <= 0) {
+        printUsage();
+        return 1;
+    }
+
+    // Block termination signals in all threads; the report loop waits for them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        // Never *RST a supply on connect or reconnect; keep present settings
+        G30Config base;
+        base.resetOnConnect = false;
+
+        std::unique_ptr<SimulatorFarm> farm;
+        std::vector<G30Config> configs;
+        if (options.endpoints.empty()) {
+            SimulatorFarmConfig farmConfig;
+            farmConfig.devices = options.devices;
+            farmConfig.latency = {options.latency};
+            farmConfig.seed = options.seed;
+            farm.reset(new SimulatorFarm(farmConfig));
+            farm->start();
+            for (size_t i = 0; i < farm->size(); ++i) {
+                configs.push_back(farm->endpointConfig(i, base));
+            }
+        } else {
+            for (const auto& endpoint : options.endpoints) {
+                G30Config config = base;
+                size_t colon = endpoint.find(':');
+                config.ipAddress = endpoint.substr(0, colon);
+                if (colon != std::string::npos) {
+                    config.tcpPort = std::atoi(endpoint.c_str() + colon + 1);
+                }
+                configs.push_back(config);
+            }
+        }
+        if (options.workers == 0) {
+            options.workers = std::min<size_t>(configs.size(), 16);
+        }
+
+        std::vector<std::unique_ptr<TDKLambdaG30>> fleet;
+        for (const auto& config : configs) {
+            fleet.emplace_back(new TDKLambdaG30(config));
+        }
+        forEachDevice(fleet.size(), [&fleet](size_t i) { fleet[i]->connect(); });
+
+        std::ostringstream description;
+        description << (farm ? std::to_string(configs.size()) + " simulated" : std::to_string(configs.size()) + " real")
+                    << " device(s), " << options.workers << " worker(s), "
+                    << (options.rate > 0 ? std::to_string(static_cast<int>(options.rate)) + " ops/s" : "unpaced")
+                    << ", mix";
+        for (int k = 0; k < OP_COUNT; ++k) {
+            description << (k ? "," : " ") << kOperationNames[k] << "=" << options.mix[k];
+        }
+        description << ", seed " << options.seed;
+        std::printf("g30soak: %s, %.0f s\n", description.str().c_str(), options.duration_s);
+
+        std::ofstream csv;
+        if (!options.csvPath.empty()) {
+            csv.open(options.csvPath);
+            if (!csv) {
+                throw G30Exception("Cannot write " + options.csvPath);
+            }
+            csv << "elapsed_s,ops,ops_per_s,errors,p50_us,p99_us,max_us,rss_kb,fds\n";
+        }
+
+        SoakStats stats;
+        std::atomic<bool> stop(false);
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<ResourceSample> samples = {sampleResources(0.0)};
+
+        std::vector<std::thread> workers;
+        for (size_t w = 0; w < options.workers; ++w) {
+            std::vector<TDKLambdaG30*> assigned;
+            for (size_t i = w % fleet.size(); i < fleet.size(); i += options.workers) {
+                assigned.push_back(fleet[i].get());
+            }
+            workers.emplace_back(runWorker, w, assigned, std::cref(options), std::ref(stats), std::cref(stop));
+        }
+
+        std::printf("%9s %9s %9s %7s %10s %10s %10s %9s %5s\n",
+                    "elapsed_s", "ops", "ops/s", "errors", "p50_us", "p99_us", "max_us", "rss_kb", "fds");
+
+        bool interrupted = false;
+        double previous_s = 0.0;
+        while (!interrupted && previous_s < options.duration_s - 1e-6) {
+            double wait_s = std::min(options.interval_s, options.duration_s - previous_s);
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::duration<double>(wait_s));
+            for (;;) {
+                auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+                if (left.count() <= 0) {
+                    break;
+                }
+                timespec timeout;
+                timeout.tv_sec = static_cast<time_t>(left.count() / 1000000000);
+                timeout.tv_nsec = static_cast<long>(left.count() % 1000000000);
+                if (sigtimedwait(&signals, nullptr, &timeout) > 0) {
+                    interrupted = true;
+                    break;
+                }
+            }
+
+            double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            Histogram window;
+            uint64_t errors = 0;
+            {
+                std::lock_guard<std::mutex> lock(stats.mutex);
+                for (auto& s : stats.operations) {
+                    window.merge(s.window);
+                    errors += s.windowErrors;
+                    s.window.clear();
+                    s.windowErrors = 0;
+                }
+            }
+            samples.push_back(sampleResources(elapsed_s));
+            const ResourceSample& r = samples.back();
+            double rate = static_cast<double>(window.count()) / std::max(elapsed_s - previous_s, 1e-9);
+            std::printf("%9.1f %9llu %9.1f %7llu %10.0f %10.0f %10.0f %9ld %5ld\n",
+                        elapsed_s, static_cast<unsigned long long>(window.count()), rate,
+                        static_cast<unsigned long long>(errors), window.percentile(50), window.percentile(99),
+                        window.max(), r.rss_kb, r.fds);
+            std::fflush(stdout);
+            if (csv) {
+                csv << elapsed_s << "," << window.count() << "," << rate << "," << errors << ","
+                    << window.percentile(50) << "," << window.percentile(99) << "," << window.max() << ","
+                    << r.rss_kb << "," << r.fds << std::endl;
+            }
+            previous_s = elapsed_s;
+        }
+
+        stop = true;
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        // ---- Report ----
+        std::map<std::string, double> metrics;
+        uint64_t totalOps = 0;
+        uint64_t totalErrors = 0;
+
+        std::printf("\n%-10s %9s %7s %7s %10s %10s %10s %10s %10s\n",
+                    "operation", "count", "errors", "err_pct", "p50_us", "p95_us", "p99_us", "p99.9_us", "max_us");
+        for (int k = 0; k < OP_COUNT; ++k) {
+            const OperationStats& s = stats.operations[k];
+            if (s.total.count() == 0) {
+                continue;
+            }
+            double errorPct = 100.0 * static_cast<double>(s.errors) / static_cast<double>(s.total.count());
+            std::printf("%-10s %9llu %7llu %7.2f %10.0f %10.0f %10.0f %10.0f %10.0f\n",
+                        kOperationNames[k], static_cast<unsigned long long>(s.total.count()),
+                        static_cast<unsigned long long>(s.errors), errorPct,
+                        s.total.percentile(50), s.total.percentile(95), s.total.percentile(99),
+                        s.total.percentile(99.9), s.total.max());
+            std::string name = kOperationNames[k];
+            metrics[name + ".p50_us"] = s.total.percentile(50);
+            metrics[name + ".p95_us"] = s.total.percentile(95);
+            metrics[name + ".p99_us"] = s.total.percentile(99);
+            metrics[name + ".error_pct"] = errorPct;
+            totalOps += s.total.count();
+            totalErrors += s.errors;
+        }
+
+        double errorPct = totalOps ? 100.0 * static_cast<double>(totalErrors) / static_cast<double>(totalOps) : 0.0;
+        const ResourceSample& warm = samples.size() > 2 ? samples[1] : samples.front();
+        metrics["throughput_ops_s"] = static_cast<double>(totalOps) / elapsed_s;
+        metrics["error_pct"] = errorPct;
+        metrics["rss_growth_kb_per_h"] = rssGrowthPerHour(samples);
+        metrics["rss_growth_kb"] = static_cast<double>(samples.back().rss_kb - warm.rss_kb);
+        metrics["fd_growth"] = static_cast<double>(samples.back().fds - warm.fds);
+
+        std::printf("\nthroughput %.1f ops/s, errors %.3f%%, reconnects %llu\n",
+                    metrics["throughput_ops_s"], errorPct, static_cast<unsigned long long>(stats.reconnects));
+        for (const auto& kind : stats.errorKinds) {
+            std::printf("  %-14s %llu\n", kind.first.c_str(), static_cast<unsigned long long>(kind.second));
+        }
+        std::printf("rss %ld -> %ld KB (%+.0f KB, %.0f KB/h after warm-up), fds %ld -> %ld\n",
+                    samples.front().rss_kb, samples.back().rss_kb, metrics["rss_growth_kb"],
+                    metrics["rss_growth_kb_per_h"], warm.fds, samples.back().fds);
+        if (interrupted) {
+            std::printf("Interrupted after %.0f s\n", elapsed_s);
+        }
+
+        // Disconnect first: the driver destructor would switch the outputs off
+        forEachDevice(fleet.size(), [&fleet](size_t i) {
+            fleet[i]->disconnect();
+            fleet[i].reset();
+        });
+        if (farm) {
+            farm->stop();
+        }
+
+        if (!options.savePath.empty()) {
+            saveBaseline(options.savePath, metrics, description.str());
+        }
+
+        int status = 0;
+        if (options.maxErrorPct >= 0 && errorPct > options.maxErrorPct) {
+            std::printf("FAIL error rate %.3f%% above %.3f%%\n", errorPct, options.maxErrorPct);
+            status = 2;
+        }
+
+        if (!options.checkPath.empty()) {
+            std::map<std::string, double> baseline = loadBaseline(options.checkPath);
+            int regressions = 0;
+            for (const auto& m : metrics) {
+                auto it = baseline.find(m.first);
+                if (it == baseline.end()) {
+                    continue;
+                }
+                std::string limit = regression(m.first, m.second, it->second, metrics["rss_growth_kb"], options);
+                if (!limit.empty()) {
+                    std::printf("REGRESSION %s: %.1f (baseline %.1f, allowed %s)\n",
+                                m.first.c_str(), m.second, it->second, limit.c_str());
+                    ++regressions;
+                }
+            }
+            if (regressions > 0) {
+                status = 2;
+            } else {
+                std::printf("No regressions against %s\n", options.checkPath.c_str());
+            }
+        }
+        return status;
+
+    } catch (const std::exception& e) {
+        std::cerr << "g30soak: " << e.what() << std::endl;
+        return 1;
+    }
+}